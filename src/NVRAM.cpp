@@ -1,9 +1,11 @@
 #include "NVRAM.h"
 #include <EEPROM.h>
 #include "audio.h"
+#include "config.h"
 
 // Define global variables declared as extern in NVRAM.h
 int currentKey = 0;                   // 0=C, 1=C#, 2=D, etc. (chromatic scale)
+bool currentKeyAuto = false;          // false=Manual (default), true=Auto
 int currentMode = 0;                  // 0=Major, 1=Minor, 2=Fixed Major, 3=Fixed Minor
 int currentOctaveShift = 0;           // -1..2
 bool currentInstrumentIsBass = false; // false=Guitar (default), true=Bass
@@ -12,6 +14,8 @@ bool currentMutingEnabled = false;
 int currentSynthSound = 0; // 0=Sine (default), 1=Organ
 int currentOutputMode = 0; // 0=Mix, 1=Split
 int currentStopMode = 0;   // 0=Fade (default), 1=Immediate
+int currentGlide = 0;      // 0=Off (default)
+int currentPitchMode = 0;  // 0=Quantized (default), 1=Follow
 
 void saveNVRAM()
 {
@@ -28,6 +32,9 @@ void saveNVRAM()
     EEPROM.write(NVRAM_ARP_ADDR, (uint8_t)currentArpMode);
     EEPROM.write(NVRAM_OUTPUT_ADDR, (uint8_t)currentOutputMode);
     EEPROM.write(NVRAM_STOPMODE_ADDR, (uint8_t)currentStopMode);
+    EEPROM.write(NVRAM_KEYAUTO_ADDR, (uint8_t)(currentKeyAuto ? 1 : 0));
+    EEPROM.write(NVRAM_GLIDE_ADDR, (uint8_t)currentGlide);
+    EEPROM.write(NVRAM_PITCHMODE_ADDR, (uint8_t)currentPitchMode);
     // store octave shifted by +2 to fit into unsigned byte (valid -1..2 -> 1..4)
     int8_t enc = currentOctaveShift + 2;
     if (enc < 0)
@@ -83,12 +90,12 @@ void loadNVRAM()
         Serial.print(" synthSound=");
         const char *soundNames[] = {"Sine", "Organ", "Rhodes", "Strings"};
         Serial.println(soundNames[currentSynthSound]);
-        // load arp mode (0 = Arp, 1 = Poly)
+        // load arp mode (ARP_MODE_*: 0 = Arp Up, 1 = Poly, 2.. = other patterns)
         uint8_t ar = EEPROM.read(NVRAM_ARP_ADDR);
-        if (ar <= 1) // validate range
+        if (ar < ARP_MODE_COUNT) // validate range
             currentArpMode = ar;
         Serial.print(" arpMode=");
-        const char *arpNames[] = {"Arp", "Poly"};
+        const char *arpNames[] = {"Arp Up", "Poly", "Arp Down", "Arp UpDn", "Arp Rand", "Stab"};
         Serial.println(arpNames[currentArpMode]);
         // load output mode (0 = Mix, 1 = Split)
         uint8_t om = EEPROM.read(NVRAM_OUTPUT_ADDR);
@@ -104,6 +111,26 @@ void loadNVRAM()
         Serial.print(" stopMode=");
         const char *stopModeNames[] = {"Fade", "Immediate"};
         Serial.println(stopModeNames[currentStopMode]);
+        // load key auto (0 = Manual, 1 = Auto)
+        uint8_t ka = EEPROM.read(NVRAM_KEYAUTO_ADDR);
+        currentKeyAuto = (ka == 1);
+        Serial.print(" keyAuto=");
+        Serial.println(currentKeyAuto ? "Auto" : "Manual");
+        // load glide (0 = Off, else index into glideTimesMs)
+        uint8_t gl = EEPROM.read(NVRAM_GLIDE_ADDR);
+        if (gl < GLIDE_TIME_COUNT) // validate range (0xFF = never written)
+            currentGlide = gl;
+        Serial.print(" glide=");
+        Serial.print(glideTimesMs[currentGlide]);
+        Serial.println("ms");
+        applyGlide();
+        // load pitch mode (0 = Quantized, 1 = Follow)
+        uint8_t pm = EEPROM.read(NVRAM_PITCHMODE_ADDR);
+        if (pm < PITCH_MODE_COUNT) // validate range
+            currentPitchMode = pm;
+        Serial.print(" pitchMode=");
+        const char *pitchModeNames[] = {"Quantized", "Follow"};
+        Serial.println(pitchModeNames[currentPitchMode]);
         // Apply the stop mode setting to chordFadeDurationMs
         if (currentStopMode == 1) // Immediate
         {
@@ -124,3 +151,20 @@ void loadNVRAM()
         currentMutingEnabled = false;    // default muting disabled        currentSynthSound = 0; // default to Sine        saveNVRAM();
     }
 }
+
+int loadAudioMemoryPeak()
+{
+    if (EEPROM.read(NVRAM_SIGNATURE_ADDR) != NVRAM_SIGNATURE)
+        return 0;
+    uint8_t peak = EEPROM.read(NVRAM_AUDIOMEM_ADDR);
+    return (peak == 0xFF) ? 0 : peak; // 0xFF = never written
+}
+
+void saveAudioMemoryPeak(int blocks)
+{
+    if (EEPROM.read(NVRAM_SIGNATURE_ADDR) != NVRAM_SIGNATURE)
+        return; // settings not initialized yet; loadNVRAM() writes them
+    if (blocks > 254)
+        blocks = 254;
+    EEPROM.write(NVRAM_AUDIOMEM_ADDR, (uint8_t)blocks);
+}
@@ -15,25 +15,40 @@
 #define NVRAM_MUTING_ADDR 5
 // Address for Synth Sound (0=Sine, 1=Organ, etc.)
 #define NVRAM_SYNTHSND_ADDR 6
-// Address for Arp Mode (0=Arp, 1=Poly)
+// Address for Arp Mode (ARP_MODE_* in config.h: 0=Arp Up, 1=Poly, ...)
 #define NVRAM_ARP_ADDR 7
 // Address for Output Mode (0=Mix, 1=Split)
 #define NVRAM_OUTPUT_ADDR 8
 // Address for Stop Mode (0=Fade, 1=Immediate)
 #define NVRAM_STOPMODE_ADDR 9
+// Address for automatic key detection (0=Manual, 1=Auto)
+#define NVRAM_KEYAUTO_ADDR 10
+// Address for the peak audio block usage measured so far (0 = unknown)
+#define NVRAM_AUDIOMEM_ADDR 11
+// Address for Glide time (index into glideTimesMs, 0=Off)
+#define NVRAM_GLIDE_ADDR 12
+// Address for Pitch Mode (PITCH_MODE_* in config.h: 0=Quantized, 1=Follow)
+#define NVRAM_PITCHMODE_ADDR 13
 
 extern int currentKey;
+extern bool currentKeyAuto; // true = key follows the automatic estimate
 // Mode: 0=Major, 1=Minor, 2=Fixed Major, 3=Fixed Minor
 extern int currentMode;
 extern int currentOctaveShift;
 extern bool currentInstrumentIsBass;
 extern bool currentMutingEnabled;
 extern int currentSynthSound;       // 0=Sine, 1=Organ, etc.
-extern volatile int currentArpMode; // 0=Arp, 1=Poly
+extern volatile int currentArpMode; // ARP_MODE_*: 0=Arp Up, 1=Poly, ...
 extern int currentOutputMode;       // 0=Mix, 1=Split
 extern int currentStopMode;         // 0=Fade, 1=Immediate
+extern int currentGlide;            // 0=Off, else index into glideTimesMs
+extern int currentPitchMode;        // PITCH_MODE_*: 0=Quantized, 1=Follow
 
 void saveNVRAM();
 void loadNVRAM();
+// Measured audio block peak, used to size AudioMemory at boot (0 = unknown).
+// Stored separately from the settings so it can be read before loadNVRAM().
+int loadAudioMemoryPeak();
+void saveAudioMemoryPeak(int blocks);
 
 #endif // NVRAM_H
@@ -0,0 +1,158 @@
+#include "arp.h"
+
+void ArpSequencer::pattern(uint8_t p)
+{
+    patternSetting = (p <= ARP_CHORD_STAB) ? p : (uint8_t)ARP_UP;
+}
+
+void ArpSequencer::stepSamples(uint32_t samples)
+{
+    stepLen = (samples < 1) ? 1 : samples;
+}
+
+void ArpSequencer::gate(float fraction)
+{
+    if (fraction < 0.05f)
+        fraction = 0.05f;
+    else if (fraction > 1.0f)
+        fraction = 1.0f;
+    gateQ16 = (int32_t)(fraction * 65536.0f);
+}
+
+void ArpSequencer::swing(float amount)
+{
+    if (amount < 0.0f)
+        amount = 0.0f;
+    else if (amount > 0.75f)
+        amount = 0.75f;
+    swingQ16 = (int32_t)(amount * 65536.0f);
+}
+
+// Start the next step: pick its voice(s) and schedule its length and
+// gate-off from the current settings
+void ArpSequencer::nextStep()
+{
+    static const int8_t upDown[4] = {0, 1, 2, 1};
+    uint32_t step = index++;
+    int v;
+    switch (patternSetting)
+    {
+    case ARP_DOWN:
+        v = 2 - (int)(step % 3);
+        break;
+    case ARP_UP_DOWN:
+        v = upDown[step % 4];
+        break;
+    case ARP_RANDOM:
+        seed = seed * 1664525u + 1013904223u;
+        v = (int)((seed >> 16) % 3);
+        break;
+    case ARP_CHORD_STAB:
+        v = -1;
+        break;
+    default: // ARP_UP
+        v = (int)(step % 3);
+        break;
+    }
+    stepVoice = v;
+    for (int k = 0; k < ARP_VOICES; k++)
+        gateTarget[k] = (v < 0 || k == v) ? 65536 : 0;
+
+    // swing: pairs of steps keep their total length
+    uint32_t len = stepLen;
+    int64_t sw = ((int64_t)len * swingQ16) >> 16;
+    len = (step & 1) ? (uint32_t)(len - sw) : (uint32_t)(len + sw);
+    if (len < 1)
+        len = 1;
+    untilStep = len;
+
+    int32_t g = gateQ16;
+    untilOff = (g >= 65536) ? 0 : (uint32_t)(((uint64_t)len * g) >> 16);
+    if (g < 65536 && untilOff < 1)
+        untilOff = 1;
+}
+
+// Steps and gate-offs are handled at their exact sample; gates move toward
+// their targets at ARP_GATE_RAMP_SAMPLES per full swing so steps do not
+// click.
+void ArpSequencer::render(int32_t *const gates[ARP_VOICES], uint32_t n, uint8_t state[ARP_VOICES])
+{
+    const int32_t rate = 65536 / ARP_GATE_RAMP_SAMPLES;
+
+    if (resetPending)
+    {
+        resetPending = false;
+        running = false;
+    }
+    if (enabled && !running)
+    {
+        running = true;
+        index = 0;
+        untilStep = 0; // first step starts now
+    }
+    else if (!enabled && running)
+    {
+        running = false;
+        stepVoice = -1;
+    }
+    if (!running)
+    {
+        for (int v = 0; v < ARP_VOICES; v++)
+            gateTarget[v] = 65536;
+    }
+
+    int32_t nonzero[ARP_VOICES] = {0, 0, 0};
+    bool full[ARP_VOICES] = {true, true, true};
+    uint32_t i = 0;
+    while (i < n)
+    {
+        uint32_t span = n - i;
+        if (running)
+        {
+            if (untilStep == 0)
+                nextStep();
+            if (untilStep < span)
+                span = untilStep;
+            if (untilOff && untilOff < span)
+                span = untilOff;
+        }
+
+        for (int v = 0; v < ARP_VOICES; v++)
+        {
+            int32_t g = gateLevel[v];
+            const int32_t t = gateTarget[v];
+            int32_t *out = gates[v] + i;
+            int32_t any = 0;
+            bool open = true;
+            for (uint32_t k = 0; k < span; k++)
+            {
+                int32_t d = t - g;
+                g += (d > rate) ? rate : ((d < -rate) ? -rate : d);
+                out[k] = g;
+                any |= g;
+                open = open && (g == 65536);
+            }
+            gateLevel[v] = g;
+            nonzero[v] |= any;
+            full[v] = full[v] && open;
+        }
+
+        i += span;
+        if (running)
+        {
+            untilStep -= span;
+            if (untilOff)
+            {
+                untilOff -= span;
+                if (untilOff == 0)
+                {
+                    for (int v = 0; v < ARP_VOICES; v++)
+                        gateTarget[v] = 0;
+                }
+            }
+        }
+    }
+
+    for (int v = 0; v < ARP_VOICES; v++)
+        state[v] = full[v] ? ARP_GATE_OPEN : (nonzero[v] ? ARP_GATE_RAMPING : ARP_GATE_CLOSED);
+}
@@ -0,0 +1,72 @@
+#ifndef ARP_H
+#define ARP_H
+
+#include <Arduino.h>
+
+// Arpeggiator step sequencer. Counts samples and turns steps into
+// per-sample voice gates, so steps and gate-offs land on exact sample
+// positions. The chord engine runs it once per audio update; it has no
+// audio library dependency so it can also be driven directly.
+#define ARP_VOICES 3 // root, third, fifth
+
+// Arpeggiator patterns (voice order: 0=root, 1=third, 2=fifth)
+enum ArpPattern
+{
+    ARP_UP = 0,
+    ARP_DOWN,
+    ARP_UP_DOWN,
+    ARP_RANDOM,
+    ARP_CHORD_STAB // all voices together, gated each step
+};
+
+// Samples over which a voice gate opens or closes (declick)
+#define ARP_GATE_RAMP_SAMPLES 64
+
+// Gate state of a voice over one render() span
+enum ArpGateState
+{
+    ARP_GATE_CLOSED = 0, // 0 throughout
+    ARP_GATE_OPEN = 1,   // full (65536) throughout
+    ARP_GATE_RAMPING = 2 // anything else; use the per-sample gates
+};
+
+class ArpSequencer
+{
+public:
+    // Settings are written by the main loop and picked up at the next step
+    void enable(bool on) { enabled = on; }
+    void reset() { resetPending = true; } // restart the pattern at its first step
+    void pattern(uint8_t p);
+    void stepSamples(uint32_t samples); // step length, at least 1
+    void gate(float fraction);          // part of each step a voice sounds (0.05 to 1.0)
+    void swing(float amount);           // lengthen even steps, shorten odd ones (0 to 0.75)
+    // Voice of the current step (0=root, 1=third, 2=fifth), -1 for all
+    int voice() const { return stepVoice; }
+
+    // Audio interrupt only: fill n samples of Q16 gate per voice and the
+    // state of each voice over them. While stopped all gates are open.
+    void render(int32_t *const gates[ARP_VOICES], uint32_t n, uint8_t state[ARP_VOICES]);
+
+private:
+    void nextStep();
+
+    // written by the main loop
+    volatile bool enabled = false;
+    volatile bool resetPending = false;
+    volatile uint8_t patternSetting = ARP_UP;
+    volatile uint32_t stepLen = 5512; // sixteenths at 120 BPM
+    volatile int32_t gateQ16 = 65536;
+    volatile int32_t swingQ16 = 0;
+
+    // audio interrupt state
+    bool running = false;
+    uint32_t index = 0;     // steps since the pattern started
+    uint32_t untilStep = 0; // samples to the next step
+    uint32_t untilOff = 0;  // samples to gate-off (0 = legato)
+    uint32_t seed = 1;
+    volatile int8_t stepVoice = -1;
+    int32_t gateTarget[ARP_VOICES] = {65536, 65536, 65536};
+    int32_t gateLevel[ARP_VOICES] = {65536, 65536, 65536};
+};
+
+#endif // ARP_H
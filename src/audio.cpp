@@ -1,17 +1,29 @@
 #include "audio.h"
 #include "pitch.h"
 #include "NVRAM.h"
-
-// Define audio objects - Simplified: 2 oscillators per voice (primary + detuned)
+#include "harmony.h"
+#include "latencyprobe.h"
+#include "gain.h"
+#include "config.h"
+#include "synth.h"
+#include "graph.h"
+#include "diag.h"
+#include "reverb.h"
+
+// Chord voice engine: all six oscillators rendered into one block
 // Voice 1 (root): myEffect + myEffect1b
 // Voice 2 (third): myEffect2 + myEffect2b
 // Voice 3 (fifth): myEffect3 + myEffect3b
-AudioSynthWaveform myEffect;   // root voice primary
-AudioSynthWaveform myEffect1b; // root voice detuned
-AudioSynthWaveform myEffect2;  // third voice primary
-AudioSynthWaveform myEffect2b; // third voice detuned
-AudioSynthWaveform myEffect3;  // fifth voice primary
-AudioSynthWaveform myEffect3b; // fifth voice detuned
+AudioSynthChord chordSynth;
+SynthOscillator &myEffect = chordSynth.osc[0];   // root voice primary
+SynthOscillator &myEffect1b = chordSynth.osc[1]; // root voice detuned
+SynthOscillator &myEffect2 = chordSynth.osc[2];  // third voice primary
+SynthOscillator &myEffect2b = chordSynth.osc[3]; // third voice detuned
+SynthOscillator &myEffect3 = chordSynth.osc[4];  // fifth voice primary
+SynthOscillator &myEffect3b = chordSynth.osc[5]; // fifth voice detuned
+
+// Chord volume, applied per sample to the engine output
+AudioEffectSmoothGain synthVolume;
 
 AudioInputI2S audioInput;   // Audio shield input
 AudioOutputI2S audioOutput; // Audio shield output
@@ -19,13 +31,13 @@ AudioMixer4 mixerLeft;      // Mix input + synth for left channel
 AudioMixer4 mixerRight;     // Mix input + synth for right channel
 AudioAnalyzePeak peak1;     // Input peak detection for test mode
 
-// Reverb + wet/dry mixers
-AudioEffectFreeverb reverb; // stereo freeverb
-AudioMixer4 wetDryLeft;     // mix dry (mixerLeft) + wet (reverb L)
-AudioMixer4 wetDryRight;    // mix dry (mixerRight) + wet (reverb R)
-
-// Synth voice mixer (combines oscillators for reverb input)
-AudioMixer4 synthMix; // combines all synth oscillators for reverb
+// Reverb engines + wet/dry mixers. Both engines stay patched; the one not
+// selected gets no input and stops once its tail has decayed.
+AudioEffectReverbSend reverbSend;            // Freeverb input, tracks silence
+AudioEffectFreeverbGated reverb(reverbSend); // stereo freeverb
+AudioEffectReverbFDN fdnReverb;              // 4-line FDN, the cheap engine
+AudioMixer4 wetDryLeft;                      // mix dry (mixerLeft) + wet (reverb L, FDN L)
+AudioMixer4 wetDryRight;                     // mix dry (mixerRight) + wet (reverb R, FDN R)
 
 // Audio shield control
 AudioControlSGTL5000 audioShield;
@@ -33,6 +45,7 @@ bool audioShieldEnabled = false;
 
 // Reverb wet control (0.0 = dry, 1.0 = fully wet)
 float reverbWet = 0.10f;
+int reverbEngine = REVERB_ENGINE; // REVERB_ENGINE_*
 
 // chord state
 bool chordActive = false;
@@ -50,62 +63,65 @@ float beepAmp = 0.5f;
 bool organVibratoEnabled = true;
 float organVibratoRate = 6.0f;    // Hz
 float organVibratoDepth = 0.015f; // fractional depth (±1.5%)
+// Glide between tonics (ms; per semitone with GLIDE_CONSTANT_RATE)
+const float glideTimesMs[GLIDE_TIME_COUNT] = {0.0f, 15.0f, 30.0f, 60.0f, 120.0f, 250.0f};
 
 // Detune ratios used by different sounds
 float organDetune = 1.002f;   // +~3.5 cents for organ
 float rhodesDetune = 1.0015f; // +2.6 cents for rhodes
 float stringsDetune = 1.004f; // +6.9 cents for strings
 
-// Base frequencies for vibrato application (set when organ is initialized/updated)
-float organBaseRootFreq = 440.0f;
-float organBaseThirdFreq = 440.0f;
-float organBaseFifthFreq = 440.0f;
+// Amplitude envelopes per sound (release comes from the fade/decay time)
+static const EnvelopeSettings soundEnvelopes[] = {
+    {5.0f, 0.0f, 1.0f, ENV_LINEAR},          // Sine: declick only
+    {5.0f, 0.0f, 1.0f, ENV_LINEAR},          // Organ: on/off like drawbars
+    {2.0f, 3000.0f, 0.5f, ENV_EXPONENTIAL},  // Rhodes: percussive decay while held
+    {350.0f, 0.0f, 1.0f, ENV_EXPONENTIAL},   // Strings: slow bow attack
+};
+
+// Set when the chord is silenced for a note transition (see muteChord)
+static bool chordMuted = false;
 
 // Rhodes decay state (2 second decay after FS1 release)
 bool rhodesDecaying = false;
 unsigned long rhodesDecayStartMs = 0;
 unsigned long rhodesDecayDurationMs = 2000; // 2 seconds
-float rhodesDecayStartAmp = 0.0f;
-
-// Arpeggiator state (120 BPM eighth notes)
-volatile int currentArpMode = 1;                // 0=Arp, 1=Poly (default Poly)
-volatile int arpCurrentStep = 0;                // 0=root, 1=third, 2=fifth
-volatile unsigned long arpStepDurationMs = 250; // base step (derived from tapped tempo, e.g. 250ms = 120BPM eighth) - effective timer rate will be doubled
-volatile bool arpTimerActive = false;           // True when arp timer is running
-float globalTempoBPM = 120.0f;                  // Global tempo
-
-// IntervalTimer for precise arpeggiator timing
-IntervalTimer arpTimer;
-
-// Audio connections
-AudioConnection patchInL(audioInput, 0, mixerLeft, 0);  // left input → mixer L ch0
-AudioConnection patchInR(audioInput, 1, mixerRight, 0); // right input → mixer R ch0
-AudioConnection patchPitch(audioInput, 0, noteDetect, 0);
-AudioConnection patchPeak(audioInput, 0, peak1, 0);
-
-// Connect primary oscillators directly to main mixers (ch1, ch2, ch3)
-AudioConnection patchOsc1ToL(myEffect, 0, mixerLeft, 1);
-AudioConnection patchOsc1ToR(myEffect, 0, mixerRight, 1);
-AudioConnection patchOsc2ToL(myEffect2, 0, mixerLeft, 2);
-AudioConnection patchOsc2ToR(myEffect2, 0, mixerRight, 2);
-AudioConnection patchOsc3ToL(myEffect3, 0, mixerLeft, 3);
-AudioConnection patchOsc3ToR(myEffect3, 0, mixerRight, 3);
-
-// Connect all oscillators to synth mixer for reverb input
-AudioConnection patchSynth1(myEffect, 0, synthMix, 0);
-AudioConnection patchSynth2(myEffect2, 0, synthMix, 1);
-AudioConnection patchSynth3(myEffect3, 0, synthMix, 2);
-// Note: detuned oscillators (myEffect1b, myEffect2b, myEffect3b) are summed
-// with primary oscillators at the amplitude level, so no separate routing needed
+
+// Arpeggiator state; the sequencer itself runs in the chord engine
+volatile int currentArpMode = ARP_MODE_POLY; // see ARP_MODE_* (default Poly)
+float globalTempoBPM = 120.0f;               // Global tempo
+
+// Audio connections: made by graphConnect() in setupAudio, from the
+// tables below, so objects defined in other files are fully constructed
+AudioConnection patchInL;       // left input → mixer L ch0
+AudioConnection patchInR;       // right input → mixer R ch0
+AudioConnection patchPitch;
+AudioConnection patchOnset;
+AudioConnection patchPeak;
+
+// Chord engine through the volume stage to the main mixers (ch1) and reverb
+AudioConnection patchSynthGain;
+AudioConnection patchSynthToL;
+AudioConnection patchSynthToR;
 
 // Reverb and output
-AudioConnection patchReverbIn(synthMix, 0, reverb, 0);
-AudioConnection patchDryL(mixerLeft, 0, wetDryLeft, 0);
-AudioConnection patchWetL(reverb, 0, wetDryLeft, 1);
-AudioConnection patchDryR(mixerRight, 0, wetDryRight, 0);
-AudioConnection patchWetR(reverb, 1, wetDryRight, 1);
-AudioConnection patchOutL(wetDryLeft, 0, audioOutput, 0);
-AudioConnection patchOutR(wetDryRight, 0, audioOutput, 1);
+AudioConnection patchReverbSend;
+AudioConnection patchReverbIn;
+AudioConnection patchFdnIn;
+AudioConnection patchDryL;
+AudioConnection patchWetL;
+AudioConnection patchFdnL;
+AudioConnection patchDryR;
+AudioConnection patchWetR;
+AudioConnection patchFdnR;
+AudioConnection patchOutL;
+AudioConnection patchOutR;
+
+// Latency probe: timestamps the first audible synth block after a chord change
+AudioConnection patchLatency;
+
+// Every audio object and connection, as tables
+#include "audiograph.h"
 
 void setReverbWet(float wet)
 {
@@ -118,58 +134,25 @@ void setReverbWet(float wet)
     float wetGain = reverbWet;
     wetDryLeft.gain(0, dryGain);
     wetDryLeft.gain(1, wetGain);
+    wetDryLeft.gain(2, wetGain);
     wetDryRight.gain(0, dryGain);
     wetDryRight.gain(1, wetGain);
+    wetDryRight.gain(2, wetGain);
 }
 
-float getDiatonicThird(float noteFreq, int keyNote, int mode)
+void setReverbEngine(int engine)
 {
-    // Convert frequency to MIDI note number
-    float midiNote = 12.0f * log2f(noteFreq / 440.0f) + 69.0f;
-    int noteClass = ((int)round(midiNote)) % 12; // 0-11 chromatic position
-
-    // Calculate position in scale relative to key
-    int relativePosition = (noteClass - keyNote + 12) % 12;
-
-    // Determine the third interval based on selected mode
-    int thirdSemitones = 3; // default to minor third
-
-    if (mode == 0)
-    {
-        // Major mode: diatonic selection based on scale degree
-        if (relativePosition == 0 || relativePosition == 5 || relativePosition == 7)
-        {
-            thirdSemitones = 4; // major third
-        }
-        else if (relativePosition == 2 || relativePosition == 4 || relativePosition == 9 || relativePosition == 11)
-        {
-            thirdSemitones = 3; // minor third
-        }
-    }
-    else if (mode == 1)
-    {
-        // Natural minor: diatonic selection
-        if (relativePosition == 3 || relativePosition == 8 || relativePosition == 10)
-        {
-            thirdSemitones = 4; // major third
-        }
-        else if (relativePosition == 0 || relativePosition == 2 || relativePosition == 5 || relativePosition == 7)
-        {
-            thirdSemitones = 3; // minor third
-        }
-    }
-    else if (mode == 2)
-    {
-        // Fixed Major: always major third
-        thirdSemitones = 4;
-    }
-    else if (mode == 3)
-    {
-        // Fixed Minor: always minor third
-        thirdSemitones = 3;
-    }
+    reverbEngine = (engine == REVERB_ENGINE_FDN) ? REVERB_ENGINE_FDN : REVERB_ENGINE_FREEVERB;
+    reverbSend.enable(reverbEngine == REVERB_ENGINE_FREEVERB);
+    fdnReverb.enable(reverbEngine == REVERB_ENGINE_FDN);
+}
 
-    return powf(2.0f, thirdSemitones / 12.0f);
+// Diatonic third above the chord root, as a frequency ratio.
+// Intervals come from the compile-time table in harmony.h.
+float getDiatonicThird(float noteFreq, int keyNote, int mode)
+{
+    int noteClass = freqToPitchClass(noteFreq);
+    return semitoneRatio[chordThirdSemitones(keyNote, mode, noteClass)];
 }
 
 // Determine fifth interval ratio.
@@ -177,36 +160,13 @@ float getDiatonicThird(float noteFreq, int keyNote, int mode)
 // in Major (mode==0) or Natural Minor (mode==1).
 float getDiatonicFifth(float noteFreq, int keyNote, int mode)
 {
-    int fifthSemitones = 7; // perfect fifth by default
-
-    // Major or Natural Minor: use diminished fifth for 7th scale degree
-    if (mode == 0 || mode == 1)
+    int noteClass = freqToPitchClass(noteFreq);
+    int fifthSemitones = chordFifthSemitones(keyNote, mode, noteClass);
+    if (fifthSemitones == 6)
     {
-        // Determine the scale degree of the detected note
-        float midiNote = 12.0f * log2f(noteFreq / 440.0f) + 69.0f;
-        int noteClass = ((int)round(midiNote)) % 12; // 0-11 chromatic position
-        int relativePosition = (noteClass - keyNote + 12) % 12;
-
-        if (mode == 0) // Major mode
-        {
-            // 7th scale degree in major is 11 semitones above root (e.g., D# in E major)
-            if (relativePosition == 11)
-            {
-                Serial.println("Using flat-5 for 7th degree (diminished fifth)");
-                fifthSemitones = 6; // flat-5
-            }
-        }
-        else if (mode == 1) // Natural minor mode
-        {
-            // 7th scale degree in natural minor is 2 semitones above (e.g. B in A minor )
-            if (relativePosition == 2)
-            {
-                Serial.println("Using flat-5 for 7th degree (diminished fifth)");
-                fifthSemitones = 6; // flat-5
-            }
-        }
+        Serial.println("Using flat-5 for 7th degree (diminished fifth)");
     }
-    return powf(2.0f, fifthSemitones / 12.0f);
+    return semitoneRatio[fifthSemitones];
 }
 
 void restoreMixerGains(float synthGain)
@@ -217,25 +177,13 @@ void restoreMixerGains(float synthGain)
 
     if (currentOutputMode == 1) // Split mode
     {
-        // Left channel: guitar only (no synth)
-        mixerLeft.gain(1, 0.0f);
-        mixerLeft.gain(2, 0.0f);
-        mixerLeft.gain(3, 0.0f);
-
-        // Right channel: synth only
+        mixerLeft.gain(1, 0.0f); // Left channel: guitar only (no synth)
         mixerRight.gain(1, synthGain);
-        mixerRight.gain(2, synthGain);
-        mixerRight.gain(3, synthGain);
     }
     else // Mix mode
     {
-        // Both channels: synth
         mixerLeft.gain(1, synthGain);
-        mixerLeft.gain(2, synthGain);
-        mixerLeft.gain(3, synthGain);
         mixerRight.gain(1, synthGain);
-        mixerRight.gain(2, synthGain);
-        mixerRight.gain(3, synthGain);
     }
 }
 
@@ -248,7 +196,7 @@ void stopAllOscillators()
     myEffect3.amplitude(0);
     myEffect3b.amplitude(0);
 
-    // Restore mixer gains to normal when stopping (in case arp mode left them muted)
+    // Restore mixer gains to normal when stopping
     restoreMixerGains(0.8f);
 }
 
@@ -303,13 +251,8 @@ void initOrganSound(float tonic, float third, float fifth, float octaveMul, floa
     myEffect3b.frequency(tonic * fifth * octaveMul * organDetune);
     myEffect3b.amplitude(ampPerOsc);
 
-    // Store base freqs for vibrato
-    organBaseRootFreq = tonic * octaveMul;
-    organBaseThirdFreq = tonic * third * octaveMul;
-    organBaseFifthFreq = tonic * fifth * octaveMul;
-
     Serial.print("Organ sound: root=");
-    Serial.print(organBaseRootFreq);
+    Serial.print(tonic * octaveMul);
     Serial.print("Hz, ampPerOsc=");
     Serial.println(ampPerOsc);
 }
@@ -357,32 +300,34 @@ void initRhodesSound(float tonic, float third, float fifth, float octaveMul, flo
 
 void initStringsSound(float tonic, float third, float fifth, float octaveMul, float perVoice)
 {
-    // Strings sound - 2 sawtooth oscillators per voice for rich ensemble
+    // Strings sound - 2 sawtooth oscillators per voice for rich ensemble.
+    // Band-limited so high tonics (octave +1/+2) do not alias.
     stopAllOscillators();
+    const short saw = STRINGS_BANDLIMITED ? WAVEFORM_BANDLIMIT_SAWTOOTH : WAVEFORM_SAWTOOTH;
 
     float ampPerOsc = perVoice / 2.0f; // equal amplitude for both oscillators
 
     // Root voice
-    myEffect.begin(WAVEFORM_SAWTOOTH);
+    myEffect.begin(saw);
     myEffect.frequency(tonic * octaveMul);
     myEffect.amplitude(ampPerOsc);
-    myEffect1b.begin(WAVEFORM_SAWTOOTH);
+    myEffect1b.begin(saw);
     myEffect1b.frequency(tonic * octaveMul * stringsDetune);
     myEffect1b.amplitude(ampPerOsc);
 
     // Third voice
-    myEffect2.begin(WAVEFORM_SAWTOOTH);
+    myEffect2.begin(saw);
     myEffect2.frequency(tonic * third * octaveMul);
     myEffect2.amplitude(ampPerOsc);
-    myEffect2b.begin(WAVEFORM_SAWTOOTH);
+    myEffect2b.begin(saw);
     myEffect2b.frequency(tonic * third * octaveMul * stringsDetune);
     myEffect2b.amplitude(ampPerOsc);
 
     // Fifth voice
-    myEffect3.begin(WAVEFORM_SAWTOOTH);
+    myEffect3.begin(saw);
     myEffect3.frequency(tonic * fifth * octaveMul);
     myEffect3.amplitude(ampPerOsc);
-    myEffect3b.begin(WAVEFORM_SAWTOOTH);
+    myEffect3b.begin(saw);
     myEffect3b.frequency(tonic * fifth * octaveMul * stringsDetune);
     myEffect3b.amplitude(ampPerOsc);
 }
@@ -399,6 +344,8 @@ void startChord(float potNorm, float tonicFreq, int keyNote, int mode)
     currentChordTonic = tonic;
     // clear suppression when starting chord explicitly
     chordSuppressed = false;
+    // a chord that is still sounding (not fading out) is retuned legato
+    bool legato = chordActive && !chordFading;
     // cancel any fade in progress
     chordFading = false;
 
@@ -407,12 +354,23 @@ void startChord(float potNorm, float tonicFreq, int keyNote, int mode)
     const float fifth = getDiatonicFifth(tonic, keyNote, mode);
 
     // apply octave shift
-    float octaveMul = powf(2.0f, (float)currentOctaveShift);
+    float octaveMul = octaveRatio(currentOctaveShift);
 
+    // Volume is applied by the volume stage; oscillators run at full level.
     // If no valid pitch detected yet, start silent (amplitude will be set when pitch is detected)
-    float perVoice = hasValidPitch ? (potNorm / 3.0f) : 0.0f;
+    setSynthVolume(potNorm);
+    float perVoice = hasValidPitch ? (1.0f / 3.0f) : 0.0f;
 
     // Initialize sound based on currentSynthSound selection
+    int sound = (currentSynthSound >= 0 && currentSynthSound <= 3) ? currentSynthSound : 0;
+    chordSynth.envelopeSettings(soundEnvelopes[sound]);
+    // retune all oscillators in one audio update; glide only from a pitch
+    // that is actually sounding
+    AudioNoInterrupts();
+    if ((GLIDE_LEGATO_ONLY && !legato) || !hasValidPitch)
+        chordSynth.glideSnap();
+    if (!legato)
+        chordSynth.bend(0.0f); // a Follow bend belongs to the note that stopped
     if (currentSynthSound == 1) // Organ
     {
         initOrganSound(tonic, third, fifth, octaveMul, perVoice);
@@ -429,6 +387,7 @@ void startChord(float potNorm, float tonicFreq, int keyNote, int mode)
     {
         initSineSound(tonic, third, fifth, octaveMul, perVoice);
     }
+    AudioInterrupts();
 
     if (!chordActive)
     {
@@ -443,20 +402,23 @@ void startChord(float potNorm, float tonicFreq, int keyNote, int mode)
     }
     digitalWrite(LED_BUILTIN, HIGH);
 
-    beepAmp = hasValidPitch ? potNorm : 0.0f;
+    beepAmp = hasValidPitch ? 1.0f : 0.0f;
     chordActive = true;
 
-    // Reset arpeggiator state when starting chord
-    arpCurrentStep = 0;
+    // Attack from the current level (no click); a transition mute holds
+    // the note until it ends
+    if (!chordMuted)
+        chordSynth.noteOn();
 
-    // Start arp timer if in arp mode (only if we have valid pitch)
-    if (currentArpMode == 0 && hasValidPitch)
-    {
-        startArpTimer();
-    }
+    // Restart the arp pattern from its first step
+    chordSynth.arpReset();
+    updateArpeggiator();
 }
 
-void updateChordTonic(float tonicFreq, int keyNote, int mode)
+// Retune the chord to a new tonic. rebase: the pitch is not meant to move
+// (a Follow bend is swapped for the new tonic), so the bend is set and the
+// glide skipped in the same audio update.
+static void retuneChord(float tonicFreq, int keyNote, int mode, bool rebase, float bendCents)
 {
     if (!chordActive || tonicFreq <= 0.0f)
         return;
@@ -471,22 +433,24 @@ void updateChordTonic(float tonicFreq, int keyNote, int mode)
     const float fifth = getDiatonicFifth(tonicFreq, keyNote, mode);
 
     // apply octave shift
-    float octaveMul = powf(2.0f, (float)currentOctaveShift);
-
-    // Update frequencies based on current sound
+    float octaveMul = octaveRatio(currentOctaveShift);
+
+    // Update frequencies based on current sound. The chord engine glides
+    // to them; after a silent start there is nothing to glide from.
+    AudioNoInterrupts();
+    if (wasWaitingForPitch || rebase)
+        chordSynth.glideSnap();
+    if (rebase)
+        chordSynth.bend(bendCents, true);
     if (currentSynthSound == 1) // Organ
     {
-        // update base frequencies (vibrato will modulate these)
-        organBaseRootFreq = tonicFreq * octaveMul;
-        organBaseThirdFreq = tonicFreq * third * octaveMul;
-        organBaseFifthFreq = tonicFreq * fifth * octaveMul;
-
-        myEffect.frequency(organBaseRootFreq);
-        myEffect1b.frequency(organBaseRootFreq * organDetune);
-        myEffect2.frequency(organBaseThirdFreq);
-        myEffect2b.frequency(organBaseThirdFreq * organDetune);
-        myEffect3.frequency(organBaseFifthFreq);
-        myEffect3b.frequency(organBaseFifthFreq * organDetune);
+        // the chord engine's LFO adds the vibrato on top
+        myEffect.frequency(tonicFreq * octaveMul);
+        myEffect1b.frequency(tonicFreq * octaveMul * organDetune);
+        myEffect2.frequency(tonicFreq * third * octaveMul);
+        myEffect2b.frequency(tonicFreq * third * octaveMul * organDetune);
+        myEffect3.frequency(tonicFreq * fifth * octaveMul);
+        myEffect3b.frequency(tonicFreq * fifth * octaveMul * organDetune);
     }
     else if (currentSynthSound == 2) // Rhodes
     {
@@ -512,6 +476,7 @@ void updateChordTonic(float tonicFreq, int keyNote, int mode)
         myEffect2.frequency(tonicFreq * third * octaveMul);
         myEffect3.frequency(tonicFreq * fifth * octaveMul);
     }
+    AudioInterrupts();
 
     // If we were waiting for pitch detection and now have it, start arpeggiator if needed
     if (wasWaitingForPitch)
@@ -519,31 +484,31 @@ void updateChordTonic(float tonicFreq, int keyNote, int mode)
         Serial.println(">>> PITCH DETECTED, chord now active at " + String(tonicFreq) + "Hz");
         // Arpeggiator will be started by updateArpeggiator() in main loop if in arp mode
     }
-    else
-    {
-        Serial.println(">>> CHORD UPDATE tonic " + String(tonicFreq) + "Hz");
-    }
 }
 
-// Periodic vibrato update: called from main loop
+void updateChordTonic(float tonicFreq, int keyNote, int mode)
+{
+    retuneChord(tonicFreq, keyNote, mode, false, 0.0f);
+}
+
+void rebaseChordTonic(float tonicFreq, float bendCents, int keyNote, int mode)
+{
+    retuneChord(tonicFreq, keyNote, mode, true, bendCents);
+}
+
+// Periodic vibrato update: called from main loop. The chord engine runs
+// the LFOs per sample; this only passes on the settings (organ only),
+// which the engine smooths, so it can run every control tick.
 void updateVibrato()
 {
-    // Only apply vibrato when organ is selected, chord is active, and vibrato enabled
-    if (!organVibratoEnabled || currentSynthSound != 1 || !chordActive || chordFading)
-        return;
+    bool on = organVibratoEnabled && currentSynthSound == 1;
+    chordSynth.vibrato(organVibratoRate, on ? organVibratoDepth : 0.0f);
+}
 
-    // time in seconds
-    float t = (float)micros() / 1000000.0f;
-    float lfo = sinf(TWO_PI * organVibratoRate * t);
-    float mult = 1.0f + lfo * organVibratoDepth;
-
-    // Apply vibrato to each voice and their detuned companions
-    myEffect.frequency(organBaseRootFreq * mult);
-    myEffect1b.frequency(organBaseRootFreq * mult * organDetune);
-    myEffect2.frequency(organBaseThirdFreq * mult);
-    myEffect2b.frequency(organBaseThirdFreq * mult * organDetune);
-    myEffect3.frequency(organBaseFifthFreq * mult);
-    myEffect3b.frequency(organBaseFifthFreq * mult * organDetune);
+void applyGlide()
+{
+    int g = (currentGlide >= 0 && currentGlide < GLIDE_TIME_COUNT) ? currentGlide : 0;
+    chordSynth.glide(glideTimesMs[g], GLIDE_CONSTANT_RATE ? GLIDE_RATE : GLIDE_TIME);
 }
 
 void startRhodesDecay()
@@ -553,7 +518,7 @@ void startRhodesDecay()
 
     rhodesDecaying = true;
     rhodesDecayStartMs = millis();
-    rhodesDecayStartAmp = beepAmp;
+    chordSynth.noteOff(rhodesDecayDurationMs);
     Serial.println(">>> RHODES DECAY START");
 }
 
@@ -562,9 +527,8 @@ void updateRhodesDecay()
     if (!rhodesDecaying)
         return;
 
-    unsigned long nowMs = millis();
-    unsigned long elapsed = nowMs - rhodesDecayStartMs;
-
+    // The decay itself runs in the envelope; finish once its time is up
+    unsigned long elapsed = millis() - rhodesDecayStartMs;
     if (elapsed >= rhodesDecayDurationMs)
     {
         // Decay complete: silence oscillators
@@ -575,25 +539,6 @@ void updateRhodesDecay()
         beepAmp = 0.0f;
         Serial.println(">>> RHODES DECAY COMPLETE");
     }
-    else
-    {
-        // Apply linear decay curve
-        float t = (float)elapsed / (float)rhodesDecayDurationMs; // 0..1
-        float curAmp = rhodesDecayStartAmp * (1.0f - t);
-
-        float perVoice = curAmp / 3.0f;
-        float mainAmp = perVoice * 0.65f;
-        float companionAmp = perVoice * 0.35f;
-
-        myEffect.amplitude(mainAmp);
-        myEffect1b.amplitude(companionAmp);
-        myEffect2.amplitude(mainAmp);
-        myEffect2b.amplitude(companionAmp);
-        myEffect3.amplitude(mainAmp);
-        myEffect3b.amplitude(companionAmp);
-
-        beepAmp = curAmp;
-    }
 }
 
 void stopChord()
@@ -601,11 +546,8 @@ void stopChord()
     if (!chordActive)
         return;
 
-    // Stop arp timer if running
-    if (arpTimerActive)
-    {
-        stopArpTimer();
-    }
+    // All voices sound through the fade
+    chordSynth.arpeggiate(false);
 
     // If a fade duration is set, perform a non-blocking fade-out
     if (chordFadeDurationMs > 0)
@@ -613,6 +555,7 @@ void stopChord()
         chordFading = true;
         chordFadeStartMs = millis();
         chordFadeStartAmp = beepAmp; // capture current overall amplitude (0.0-1.0)
+        chordSynth.noteOff(chordFadeDurationMs);
         // brief visible/audible indication that fade has started
         Serial.println(">>> CHORD END (fade start)");
         digitalWrite(LED_BUILTIN, HIGH);
@@ -621,6 +564,7 @@ void stopChord()
     }
 
     // Immediate stop (no fade)
+    chordSynth.noteOff(0.0f);
     stopAllOscillators();
     digitalWrite(LED_BUILTIN, LOW);
     chordActive = false;
@@ -629,16 +573,26 @@ void stopChord()
     Serial.println(">>> CHORD END");
 }
 
-void updateChordVolume(float potNorm)
+void setSynthVolume(float volume)
+{
+    synthVolume.gain(volume);
+}
+
+void updateChordVolume(float volume)
 {
+    // The volume itself is smoothed per sample by the volume stage;
+    // here the oscillators are (re)set to full level unless fading
+    setSynthVolume(volume);
+
     if (chordActive || chordFading)
     {
         if (!chordFading)
         {
-            // Apply volume based on current sound
+            // Full-level amplitudes for the current sound
+            const float level = 1.0f;
             if (currentSynthSound == 1) // Organ
             {
-                float ampPerOsc = potNorm / 6.0f; // 6 total oscillators
+                float ampPerOsc = level / 6.0f; // 6 total oscillators
                 myEffect.amplitude(ampPerOsc);
                 myEffect1b.amplitude(ampPerOsc);
                 myEffect2.amplitude(ampPerOsc);
@@ -648,8 +602,8 @@ void updateChordVolume(float potNorm)
             }
             else if (currentSynthSound == 2) // Rhodes
             {
-                float mainAmp = potNorm / 3.0f * 0.65f;
-                float companionAmp = potNorm / 3.0f * 0.35f;
+                float mainAmp = level / 3.0f * 0.65f;
+                float companionAmp = level / 3.0f * 0.35f;
                 myEffect.amplitude(mainAmp);
                 myEffect1b.amplitude(companionAmp);
                 myEffect2.amplitude(mainAmp);
@@ -659,7 +613,7 @@ void updateChordVolume(float potNorm)
             }
             else if (currentSynthSound == 3) // Strings
             {
-                float ampPerOsc = potNorm / 6.0f; // 6 total oscillators
+                float ampPerOsc = level / 6.0f; // 6 total oscillators
                 myEffect.amplitude(ampPerOsc);
                 myEffect1b.amplitude(ampPerOsc);
                 myEffect2.amplitude(ampPerOsc);
@@ -669,88 +623,65 @@ void updateChordVolume(float potNorm)
             }
             else // Sine
             {
-                float perVoice = potNorm / 3.0f;
+                float perVoice = level / 3.0f;
                 myEffect.amplitude(perVoice);
                 myEffect2.amplitude(perVoice);
                 myEffect3.amplitude(perVoice);
             }
-            beepAmp = potNorm;
+            beepAmp = level;
         }
     }
 }
 
 void updateChordFade()
 {
-    if (chordFading)
+    if (!chordFading)
+        return;
+
+    // The fade itself runs in the envelope; finish once its time is up
+    unsigned long elapsed = millis() - chordFadeStartMs;
+    if (elapsed >= chordFadeDurationMs)
     {
-        unsigned long nowMs = millis();
-        unsigned long elapsed = nowMs - chordFadeStartMs;
-        if (elapsed >= chordFadeDurationMs)
-        {
-            // Fade complete
-            stopAllOscillators();
-            digitalWrite(LED_BUILTIN, LOW);
-            chordFading = false;
-            chordActive = false;
-            chordSuppressed = true;
-            beepAmp = 0.0f;
-            Serial.println(">>> CHORD END (fade complete)");
-        }
-        else
-        {
-            float t = (float)elapsed / (float)chordFadeDurationMs; // 0..1
-            float curAmp = chordFadeStartAmp * (1.0f - t);
+        // Fade complete
+        stopAllOscillators();
+        digitalWrite(LED_BUILTIN, LOW);
+        chordFading = false;
+        chordActive = false;
+        chordSuppressed = true;
+        beepAmp = 0.0f;
+        Serial.println(">>> CHORD END (fade complete)");
+    }
+}
 
-            // Calculate per-oscillator amplitude based on current sound
-            if (currentSynthSound == 1) // Organ
-            {
-                float ampPerOsc = curAmp / 6.0f;
-                myEffect.amplitude(ampPerOsc);
-                myEffect1b.amplitude(ampPerOsc);
-                myEffect2.amplitude(ampPerOsc);
-                myEffect2b.amplitude(ampPerOsc);
-                myEffect3.amplitude(ampPerOsc);
-                myEffect3b.amplitude(ampPerOsc);
-            }
-            else if (currentSynthSound == 2) // Rhodes
-            {
-                float perVoice = curAmp / 3.0f;
-                float mainAmp = perVoice * 0.65f;
-                float companionAmp = perVoice * 0.35f;
-                myEffect.amplitude(mainAmp);
-                myEffect1b.amplitude(companionAmp);
-                myEffect2.amplitude(mainAmp);
-                myEffect2b.amplitude(companionAmp);
-                myEffect3.amplitude(mainAmp);
-                myEffect3b.amplitude(companionAmp);
-            }
-            else if (currentSynthSound == 3) // Strings
-            {
-                float ampPerOsc = curAmp / 6.0f;
-                myEffect.amplitude(ampPerOsc);
-                myEffect1b.amplitude(ampPerOsc);
-                myEffect2.amplitude(ampPerOsc);
-                myEffect2b.amplitude(ampPerOsc);
-                myEffect3.amplitude(ampPerOsc);
-                myEffect3b.amplitude(ampPerOsc);
-            }
-            else // Sine
-            {
-                float perVoice = curAmp / 3.0f;
-                myEffect.amplitude(perVoice);
-                myEffect2.amplitude(perVoice);
-                myEffect3.amplitude(perVoice);
-            }
-            beepAmp = curAmp;
-        }
+void muteChord(bool mute)
+{
+    if (mute)
+    {
+        if (chordSynth.gated())
+            chordSynth.noteOff(CHORD_MUTE_RELEASE_MS);
+        chordMuted = true;
+    }
+    else if (chordMuted)
+    {
+        chordMuted = false;
+        if (chordActive && !chordFading && !rhodesDecaying)
+            chordSynth.noteOn();
     }
 }
 
 void setupAudio()
 {
-    // Allocate audio memory
-    AudioMemory(64); // Reduced from 128 since we have fewer objects
-    Serial.println("Audio memory allocated");
+    // Allocate audio memory, sized from the peak measured in earlier sessions
+    setupAudioMemory();
+
+    // Wire up the graph and check it
+    graphSetup(audioNodes, sizeof(audioNodes) / sizeof(audioNodes[0]), audioEdges,
+               sizeof(audioEdges) / sizeof(audioEdges[0]));
+    graphConnect();
+    graphAudit();
+
+    // Volume changes glide over a few milliseconds instead of stepping
+    synthVolume.smoothing(VOLUME_SMOOTH_MS);
 
     // Initialize audio shield
     if (audioShield.enable())
@@ -796,7 +727,10 @@ void setupAudio()
     myEffect3b.frequency(1000);
     myEffect3b.amplitude(0);
 
-    Serial.println("Waveforms initialized (6 oscillators total)");
+    Serial.println("Chord engine initialized (6 oscillators total)");
+
+    // Arpeggiator timing from the global tempo
+    updateArpTempo();
 
     // Configure mixers
 #define BOOST_INPUT_GAIN false
@@ -804,14 +738,14 @@ void setupAudio()
     float synthGain = 0.2;
 
     mixerLeft.gain(0, inputGain); // input left
-    mixerLeft.gain(1, synthGain); // synth root
-    mixerLeft.gain(2, synthGain); // synth 3rd
-    mixerLeft.gain(3, synthGain); // synth 5th
+    mixerLeft.gain(1, synthGain); // chord engine
+    mixerLeft.gain(2, 0.0f);      // unused
+    mixerLeft.gain(3, 0.0f);      // unused
 
     mixerRight.gain(0, inputGain); // input right
-    mixerRight.gain(1, synthGain); // synth root
-    mixerRight.gain(2, synthGain); // synth 3rd
-    mixerRight.gain(3, synthGain); // synth 5th
+    mixerRight.gain(1, synthGain); // chord engine
+    mixerRight.gain(2, 0.0f);      // unused
+    mixerRight.gain(3, 0.0f);      // unused
 
     Serial.print("Audio mixers configured: input gain ");
     Serial.print(inputGain);
@@ -820,153 +754,76 @@ void setupAudio()
 
     // Initialize reverb wet/dry balance
     setReverbWet(reverbWet);
-    reverb.roomsize(0.6f);
-    reverb.damping(0.5f);
-
-    // Configure synth mixer (for reverb input)
-    synthMix.gain(0, 1.0f);
-    synthMix.gain(1, 1.0f);
-    synthMix.gain(2, 1.0f);
-    synthMix.gain(3, 0.0f); // unused
-
-    Serial.println("Synth mixer configured");
+    reverb.roomsize(REVERB_ROOMSIZE);
+    reverb.damping(REVERB_DAMPING);
+    fdnReverb.roomsize(REVERB_ROOMSIZE);
+    fdnReverb.damping(REVERB_DAMPING);
+    setReverbEngine(reverbEngine);
 
     // Apply output mode (Mix vs Split) from NVRAM
     applyOutputMode();
 
     // Startup beep
     Serial.println("Playing startup beep 100ms @ 0.7");
+    chordSynth.envelopeSettings(soundEnvelopes[0]);
     myEffect.frequency(1000);
     myEffect.amplitude(0.7);
+    chordSynth.noteOn();
     delay(100);
+    chordSynth.noteOff(CHORD_MUTE_RELEASE_MS);
+    delay(10);
     myEffect.amplitude(0);
     Serial.println("Startup beep complete");
 }
 
-// Arpeggiator timer ISR
-void arpTimerISR()
+// Arp pattern for each arp mode (ARP_MODE_POLY has none)
+static uint8_t arpModePattern(int mode)
 {
-    if (!chordActive || chordFading)
-        return;
-
-    // Mute all synth voices first
-    // Note: In split mode, only right channel has synth (left has guitar)
-    mixerLeft.gain(1, 0.0f);
-    mixerLeft.gain(2, 0.0f);
-    mixerLeft.gain(3, 0.0f);
-    mixerRight.gain(1, 0.0f);
-    mixerRight.gain(2, 0.0f);
-    mixerRight.gain(3, 0.0f);
-
-    // Unmute only the current step voice
-    float synthGain = 0.8f;
-
-    // In split mode, synth is only on right channel
-    // In mix mode, synth is on both channels
-    switch (arpCurrentStep)
-    {
-    case 0:                         // Root voice
-        if (currentOutputMode == 0) // Mix mode
-            mixerLeft.gain(1, synthGain);
-        mixerRight.gain(1, synthGain);
-        break;
-    case 1:                         // Third voice
-        if (currentOutputMode == 0) // Mix mode
-            mixerLeft.gain(2, synthGain);
-        mixerRight.gain(2, synthGain);
-        break;
-    case 2:                         // Fifth voice
-        if (currentOutputMode == 0) // Mix mode
-            mixerLeft.gain(3, synthGain);
-        mixerRight.gain(3, synthGain);
-        break;
-    }
-
-    // Advance to next step
-    arpCurrentStep++;
-    if (arpCurrentStep > 2)
-    {
-        arpCurrentStep = 0;
+    switch (mode)
+    {
+    case ARP_MODE_DOWN:
+        return ARP_DOWN;
+    case ARP_MODE_UP_DOWN:
+        return ARP_UP_DOWN;
+    case ARP_MODE_RANDOM:
+        return ARP_RANDOM;
+    case ARP_MODE_STAB:
+        return ARP_CHORD_STAB;
+    default:
+        return ARP_UP;
     }
 }
 
-void startArpTimer()
+// Stab plays every voice on every step, so it only sounds like steps
+// with a gate shorter than the step
+static float arpModeGate(int mode)
 {
-    if (arpTimerActive)
-        return;
-
-    // Use half the configured step duration so the arp runs at double the rate
-    unsigned long effectiveStepMs = (arpStepDurationMs > 1) ? (arpStepDurationMs / 2) : arpStepDurationMs;
-    unsigned long intervalUs = effectiveStepMs * 1000;
-    arpTimer.begin(arpTimerISR, intervalUs);
-    arpTimerActive = true;
-
-    // Immediately apply the first step
-    arpTimerISR();
-
-    Serial.println("Arp timer started");
+    return (mode == ARP_MODE_STAB) ? ARP_STAB_GATE : ARP_GATE;
 }
 
-void stopArpTimer()
+void updateArpTempo()
 {
-    if (!arpTimerActive)
-        return;
-
-    arpTimer.end();
-    arpTimerActive = false;
-
-    // Restore normal voice levels
-    restoreMixerGains(0.8f);
-
-    Serial.println("Arp timer stopped");
-}
-
-void updateArpTimerInterval()
-{
-    if (!arpTimerActive)
-        return;
-
-    arpTimer.end();
-
-    // Use half the configured step duration so the arp runs at double the rate
-    unsigned long effectiveStepMs = (arpStepDurationMs > 1) ? (arpStepDurationMs / 2) : arpStepDurationMs;
-    unsigned long intervalUs = effectiveStepMs * 1000;
-    arpTimer.begin(arpTimerISR, intervalUs);
-
-    Serial.print("Arp timer interval updated to ");
-    Serial.print(arpStepDurationMs);
-    Serial.println(" ms (effective rate doubled)");
+    chordSynth.arpTempo(globalTempoBPM, ARP_STEPS_PER_BEAT);
+    chordSynth.arpGate(arpModeGate(currentArpMode));
+    chordSynth.arpSwing(ARP_SWING);
 }
 
 void updateArpeggiator()
 {
-    if (!chordActive || chordFading)
-    {
-        if (arpTimerActive)
-        {
-            stopArpTimer();
-        }
-        return;
-    }
+    // Keep the synth level on the mixers (applyOutputMode starts it lower)
+    restoreMixerGains(0.8f);
 
-    if (currentArpMode == 0) // Arp mode
+    // Poly mode, or no chord / fading: all voices sound together
+    if (!chordActive || chordFading || currentArpMode == ARP_MODE_POLY)
     {
-        if (!arpTimerActive)
-        {
-            arpCurrentStep = 0;
-            startArpTimer();
-        }
+        chordSynth.arpeggiate(false);
+        return;
     }
-    else // Poly mode
-    {
-        if (arpTimerActive)
-        {
-            stopArpTimer();
-        }
 
-        // Ensure all voices are on for poly mode
-        restoreMixerGains(0.8f);
-    }
+    // Pattern and gate changes take effect at the next step
+    chordSynth.arpPattern(arpModePattern(currentArpMode));
+    chordSynth.arpGate(arpModeGate(currentArpMode));
+    chordSynth.arpeggiate(true);
 }
 
 void applyOutputMode()
@@ -983,15 +840,11 @@ void applyOutputMode()
     {
         // Left channel: guitar only (no synth)
         mixerLeft.gain(0, inputGain); // guitar input
-        mixerLeft.gain(1, 0.0f);      // synth root - off
-        mixerLeft.gain(2, 0.0f);      // synth 3rd - off
-        mixerLeft.gain(3, 0.0f);      // synth 5th - off
+        mixerLeft.gain(1, 0.0f);      // chord engine - off
 
         // Right channel: synth only (no guitar)
         mixerRight.gain(0, 0.0f);      // guitar input - off
-        mixerRight.gain(1, synthGain); // synth root
-        mixerRight.gain(2, synthGain); // synth 3rd
-        mixerRight.gain(3, synthGain); // synth 5th
+        mixerRight.gain(1, synthGain); // chord engine
 
         Serial.println("Output mode: SPLIT (L=guitar, R=synth)");
     }
@@ -999,14 +852,10 @@ void applyOutputMode()
     {
         // Both channels: guitar + synth mixed together
         mixerLeft.gain(0, inputGain); // guitar input
-        mixerLeft.gain(1, synthGain); // synth root
-        mixerLeft.gain(2, synthGain); // synth 3rd
-        mixerLeft.gain(3, synthGain); // synth 5th
+        mixerLeft.gain(1, synthGain); // chord engine
 
         mixerRight.gain(0, inputGain); // guitar input
-        mixerRight.gain(1, synthGain); // synth root
-        mixerRight.gain(2, synthGain); // synth 3rd
-        mixerRight.gain(3, synthGain); // synth 5th
+        mixerRight.gain(1, synthGain); // chord engine
 
         Serial.println("Output mode: MIX (L+R=guitar+synth)");
     }
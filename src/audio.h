@@ -3,29 +3,36 @@
 
 #include <Arduino.h>
 #include <Audio.h>
+#include "gain.h"
+#include "synth.h"
+#include "reverb.h"
 
-// Audio objects - Simplified: 2 oscillators per voice (primary + detuned)
-extern AudioSynthWaveform myEffect;   // root voice primary
-extern AudioSynthWaveform myEffect1b; // root voice detuned
-extern AudioSynthWaveform myEffect2;  // third voice primary
-extern AudioSynthWaveform myEffect2b; // third voice detuned
-extern AudioSynthWaveform myEffect3;  // fifth voice primary
-extern AudioSynthWaveform myEffect3b; // fifth voice detuned
+// Audio objects - one chord engine, 2 oscillators per voice (primary + detuned)
+extern AudioSynthChord chordSynth;
+extern SynthOscillator &myEffect;   // root voice primary
+extern SynthOscillator &myEffect1b; // root voice detuned
+extern SynthOscillator &myEffect2;  // third voice primary
+extern SynthOscillator &myEffect2b; // third voice detuned
+extern SynthOscillator &myEffect3;  // fifth voice primary
+extern SynthOscillator &myEffect3b; // fifth voice detuned
+extern AudioEffectSmoothGain synthVolume;
 
 extern AudioInputI2S audioInput;
 extern AudioOutputI2S audioOutput;
 extern AudioMixer4 mixerLeft;
 extern AudioMixer4 mixerRight;
 extern AudioAnalyzePeak peak1;
-extern AudioEffectFreeverb reverb;
+extern AudioEffectReverbSend reverbSend;
+extern AudioEffectFreeverbGated reverb;
+extern AudioEffectReverbFDN fdnReverb;
 extern AudioMixer4 wetDryLeft;
 extern AudioMixer4 wetDryRight;
-extern AudioMixer4 synthMix; // combines synth oscillators for reverb
 extern AudioControlSGTL5000 audioShield;
 
 // Audio state
 extern bool audioShieldEnabled;
 extern float reverbWet;
+extern int reverbEngine; // REVERB_ENGINE_* (config.h)
 extern bool chordActive;
 extern bool chordSuppressed;
 extern bool waitingForFirstPitch;
@@ -43,17 +50,18 @@ extern float organVibratoDepth; // fractional depth (e.g., 0.015 = ±1.5%)
 extern bool rhodesDecaying;
 extern unsigned long rhodesDecayStartMs;
 extern unsigned long rhodesDecayDurationMs;
-extern float rhodesDecayStartAmp;
 // Arpeggiator control
-extern volatile int currentArpMode;              // 0=Arp, 1=Poly
-extern volatile int arpCurrentStep;              // 0=root, 1=third, 2=fifth
-extern volatile unsigned long arpStepDurationMs; // 125ms for eighth notes at 120 BPM (updated by tempo)
-extern volatile bool arpTimerActive;             // True when arp timer is running
-extern float globalTempoBPM;                     // Global tempo for arpeggiator
+extern volatile int currentArpMode; // see ARP_MODE_* in config.h
+extern float globalTempoBPM;        // Global tempo for arpeggiator
+// Glide times offered in the menu (index = currentGlide, 0 = off)
+#define GLIDE_TIME_COUNT 6
+extern const float glideTimesMs[GLIDE_TIME_COUNT];
 
 // Audio functions
 void setupAudio();
 void setReverbWet(float wet);
+// Switch reverb engine; the previous one rings out, then stops
+void setReverbEngine(int engine);
 // mode: 0=Major, 1=Minor, 2=Fixed Major, 3=Fixed Minor
 float getDiatonicThird(float noteFreq, int keyNote, int mode);
 void stopAllOscillators();
@@ -63,16 +71,24 @@ void initRhodesSound(float tonic, float third, float fifth, float octaveMul, flo
 void initStringsSound(float tonic, float third, float fifth, float octaveMul, float perVoice);
 void startChord(float potNorm, float tonicFreq, int keyNote, int mode);
 void updateChordTonic(float tonicFreq, int keyNote, int mode);
+// Move the chord to a new tonic and set the bend in the same audio update,
+// without gliding (Follow mode: the sounding pitch stays where it is)
+void rebaseChordTonic(float tonicFreq, float bendCents, int keyNote, int mode);
 void stopChord();
-void updateChordVolume(float potNorm);
+// Chord volume (0.0-1.0), smoothed per sample in the audio graph
+void setSynthVolume(float volume);
+void updateChordVolume(float volume);
 void updateChordFade();
+// Silence the chord during a note transition (true) and bring it back (false)
+void muteChord(bool mute);
 void updateVibrato();
+// Apply currentGlide (NVRAM) to the chord engine
+void applyGlide();
 void startRhodesDecay();
 void updateRhodesDecay();
 void updateArpeggiator();
-void startArpTimer();
-void stopArpTimer();
-void updateArpTimerInterval();
+// Apply globalTempoBPM (and the arp gate/swing settings); takes effect at the next step
+void updateArpTempo();
 void applyOutputMode();
 
 #endif // AUDIO_H
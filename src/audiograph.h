@@ -0,0 +1,53 @@
+#ifndef AUDIOGRAPH_H
+#define AUDIOGRAPH_H
+
+#include "graphaudit.h"
+
+// The synth's audio graph as tables (see graphaudit.h). Included once, by
+// audio.cpp, after the objects and patch cords it names are declared;
+// test_graph includes it with stand-ins for them so the real tables are
+// audited on the host.
+
+// Every audio object: name, object, inputs, outputs
+static const GraphNode audioNodes[] = {
+    {"audioInput", &audioInput, 0, 2},
+    {"noteDetect", &noteDetect, 1, 0},
+    {"onsetDetect", &onsetDetect, 1, 0},
+    {"peak1", &peak1, 1, 0},
+    {"chordSynth", &chordSynth, 0, 1},
+    {"synthVolume", &synthVolume, 1, 1},
+    {"mixerLeft", &mixerLeft, 4, 1},
+    {"mixerRight", &mixerRight, 4, 1},
+    {"reverbSend", &reverbSend, 1, 1},
+    {"reverb", &reverb, 1, 2},
+    {"fdnReverb", &fdnReverb, 1, 2},
+    {"wetDryLeft", &wetDryLeft, 4, 1},
+    {"wetDryRight", &wetDryRight, 4, 1},
+    {"audioOutput", &audioOutput, 2, 0},
+    {"latencyProbe", &latencyProbe, 1, 0},
+};
+
+static const GraphEdge audioEdges[] = {
+    {&patchInL, &audioInput, 0, &mixerLeft, 0},
+    {&patchInR, &audioInput, 1, &mixerRight, 0},
+    {&patchPitch, &audioInput, 0, &noteDetect, 0},
+    {&patchOnset, &audioInput, 0, &onsetDetect, 0},
+    {&patchPeak, &audioInput, 0, &peak1, 0},
+    {&patchSynthGain, &chordSynth, 0, &synthVolume, 0},
+    {&patchSynthToL, &synthVolume, 0, &mixerLeft, 1},
+    {&patchSynthToR, &synthVolume, 0, &mixerRight, 1},
+    {&patchReverbSend, &synthVolume, 0, &reverbSend, 0},
+    {&patchReverbIn, &reverbSend, 0, &reverb, 0},
+    {&patchFdnIn, &synthVolume, 0, &fdnReverb, 0},
+    {&patchDryL, &mixerLeft, 0, &wetDryLeft, 0},
+    {&patchWetL, &reverb, 0, &wetDryLeft, 1},
+    {&patchFdnL, &fdnReverb, 0, &wetDryLeft, 2},
+    {&patchDryR, &mixerRight, 0, &wetDryRight, 0},
+    {&patchWetR, &reverb, 1, &wetDryRight, 1},
+    {&patchFdnR, &fdnReverb, 1, &wetDryRight, 2},
+    {&patchOutL, &wetDryLeft, 0, &audioOutput, 0},
+    {&patchOutR, &wetDryRight, 0, &audioOutput, 1},
+    {&patchLatency, &synthVolume, 0, &latencyProbe, 0},
+};
+
+#endif // AUDIOGRAPH_H
@@ -0,0 +1,103 @@
+#include "chordpitch.h"
+#include "config.h"
+#include "NVRAM.h"
+#include "tracker.h"
+
+// Current root (MIDI note, -1 = none) and bend
+static int rootNote = -1;
+static float bendCents = 0.0f;
+
+// Follow: another semitone the pitch is settling on, and since when
+static int settleNote = -1;
+static unsigned long settleStartMs = 0;
+
+void resetChordPitch()
+{
+    rootNote = -1;
+    bendCents = 0.0f;
+    settleNote = -1;
+}
+
+static bool inScale(int note, int key, int mode)
+{
+    return scaleContains(mode, ((note - key) % 12 + 12) % 12);
+}
+
+// Nearest note of the scale. Diatonic scales never leave out two adjacent
+// semitones, so a note outside the scale has scale notes on both sides.
+static int nearestScaleNote(float cents, int key, int mode)
+{
+    int n = (int)lroundf(cents / 100.0f);
+    if (inScale(n, key, mode))
+        return n;
+    return (cents - (n - 1) * 100.0f <= (n + 1) * 100.0f - cents) ? n - 1 : n + 1;
+}
+
+static bool quantize(float cents, int key, int mode, bool newNote)
+{
+    int prev = rootNote;
+    int cand = nearestScaleNote(cents, key, mode);
+    if (newNote || rootNote < 0 || !inScale(rootNote, key, mode))
+    {
+        rootNote = cand;
+    }
+    else if (cand != rootNote)
+    {
+        // distance from the midpoint between the two notes, towards cand
+        float past = (fabsf(cents - rootNote * 100.0f) - fabsf(cents - cand * 100.0f)) * 0.5f;
+        if (past >= QUANTIZE_HYST_CENTS)
+            rootNote = cand;
+    }
+    bendCents = 0.0f;
+    return rootNote != prev;
+}
+
+static bool follow(float cents, float fineCents, bool newNote, unsigned long nowMs)
+{
+    int prev = rootNote;
+    int nearest = (int)lroundf(cents / 100.0f);
+    if (newNote || rootNote < 0)
+    {
+        rootNote = nearest;
+        settleNote = -1;
+    }
+    else if (nearest != rootNote && fabsf(cents - nearest * 100.0f) <= FOLLOW_SETTLE_CENTS)
+    {
+        if (settleNote != nearest)
+        {
+            settleNote = nearest;
+            settleStartMs = nowMs;
+        }
+        else if (nowMs - settleStartMs >= FOLLOW_SETTLE_MS)
+        {
+            rootNote = nearest;
+            settleNote = -1;
+        }
+    }
+    else
+    {
+        settleNote = -1;
+    }
+    bendCents = constrain(fineCents - rootNote * 100.0f, -FOLLOW_MAX_BEND_CENTS, FOLLOW_MAX_BEND_CENTS);
+    return rootNote != prev;
+}
+
+bool updateChordPitch(float trackedHz, float fineHz, int key, int mode, bool newNote, unsigned long nowMs)
+{
+    if (trackedHz <= 0.0f)
+        return false;
+    float cents = hzToCents(trackedHz);
+    if (currentPitchMode == PITCH_MODE_FOLLOW)
+        return follow(cents, (fineHz > 0.0f) ? hzToCents(fineHz) : cents, newNote, nowMs);
+    return quantize(cents, key, mode, newNote);
+}
+
+float chordPitchRoot()
+{
+    return (rootNote < 0) ? 0.0f : centsToHz(rootNote * 100.0f);
+}
+
+float chordPitchBend()
+{
+    return bendCents;
+}
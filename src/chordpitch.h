@@ -0,0 +1,30 @@
+#ifndef CHORDPITCH_H
+#define CHORDPITCH_H
+
+#include <Arduino.h>
+
+// Chord root from the tracked pitch (PITCH_MODE_* in config.h).
+//
+// Quantized: the root is the nearest note of the key's scale. It only
+// moves once the pitch is QUANTIZE_HYST_CENTS past the midpoint to another
+// scale note, so a note played slightly sharp or flat does not flip the
+// chord. No bend is applied; the chord is always in tune.
+//
+// Follow: the chord (root, third and fifth) is built on the last stable
+// semitone and the player's deviation from it, taken from the fine pitch
+// estimate, is applied as a bend. Bends and vibrato are followed
+// continuously without changing the chord quality. A new attack, or a
+// pitch held near another semitone for FOLLOW_SETTLE_MS, makes that note
+// the stable one.
+
+// Forget the current root (e.g. after a mode change)
+void resetChordPitch();
+// Feed the tracked pitch and the fine pitch (Hz, 0 = none). newNote is
+// true on the first pitch of an attack. Returns true when the root changed.
+bool updateChordPitch(float trackedHz, float fineHz, int key, int mode, bool newNote, unsigned long nowMs);
+// Equal-tempered chord root (Hz), 0 before the first pitch
+float chordPitchRoot();
+// Bend to apply on top of the chord, in cents (always 0 when Quantized)
+float chordPitchBend();
+
+#endif // CHORDPITCH_H
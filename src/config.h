@@ -15,9 +15,118 @@
 #define FS1_MIN_ACTIVATION_MS 500 // Window of time after FS1 press that tracking is on
 #define SCREEN_TIMEOUT_MS 5000    // 5 seconds menu timeout
 #define FS_VOLUME_TIMEOUT_MS 1000 // 1 seconds FS volume control timeout
+#define SWITCH_DEBOUNCE_MS 5      // switch changes closer together than this are bounce
+#define FS_COMBO_WINDOW_MS 50     // FS1 and FS2 pressed within this count as a simultaneous press
+
+// Tap tempo (see tempo.h)
+#define TAP_TEMPO_AVERAGE 4                // intervals averaged
+#define TAP_TEMPO_OUTLIER 0.25f            // intervals further than this fraction from the mean are outliers
+#define TAP_TEMPO_MIN_INTERVAL_US 50000    // closer taps are ignored
+#define TAP_TEMPO_MAX_INTERVAL_US 2000000  // longer gaps start a new tap sequence
+
+// Pot acquisition (see pot.h) and volume smoothing
+#define POT_SAMPLE_RATE_HZ 1000 // background ADC sampling rate
+#define POT_FILTER_MS 20.0f     // low-pass time constant after the median
+#define POT_HYSTERESIS 1.5f     // ADC counts the filtered value must move before the reading changes
+#define POT_NOISE_WINDOW 1000   // samples per noise measurement (test mode)
+#define VOLUME_SMOOTH_MS 10.0f  // per-sample volume smoothing in the audio graph
+#define AUDIO_MEMORY_DEFAULT 64  // audio blocks when no peak has been measured yet
+#define AUDIO_MEMORY_HEADROOM 8  // blocks added to the measured peak
+#define AUDIO_MEMORY_MIN 16
+#define AUDIO_MEMORY_MAX 200
+#define DIAG_REFRESH_MS 500      // diagnostics screen refresh
+#define CHORD_MUTE_RELEASE_MS 5.0f // envelope release when a note transition mutes the chord
+#define STRINGS_BANDLIMITED 1      // Strings use PolyBLEP sawtooths (0 = naive, aliasing sawtooth)
+#define GLIDE_CONSTANT_RATE 0      // 0 = every tonic change takes the glide time, 1 = glide time per semitone
+#define GLIDE_LEGATO_ONLY 1        // glide only while the chord keeps sounding; snap on a fresh start
+
+// Reverb engines (see reverb.h)
+#define REVERB_ENGINE_FREEVERB 0 // Freeverb: 8 combs + 4 allpasses per channel
+#define REVERB_ENGINE_FDN 1      // 4-line feedback delay network, much cheaper
+#define REVERB_ENGINE REVERB_ENGINE_FREEVERB
+#define REVERB_ROOMSIZE 0.6f
+#define REVERB_DAMPING 0.5f
+#define REVERB_FDN_T60_MIN 0.3f // FDN decay time (s) at room size 0.0
+#define REVERB_FDN_T60_MAX 2.5f // ... and at room size 1.0
+#define REVERB_TAIL_DB 72.0f    // a tail this far below full scale counts as decayed (processing stops)
+
+// Arpeggiator modes (currentArpMode, stored in NVRAM; 0 and 1 keep their
+// original meaning)
+#define ARP_MODE_UP 0
+#define ARP_MODE_POLY 1
+#define ARP_MODE_DOWN 2
+#define ARP_MODE_UP_DOWN 3
+#define ARP_MODE_RANDOM 4
+#define ARP_MODE_STAB 5
+#define ARP_MODE_COUNT 6
+#define ARP_STEPS_PER_BEAT 4 // step subdivision of globalTempoBPM (4 = sixteenths)
+#define ARP_GATE 1.0f        // part of each step a voice sounds (1.0 = legato)
+#define ARP_STAB_GATE 0.5f   // same for Stab, which needs gaps between its chords
+#define ARP_SWING 0.0f       // 0 = straight, 0.33 = triplet shuffle
+
+// Chord pitch modes (currentPitchMode, stored in NVRAM; see chordpitch.h)
+#define PITCH_MODE_QUANTIZED 0 // chord root snapped to the key's scale
+#define PITCH_MODE_FOLLOW 1    // chord built on the last stable note, bent along with the playing
+#define PITCH_MODE_COUNT 2
+#define QUANTIZE_HYST_CENTS 15.0f   // pitch must be this far past the midpoint to another scale note to move the root
+#define FOLLOW_SETTLE_CENTS 25.0f   // Follow: pitch held this close to another semitone...
+#define FOLLOW_SETTLE_MS 300        // ...for this long becomes the new stable note
+#define FOLLOW_MAX_BEND_CENTS 400.0f
+#define PITCH_FINE_MAX_CENTS 300.0f // fine estimates further than this from the track are ignored
+
+// Main loop task rates (cooperative scheduler, see scheduler.h)
+#define INPUT_SCAN_PERIOD_US 1000      // footswitch/encoder scan (1 kHz)
+#define CONTROL_PERIOD_US 5000         // volume, fades, vibrato, decay, arp state (200 Hz)
+#define DISPLAY_PERIOD_US 50000        // OLED redraw cap (20 fps)
+#define PITCH_DEADLINE_US 3000         // pitch results should be picked up within one audio block
+#define SCHED_STATS_PERIOD_US 10000000 // print task statistics every 10 s
+#define PITCH_DISPLAY_HOLD_MS 250      // home screen keeps the last reading this long
+
+// Main loop stage profiler (see profiler.h). Off by default; can also be
+// enabled from build_flags with -DPROFILER_ENABLED=1
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 0
+#endif
 
 // Pitch detection sensitivity (0.0 = most sensitive, 1.0 = least sensitive)
 // Increase this value to require more input volume/clarity before detection engages.
 #define NOTE_DETECT_THRESHOLD 0.14f
 
+// Pitch analysis window per instrument, in samples (rounded to whole audio blocks).
+// Longer windows are steadier on low notes but respond more slowly.
+#define PITCH_WINDOW_GUITAR 1024
+#define PITCH_WINDOW_BASS 2048
+// Pitch detection range (Hz)
+#define PITCH_MIN_FREQ_GUITAR 50.0f
+#define PITCH_MIN_FREQ_BASS 30.0f
+#define PITCH_MAX_FREQ 2000.0f
+#define PITCH_MAX_FREQ_BASS 1000.0f
+// Bass input is low-pass filtered and decimated by this factor (1, 2, 4 or 8)
+// before lag analysis
+#define PITCH_BASS_DECIMATION 4
+
+// Pitch tracker smoothing strategy (see tracker.h)
+#define PITCH_TRACKER_MEDIAN 0  // median of the last PITCH_MEDIAN_LENGTH estimates
+#define PITCH_TRACKER_ONEPOLE 1 // one-pole low-pass in log frequency
+#define PITCH_TRACKER_KALMAN 2  // Kalman filter in cents
+#define PITCH_TRACKER PITCH_TRACKER_KALMAN
+#define PITCH_MEDIAN_LENGTH 5
+
+// Onset (attack) detection: fast/slow envelope ratio, noise floor (0.0-1.0)
+// and minimum time between attacks
+#define ONSET_RATIO 2.0f
+#define ONSET_FLOOR 0.01f
+#define ONSET_REFRACTORY_MS 80
+// After an attack the tracker locks on one estimate with at least this
+// probability, or on PITCH_LOCK_COUNT estimates within PITCH_LOCK_CENTS
+#define PITCH_LOCK_PROBABILITY 0.9f
+#define PITCH_LOCK_COUNT 2
+#define PITCH_LOCK_CENTS 30.0f
+
+// Automatic key detection (MusicKey = Auto)
+#define KEY_DECAY_MS 8000.0f     // pitch-class histogram time constant
+#define KEY_MIN_WEIGHT 4.0f      // evidence needed before any estimate is used
+#define KEY_MIN_CONFIDENCE 0.5f  // minimum profile correlation
+#define KEY_SWITCH_MARGIN 0.1f   // estimate must beat the current key by this much
+
 #endif // CONFIG_H
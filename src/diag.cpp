@@ -0,0 +1,134 @@
+#include "diag.h"
+#include <Audio.h>
+#include "config.h"
+#include "NVRAM.h"
+#include "audio.h"
+
+static AudioDiagnostics snapshot;
+static int poolBlocks = 0;
+static int savedPeak = 0; // block peak stored in NVRAM
+
+// loop pass timing since the last refresh
+static uint32_t lastLoopUs = 0;
+static uint32_t loopSumUs = 0;
+static uint32_t loopCount = 0;
+static uint32_t loopMaxUs = 0;
+
+// audio updates expected vs seen since the last refresh
+static uint32_t lastRefreshMs = 0;
+static uint32_t lastCheckUs = 0;
+static uint32_t lastBlockCount = 0;
+static uint32_t blockDebtUs = 0;
+
+int setupAudioMemory()
+{
+    int peak = loadAudioMemoryPeak();
+    savedPeak = peak;
+    int blocks = (peak > 0) ? peak + AUDIO_MEMORY_HEADROOM : AUDIO_MEMORY_DEFAULT;
+    bool capped = blocks > AUDIO_MEMORY_MAX;
+    if (blocks < AUDIO_MEMORY_MIN)
+        blocks = AUDIO_MEMORY_MIN;
+    if (capped)
+        blocks = AUDIO_MEMORY_MAX;
+
+    // Allocated once and never freed; the audio library keeps using it
+    audio_block_t *pool = (audio_block_t *)malloc(blocks * sizeof(audio_block_t));
+    while (!pool && blocks > AUDIO_MEMORY_MIN)
+    {
+        blocks /= 2;
+        pool = (audio_block_t *)malloc(blocks * sizeof(audio_block_t));
+    }
+    if (!pool)
+    {
+        Serial.println("Audio memory allocation FAILED");
+        return 0;
+    }
+    AudioStream::initialize_memory(pool, blocks);
+    poolBlocks = blocks;
+    snapshot.blocksPool = blocks;
+
+    Serial.print("Audio memory: ");
+    Serial.print(blocks);
+    Serial.print(" blocks (measured peak ");
+    Serial.print(peak);
+    Serial.print(peak > 0 ? ")" : " unknown, using default)");
+    Serial.println(capped ? ", capped at AUDIO_MEMORY_MAX" : "");
+    return blocks;
+}
+
+void diagLoopTick()
+{
+    uint32_t now = micros();
+    if (lastLoopUs != 0)
+    {
+        uint32_t dt = now - lastLoopUs;
+        loopSumUs += dt;
+        loopCount++;
+        if (dt > loopMaxUs)
+            loopMaxUs = dt;
+    }
+    lastLoopUs = now;
+}
+
+void diagUpdate()
+{
+    uint32_t nowMs = millis();
+    if (nowMs - lastRefreshMs < DIAG_REFRESH_MS)
+        return;
+    lastRefreshMs = nowMs;
+
+    snapshot.cpu = AudioProcessorUsage();
+    float cpuMax = AudioProcessorUsageMax();
+    if (cpuMax > snapshot.cpuMax)
+        snapshot.cpuMax = cpuMax;
+    snapshot.blocks = AudioMemoryUsage();
+    snapshot.blocksMax = AudioMemoryUsageMax();
+    snapshot.blocksPool = poolBlocks;
+    // A peak at the pool size means allocations may have failed
+    if (poolBlocks > 0 && snapshot.blocksMax >= poolBlocks)
+        snapshot.saturated = true;
+
+    // Underruns: audio updates that should have run in this interval but
+    // did not (the update is driven by the codec, one per block period)
+    uint32_t nowUs = micros();
+    uint32_t blocks = chordSynth.blockCount();
+    if (lastCheckUs != 0)
+    {
+        const float blockUs = AUDIO_BLOCK_SAMPLES * 1000000.0f / AUDIO_SAMPLE_RATE_EXACT;
+        blockDebtUs += nowUs - lastCheckUs;
+        uint32_t expected = (uint32_t)(blockDebtUs / blockUs);
+        blockDebtUs -= (uint32_t)(expected * blockUs);
+        uint32_t seen = blocks - lastBlockCount;
+        // one block of slack for where the interval falls in the period
+        if (expected > seen + 1)
+            snapshot.underruns += expected - seen - 1;
+    }
+    lastCheckUs = nowUs;
+    lastBlockCount = blocks;
+
+    snapshot.loopAvgUs = loopCount ? loopSumUs / loopCount : 0;
+    snapshot.loopMaxUs = loopMaxUs;
+    loopSumUs = 0;
+    loopCount = 0;
+    loopMaxUs = 0;
+
+    // Remember a new peak for the next boot's pool size. When the pool ran
+    // full the real peak is unknown, so ask for double the pool instead.
+    int peak = snapshot.blocksMax;
+    if (snapshot.saturated)
+    {
+        peak = poolBlocks * 2;
+        if (peak > AUDIO_MEMORY_MAX)
+            peak = AUDIO_MEMORY_MAX;
+    }
+    if (peak > savedPeak)
+    {
+        savedPeak = peak;
+        saveAudioMemoryPeak(savedPeak);
+    }
+}
+
+const AudioDiagnostics &diagSnapshot()
+{
+    return snapshot;
+}
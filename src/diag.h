@@ -0,0 +1,40 @@
+#ifndef DIAG_H
+#define DIAG_H
+
+#include <Arduino.h>
+
+// Live audio resource monitor for the diagnostics screen.
+// A snapshot is refreshed every DIAG_REFRESH_MS: audio CPU (now and peak),
+// audio blocks in use / peak / pool size and whether the pool ran full,
+// underruns (audio updates that
+// did not run on time, counted from the chord engine's block counter)
+// and the main loop pass time.
+
+struct AudioDiagnostics
+{
+    float cpu;        // percent
+    float cpuMax;     // percent, since boot
+    int blocks;       // audio blocks in use
+    int blocksMax;    // peak since boot
+    int blocksPool;   // blocks allocated at boot
+    bool saturated;   // the peak reached the pool: allocations may have failed
+    uint32_t underruns;
+    uint32_t loopAvgUs; // over the last refresh
+    uint32_t loopMaxUs;
+};
+
+// Boot: allocate the audio block pool, sized from the peak measured in
+// earlier sessions (NVRAM) plus AUDIO_MEMORY_HEADROOM. Returns its size.
+int setupAudioMemory();
+
+// Call once per main loop pass
+void diagLoopTick();
+
+// Refresh the snapshot when due; a new block peak is saved to NVRAM so
+// the next boot sizes the pool from it. A saturated pool hides the real
+// peak, so then double the pool (up to AUDIO_MEMORY_MAX) is saved instead.
+void diagUpdate();
+
+const AudioDiagnostics &diagSnapshot();
+
+#endif // DIAG_H
@@ -3,6 +3,8 @@
 #include "menu.h"
 #include "audio.h"
 #include "NVRAM.h"
+#include "harmony.h"
+#include "diag.h"
 #include <Wire.h>
 #include <math.h>
 
@@ -62,9 +64,14 @@ void renderHomeScreen(const char *noteName, float frequency)
         // Print key and a short mode code that fits within 10 characters total
         // (including the space after the key). For example: "E Mj", "Bb Mn".
         display.print(keyNames[currentKey]);
+        // Mark an automatically detected key with '*'
+        if (currentKeyAuto)
+            display.print("*");
         // Short mode codes for diatonic modes
         const char *modeShort[] = {"Maj", "Min"};
         String keyStr = String(keyNames[currentKey]);
+        if (currentKeyAuto)
+            keyStr = keyStr + "*";
         int keyLen = keyStr.length();
         int maxTotal = 10;                         // maximum chars including space after key
         int maxModeLen = maxTotal - (keyLen + 1); // leave room for space
@@ -95,7 +102,7 @@ void renderHomeScreen(const char *noteName, float frequency)
     if (frequency > 0.0f)
     {
         // Calculate deviation from nearest semitone in cents
-        float n = 12.0 * log2f(frequency / 440.0) + 69.0;
+        float n = freqToMidi(frequency);
         int nearestNote = (int)(n + 0.5);
         float cents = (n - nearestNote) * 100.0f; // deviation in cents
         // Draw bar graph
@@ -664,6 +671,105 @@ void renderMenuScreen()
                 display.println("^");
         }
     }
+    else if (currentMenuLevel == MENU_GLIDE_SELECT)
+    {
+        // Glide selection submenu - show "Glide" as title
+        display.setCursor(0, 0);
+        display.println("Glide");
+
+        int totalCount = GLIDE_MENU_COUNT + 1; // includes Parent
+        int visible = 3;
+
+        // Stable viewport scrolling
+        if (menuGlideIndex < glideViewportStart)
+        {
+            glideViewportStart = menuGlideIndex;
+        }
+        else if (menuGlideIndex >= glideViewportStart + visible)
+        {
+            glideViewportStart = menuGlideIndex - visible + 1;
+        }
+
+        if (glideViewportStart < 0)
+            glideViewportStart = 0;
+        if (glideViewportStart > totalCount - visible)
+            glideViewportStart = totalCount - visible;
+        if (glideViewportStart < 0)
+            glideViewportStart = 0;
+
+        for (int i = 0; i < visible; i++)
+        {
+            int idx = glideViewportStart + i;
+            if (idx >= totalCount)
+                break;
+
+            int y = 18 + i * 18;
+            display.setCursor(0, y);
+            if (idx == menuGlideIndex)
+            {
+                display.print("> ");
+            }
+            else
+            {
+                display.print("  ");
+            }
+
+            if (idx < GLIDE_MENU_COUNT)
+                display.println(glideMenuNames[idx]);
+            else
+                display.println("^");
+        }
+    }
+
+    else if (currentMenuLevel == MENU_PITCHMODE_SELECT)
+    {
+        // Pitch mode selection submenu - show "Pitch" as title
+        display.setCursor(0, 0);
+        display.println("Pitch");
+
+        int totalCount = PITCHMODE_MENU_COUNT + 1; // includes Parent
+        int visible = 3;
+
+        // Stable viewport scrolling
+        if (menuPitchModeIndex < pitchModeViewportStart)
+        {
+            pitchModeViewportStart = menuPitchModeIndex;
+        }
+        else if (menuPitchModeIndex >= pitchModeViewportStart + visible)
+        {
+            pitchModeViewportStart = menuPitchModeIndex - visible + 1;
+        }
+
+        if (pitchModeViewportStart < 0)
+            pitchModeViewportStart = 0;
+        if (pitchModeViewportStart > totalCount - visible)
+            pitchModeViewportStart = totalCount - visible;
+        if (pitchModeViewportStart < 0)
+            pitchModeViewportStart = 0;
+
+        for (int i = 0; i < visible; i++)
+        {
+            int idx = pitchModeViewportStart + i;
+            if (idx >= totalCount)
+                break;
+
+            int y = 18 + i * 18;
+            display.setCursor(0, y);
+            if (idx == menuPitchModeIndex)
+            {
+                display.print("> ");
+            }
+            else
+            {
+                display.print("  ");
+            }
+
+            if (idx < PITCHMODE_MENU_COUNT)
+                display.println(pitchModeMenuNames[idx]);
+            else
+                display.println("^");
+        }
+    }
 
     display.display();
 }
@@ -794,3 +900,52 @@ void renderTapTempoScreen(float bpm)
     
     display.display();
 }
+
+void renderDiagnosticsScreen()
+{
+    const AudioDiagnostics &d = diagSnapshot();
+
+    display.clearDisplay();
+    display.setTextSize(1);
+    display.setTextColor(SSD1306_WHITE);
+    display.setCursor(0, 0);
+    display.println("DIAGNOSTICS");
+
+    display.setCursor(0, 12);
+    display.print("CPU ");
+    display.print(d.cpu, 1);
+    display.print("% pk ");
+    display.print(d.cpuMax, 1);
+    display.print("%");
+
+    display.setCursor(0, 22);
+    display.print("Blocks ");
+    display.print(d.blocks);
+    display.print("/");
+    display.print(d.blocksMax);
+    if (d.saturated)
+    {
+        // the peak is the whole pool; the next boot allocates more
+        display.print(" FULL");
+    }
+    else
+    {
+        display.print(" of ");
+        display.print(d.blocksPool);
+    }
+
+    display.setCursor(0, 32);
+    display.print("Underruns ");
+    display.print(d.underruns);
+
+    display.setCursor(0, 42);
+    display.print("Loop ");
+    display.print(d.loopAvgUs);
+    display.print("us max ");
+    display.print(d.loopMaxUs);
+
+    display.setCursor(0, 54);
+    display.print("Press to exit");
+
+    display.display();
+}
@@ -11,7 +11,8 @@ enum ScreenMode
     SCREEN_MENU,
     SCREEN_FADE,
     SCREEN_VOLUME_CONTROL,
-    SCREEN_TAP_TEMPO
+    SCREEN_TAP_TEMPO,
+    SCREEN_DIAGNOSTICS
 };
 
 extern Adafruit_SSD1306 display;
@@ -24,5 +25,6 @@ void renderMenuScreen();
 void renderFadeScreen();
 void renderVolumeControlScreen(float volumeLevel);
 void renderTapTempoScreen(float bpm);
+void renderDiagnosticsScreen();
 
 #endif // DISPLAY_H
@@ -0,0 +1,135 @@
+#include "dsp.h"
+
+static inline uint32_t load2(const int16_t *p)
+{
+    uint32_t w;
+    memcpy(&w, p, sizeof(w)); // single LDR on M7 (unaligned access allowed)
+    return w;
+}
+
+static inline void store2(int16_t *p, uint32_t w)
+{
+    memcpy(p, &w, sizeof(w));
+}
+
+static inline int16_t saturate16(int32_t v)
+{
+    if (v > 32767)
+        return 32767;
+    if (v < -32768)
+        return -32768;
+    return (int16_t)v;
+}
+
+#if DSP_USE_SIMD
+// Cortex-M7 DSP instructions
+static inline uint32_t ssub16(uint32_t a, uint32_t b)
+{
+    uint32_t r;
+    asm("ssub16 %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+    return r;
+}
+
+static inline int64_t smlald(uint32_t a, uint32_t b, int64_t acc)
+{
+    uint32_t lo = (uint32_t)acc;
+    uint32_t hi = (uint32_t)((uint64_t)acc >> 32);
+    asm("smlald %0, %1, %2, %3" : "+r"(lo), "+r"(hi) : "r"(a), "r"(b));
+    return (int64_t)(((uint64_t)hi << 32) | lo);
+}
+
+static inline int32_t smlad(uint32_t a, uint32_t b, int32_t acc)
+{
+    int32_t r;
+    asm("smlad %0, %1, %2, %3" : "=r"(r) : "r"(a), "r"(b), "r"(acc));
+    return r;
+}
+
+// (a * bottom half of b) >> 16 and (a * top half of b) >> 16
+static inline int32_t smulwb(int32_t a, uint32_t b)
+{
+    int32_t r;
+    asm("smulwb %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+    return r;
+}
+
+static inline int32_t smulwt(int32_t a, uint32_t b)
+{
+    int32_t r;
+    asm("smulwt %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+    return r;
+}
+
+// Saturate both values to 16 bits and pack lo | hi << 16
+static inline uint32_t packSat(int32_t lo, int32_t hi)
+{
+    int32_t l, h;
+    uint32_t r;
+    asm("ssat %0, #16, %1" : "=r"(l) : "r"(lo));
+    asm("ssat %0, #16, %1" : "=r"(h) : "r"(hi));
+    asm("pkhbt %0, %1, %2, lsl #16" : "=r"(r) : "r"(l), "r"(h));
+    return r;
+}
+#endif
+
+int64_t dspSumSquaredDiff(const int16_t *a, const int16_t *b, int n)
+{
+    int64_t acc = 0;
+    int i = 0;
+#if DSP_USE_SIMD
+    for (; i + 4 <= n; i += 4)
+    {
+        uint32_t d0 = ssub16(load2(a + i), load2(b + i));
+        uint32_t d1 = ssub16(load2(a + i + 2), load2(b + i + 2));
+        acc = smlald(d0, d0, acc);
+        acc = smlald(d1, d1, acc);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        int32_t e = (int32_t)a[i] - (int32_t)b[i];
+        acc += e * e;
+    }
+    return acc;
+}
+
+int32_t dspDotProduct(const int16_t *a, const int16_t *b, int n)
+{
+    int32_t acc = 0;
+    int i = 0;
+#if DSP_USE_SIMD
+    for (; i + 4 <= n; i += 4)
+    {
+        acc = smlad(load2(a + i), load2(b + i), acc);
+        acc = smlad(load2(a + i + 2), load2(b + i + 2), acc);
+    }
+#endif
+    for (; i < n; i++)
+        acc += (int32_t)a[i] * b[i];
+    return acc;
+}
+
+void dspGainRamp(int16_t *data, int n, int32_t gainStart, int32_t gainEnd)
+{
+    if (n <= 0)
+        return;
+    int32_t g = gainStart;
+    int32_t step = (gainEnd - gainStart) / n;
+    int i = 0;
+#if DSP_USE_SIMD
+    for (; i + 2 <= n; i += 2)
+    {
+        uint32_t x = load2(data + i);
+        int32_t lo = smulwb(g, x);
+        g += step;
+        int32_t hi = smulwt(g, x);
+        g += step;
+        store2(data + i, packSat(lo, hi));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        data[i] = saturate16((int32_t)(((int64_t)g * data[i]) >> 16));
+        g += step;
+    }
+}
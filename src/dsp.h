@@ -0,0 +1,32 @@
+#ifndef DSP_H
+#define DSP_H
+
+#include <Arduino.h>
+
+// Small DSP kernel library for the audio hot loops.
+// On Cortex-M7 the kernels use the DSP extension (SIMD16 subtract,
+// dual 16x16 multiply-accumulate, saturation); everywhere else a plain C
+// implementation with identical results is used. Buffers may be unaligned.
+//
+// Gains are Q16 fixed point (65536 = unity), as used by AudioMixer4.
+
+#if defined(__ARM_ARCH_7EM__)
+#define DSP_USE_SIMD 1
+#else
+#define DSP_USE_SIMD 0
+#endif
+
+#define DSP_UNITY_GAIN 65536
+
+// sum((a[i] - b[i])^2). Each difference must fit in 16 bits (e.g. samples
+// pre-halved); the 64-bit result is exact.
+int64_t dspSumSquaredDiff(const int16_t *a, const int16_t *b, int n);
+
+// sum(a[i] * b[i]) with a 32-bit accumulator (caller bounds the range)
+int32_t dspDotProduct(const int16_t *a, const int16_t *b, int n);
+
+// data[i] *= gain, with the gain moving linearly from gainStart towards
+// gainEnd across the buffer; saturates to 16 bits
+void dspGainRamp(int16_t *data, int n, int32_t gainStart, int32_t gainEnd);
+
+#endif // DSP_H
@@ -0,0 +1,57 @@
+#include "gain.h"
+#include "dsp.h"
+#include <math.h>
+
+void AudioEffectSmoothGain::gain(float g)
+{
+    if (g < 0.0f)
+        g = 0.0f;
+    if (g > 1.0f)
+        g = 1.0f;
+    target = (int32_t)(g * DSP_UNITY_GAIN + 0.5f);
+}
+
+void AudioEffectSmoothGain::smoothing(float ms)
+{
+    float blockMs = AUDIO_BLOCK_SAMPLES * 1000.0f / AUDIO_SAMPLE_RATE_EXACT;
+    float c = (ms > 0.0f) ? 1.0f - expf(-blockMs / ms) : 1.0f;
+    __disable_irq();
+    coef = (int32_t)(c * DSP_UNITY_GAIN + 0.5f);
+    __enable_irq();
+}
+
+void AudioEffectSmoothGain::update(void)
+{
+    int32_t t = target;
+    int32_t next = current + (int32_t)(((int64_t)(t - current) * coef) >> 16);
+    if (next == current)
+        next = t; // within one step: land exactly on the target
+
+    audio_block_t *block;
+    if (current == DSP_UNITY_GAIN && next == DSP_UNITY_GAIN)
+    {
+        block = receiveReadOnly();
+        if (!block)
+            return;
+        transmit(block);
+        release(block);
+        return;
+    }
+
+    block = receiveWritable();
+    if (!block)
+    {
+        current = next;
+        return;
+    }
+    if (current == 0 && next == 0)
+    {
+        release(block);
+        return;
+    }
+
+    dspGainRamp(block->data, AUDIO_BLOCK_SAMPLES, current, next);
+    current = next;
+    transmit(block);
+    release(block);
+}
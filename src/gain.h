@@ -0,0 +1,30 @@
+#ifndef GAIN_H
+#define GAIN_H
+
+#include <Arduino.h>
+#include <Audio.h>
+
+// Gain stage with per-sample smoothing.
+// The gain approaches its target with a one-pole response (time constant
+// set by smoothing()), evaluated once per block and ramped linearly across
+// the block's samples, so control-rate volume changes cannot zipper.
+// Unity passes blocks through untouched; zero transmits nothing.
+class AudioEffectSmoothGain : public AudioStream
+{
+public:
+    AudioEffectSmoothGain() : AudioStream(1, inputQueueArray) { smoothing(10.0f); }
+
+    // 0.0 to 1.0
+    void gain(float g);
+    void smoothing(float ms);
+
+    virtual void update(void);
+
+private:
+    audio_block_t *inputQueueArray[1];
+    volatile int32_t target = 65536;
+    int32_t current = 65536;
+    int32_t coef = 65536; // Q16 fraction of the remaining distance covered per block
+};
+
+#endif // GAIN_H
@@ -0,0 +1,130 @@
+#include "graph.h"
+
+static const GraphNode *graphNodes = nullptr;
+static const GraphEdge *graphEdges = nullptr;
+static int graphNodeCount = 0;
+static int graphEdgeCount = 0;
+static int8_t edgeStatus[GRAPH_MAX_EDGES]; // connect() result, -1 = not attempted
+
+void graphSetup(const GraphNode *nodes, int nodeCount, const GraphEdge *edges, int edgeCount)
+{
+    graphNodes = nodes;
+    graphNodeCount = nodeCount;
+    graphEdges = edges;
+    graphEdgeCount = (edgeCount > GRAPH_MAX_EDGES) ? GRAPH_MAX_EDGES : edgeCount;
+    for (int i = 0; i < GRAPH_MAX_EDGES; i++)
+        edgeStatus[i] = -1;
+}
+
+static const GraphNode *findNode(const AudioStream *object)
+{
+    for (int i = 0; i < graphNodeCount; i++)
+    {
+        if (graphNodes[i].object == object)
+            return &graphNodes[i];
+    }
+    return nullptr;
+}
+
+static const char *nodeName(const AudioStream *object)
+{
+    const GraphNode *node = findNode(object);
+    return node ? node->name : "?";
+}
+
+static void printEdge(const GraphEdge &e)
+{
+    Serial.print(nodeName(e.src));
+    Serial.print(".");
+    Serial.print(e.srcOutput);
+    Serial.print(" -> ");
+    Serial.print(nodeName(e.dst));
+    Serial.print(".");
+    Serial.print(e.dstInput);
+}
+
+int graphConnect()
+{
+    int failed = 0;
+    for (int i = 0; i < graphEdgeCount; i++)
+    {
+        const GraphEdge &e = graphEdges[i];
+        edgeStatus[i] = (int8_t)e.patch->connect(*e.src, e.srcOutput, *e.dst, e.dstInput);
+        if (edgeStatus[i] != 0)
+            failed++;
+    }
+    return failed;
+}
+
+int graphAudit()
+{
+    GraphDefect defects[GRAPH_MAX_DEFECTS];
+    int count = graphFindDefects(graphNodes, graphNodeCount, graphEdges, graphEdgeCount, edgeStatus, defects,
+                                 GRAPH_MAX_DEFECTS);
+    int shown = (count < GRAPH_MAX_DEFECTS) ? count : GRAPH_MAX_DEFECTS;
+
+    for (int i = 0; i < shown; i++)
+    {
+        const GraphDefect &d = defects[i];
+        Serial.print("GRAPH: ");
+        Serial.print(graphDefectName(d.kind));
+        if (d.kind == GRAPH_UNCONNECTED_SOURCE || d.kind == GRAPH_NO_INPUT)
+        {
+            Serial.print(" ");
+            Serial.println(graphNodes[d.index].name);
+            continue;
+        }
+        if (d.kind == GRAPH_CONNECT_FAILED)
+        {
+            Serial.print(" (");
+            Serial.print(d.status);
+            Serial.print(")");
+        }
+        Serial.print(" ");
+        printEdge(graphEdges[d.index]);
+        Serial.println();
+    }
+
+    Serial.print("Audio graph: ");
+    Serial.print(graphNodeCount);
+    Serial.print(" objects, ");
+    Serial.print(graphEdgeCount);
+    Serial.print(" connections, ");
+    Serial.print(count);
+    Serial.println(" defects");
+    return count;
+}
+
+void graphPrint()
+{
+    Serial.println("Audio graph (cpu %, max %):");
+    for (int n = 0; n < graphNodeCount; n++)
+    {
+        const GraphNode &node = graphNodes[n];
+        Serial.print(" ");
+        Serial.print(node.name);
+        Serial.print(": ");
+        Serial.print(node.object->processorUsage(), 2);
+        Serial.print(", ");
+        Serial.println(node.object->processorUsageMax(), 2);
+        for (int i = 0; i < graphEdgeCount; i++)
+        {
+            if (graphEdges[i].src != node.object)
+                continue;
+            Serial.print("   ");
+            printEdge(graphEdges[i]);
+            Serial.println(edgeStatus[i] == 0 ? "" : " (not connected)");
+        }
+    }
+    Serial.print(" total: ");
+    Serial.print(AudioProcessorUsage(), 2);
+    Serial.print(", ");
+    Serial.println(AudioProcessorUsageMax(), 2);
+}
+
+void graphResetUsage()
+{
+    for (int n = 0; n < graphNodeCount; n++)
+        graphNodes[n].object->processorUsageMaxReset();
+    AudioProcessorUsageMaxReset();
+}
@@ -0,0 +1,26 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <Arduino.h>
+#include <Audio.h>
+#include "graphaudit.h"
+
+// Audio graph setup and reporting.
+// graphConnect() makes the connections in the tables at setup, after every
+// static constructor has run, so objects defined in other files can be
+// patched safely. graphAudit() runs graphFindDefects() (graphaudit.h) on
+// the tables and prints each defect over serial.
+
+#define GRAPH_MAX_EDGES 32
+#define GRAPH_MAX_DEFECTS 16 // printed by graphAudit(); any beyond are only counted
+
+void graphSetup(const GraphNode *nodes, int nodeCount, const GraphEdge *edges, int edgeCount);
+// Connect every edge; returns the number that failed
+int graphConnect();
+// Print every defect; returns the defect count (0 = graph is sound)
+int graphAudit();
+// Objects with processorUsage()/processorUsageMax() and their connections
+void graphPrint();
+void graphResetUsage();
+
+#endif // GRAPH_H
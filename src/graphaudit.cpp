@@ -0,0 +1,96 @@
+#include "graphaudit.h"
+
+static const GraphNode *findNode(const GraphNode *nodes, int nodeCount, const AudioStream *object)
+{
+    for (int i = 0; i < nodeCount; i++)
+    {
+        if (nodes[i].object == object)
+            return &nodes[i];
+    }
+    return nullptr;
+}
+
+static void addDefect(GraphDefect *defects, int maxDefects, int &count, uint8_t kind, int index, int8_t status = 0)
+{
+    if (count < maxDefects)
+    {
+        defects[count].kind = kind;
+        defects[count].index = (int16_t)index;
+        defects[count].status = status;
+    }
+    count++;
+}
+
+int graphFindDefects(const GraphNode *nodes, int nodeCount, const GraphEdge *edges, int edgeCount,
+                     const int8_t *edgeStatus, GraphDefect *defects, int maxDefects)
+{
+    int count = 0;
+
+    for (int i = 0; i < edgeCount; i++)
+    {
+        const GraphEdge &e = edges[i];
+        const GraphNode *src = findNode(nodes, nodeCount, e.src);
+        const GraphNode *dst = findNode(nodes, nodeCount, e.dst);
+
+        if (!src || !dst)
+        {
+            addDefect(defects, maxDefects, count, GRAPH_UNKNOWN_OBJECT, i);
+            continue;
+        }
+        if (e.srcOutput >= src->outputs || e.dstInput >= dst->inputs)
+            addDefect(defects, maxDefects, count, GRAPH_NO_SUCH_PORT, i);
+        else if (edgeStatus && edgeStatus[i] > 0)
+            addDefect(defects, maxDefects, count, GRAPH_CONNECT_FAILED, i, edgeStatus[i]);
+
+        for (int j = 0; j < i; j++)
+        {
+            const GraphEdge &o = edges[j];
+            if (o.dst != e.dst || o.dstInput != e.dstInput)
+                continue;
+            bool same = o.src == e.src && o.srcOutput == e.srcOutput;
+            addDefect(defects, maxDefects, count, same ? GRAPH_DUPLICATE_EDGE : GRAPH_INPUT_FED_TWICE, i);
+            break;
+        }
+    }
+
+    for (int n = 0; n < nodeCount; n++)
+    {
+        const GraphNode &node = nodes[n];
+        bool fed = false;
+        bool feeds = false;
+        for (int i = 0; i < edgeCount; i++)
+        {
+            fed = fed || edges[i].dst == node.object;
+            feeds = feeds || edges[i].src == node.object;
+        }
+        if (node.outputs > 0 && !feeds)
+            addDefect(defects, maxDefects, count, GRAPH_UNCONNECTED_SOURCE, n);
+        if (node.inputs > 0 && !fed)
+            addDefect(defects, maxDefects, count, GRAPH_NO_INPUT, n);
+    }
+
+    return count;
+}
+
+const char *graphDefectName(uint8_t kind)
+{
+    switch (kind)
+    {
+    case GRAPH_UNKNOWN_OBJECT:
+        return "dangling edge (unknown object)";
+    case GRAPH_NO_SUCH_PORT:
+        return "dangling edge (no such port)";
+    case GRAPH_CONNECT_FAILED:
+        return "connect failed";
+    case GRAPH_DUPLICATE_EDGE:
+        return "duplicate edge";
+    case GRAPH_INPUT_FED_TWICE:
+        return "input fed twice";
+    case GRAPH_UNCONNECTED_SOURCE:
+        return "unconnected source";
+    case GRAPH_NO_INPUT:
+        return "no input connected to";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef GRAPHAUDIT_H
+#define GRAPHAUDIT_H
+
+#include <Arduino.h>
+
+// Audio graph tables and their audit.
+// The graph is described once as tables of objects and connections (see
+// audiograph.h). graphFindDefects() checks the tables alone: duplicate
+// edges, inputs fed twice, dangling edges (unknown objects, bad port
+// numbers, failed connects), sources whose output goes nowhere and objects
+// with no input. It only compares pointers, so it needs neither the audio
+// library nor the objects themselves; graph.h connects and reports.
+
+class AudioStream;
+class AudioConnection;
+
+struct GraphNode
+{
+    const char *name;
+    AudioStream *object;
+    uint8_t inputs;
+    uint8_t outputs;
+};
+
+struct GraphEdge
+{
+    AudioConnection *patch;
+    AudioStream *src;
+    uint8_t srcOutput;
+    AudioStream *dst;
+    uint8_t dstInput;
+};
+
+enum GraphDefectKind
+{
+    GRAPH_UNKNOWN_OBJECT,     // edge: src or dst is not in the node table
+    GRAPH_NO_SUCH_PORT,       // edge: output or input number out of range
+    GRAPH_CONNECT_FAILED,     // edge: connect() returned an error (status)
+    GRAPH_DUPLICATE_EDGE,     // edge: same as an earlier edge
+    GRAPH_INPUT_FED_TWICE,    // edge: its input is already fed by an earlier edge
+    GRAPH_UNCONNECTED_SOURCE, // node: has outputs, none connected
+    GRAPH_NO_INPUT            // node: has inputs, none connected
+};
+
+struct GraphDefect
+{
+    uint8_t kind;  // GraphDefectKind
+    int16_t index; // edge index, or node index for the node kinds
+    int8_t status; // connect() result for GRAPH_CONNECT_FAILED
+};
+
+// Check the tables. edgeStatus holds each edge's connect() result (-1 = not
+// attempted) or is null when nothing was connected. Fills up to maxDefects
+// entries and returns the number of defects found (0 = graph is sound),
+// which may be more than were stored.
+int graphFindDefects(const GraphNode *nodes, int nodeCount, const GraphEdge *edges, int edgeCount,
+                     const int8_t *edgeStatus, GraphDefect *defects, int maxDefects);
+// Short description of a defect kind
+const char *graphDefectName(uint8_t kind);
+
+#endif // GRAPHAUDIT_H
@@ -0,0 +1,133 @@
+#ifndef HARMONY_H
+#define HARMONY_H
+
+#include <Arduino.h>
+
+// Harmony helpers shared by pitch, audio and display code: a fast
+// frequency -> MIDI note conversion and compile-time chord interval tables,
+// so chord updates need no log2f/powf calls.
+
+// log2 for positive normal floats. The mantissa is folded into
+// [sqrt(1/2), sqrt(2)) and ln() is expanded as 2*atanh series; the error is
+// below 0.01 cent over the audio range.
+static inline float fastLog2(float x)
+{
+    union
+    {
+        float f;
+        uint32_t i;
+    } u;
+    u.f = x;
+    int e = (int)((u.i >> 23) & 0xFF) - 127;
+    u.i = (u.i & 0x007FFFFF) | 0x3F800000; // mantissa in [1, 2)
+    float m = u.f;
+    if (m > 1.41421356f)
+    {
+        m *= 0.5f;
+        e++;
+    }
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    float ln = 2.0f * t * (1.0f + t2 * (0.33333333f + t2 * 0.2f));
+    return (float)e + ln * 1.44269504f;
+}
+
+// Fractional MIDI note number (A4 = 440 Hz = 69)
+static inline float freqToMidi(float hz)
+{
+    return 12.0f * fastLog2(hz) - 36.3763165623f; // 12*log2(440) - 69
+}
+
+// Pitch class of the nearest note (0=C .. 11=B)
+static inline int freqToPitchClass(float hz)
+{
+    int pc = ((int)lroundf(freqToMidi(hz))) % 12;
+    return (pc < 0) ? pc + 12 : pc;
+}
+
+// Frequency ratio for an octave shift (-1..2)
+static inline float octaveRatio(int shift)
+{
+    return ldexpf(1.0f, shift);
+}
+
+// ----------------------
+// Chord interval tables
+// ----------------------
+// Modes: 0=Major, 1=Minor, 2=Fixed Major, 3=Fixed Minor
+#define HARMONY_MODES 4
+
+// Equal-tempered ratio for 0..12 semitones
+static constexpr float semitoneRatio[13] = {
+    1.0f, 1.05946309f, 1.12246205f, 1.18920712f, 1.25992105f, 1.33483985f, 1.41421356f,
+    1.49830708f, 1.58740105f, 1.68179283f, 1.78179744f, 1.88774863f, 2.0f};
+
+// Third above a chord root 'rel' semitones above the key
+static constexpr int diatonicThirdSemitones(int mode, int rel)
+{
+    if (mode == 0) // Major: I, IV, V major
+        return (rel == 0 || rel == 5 || rel == 7) ? 4 : 3;
+    if (mode == 1) // Natural minor: III, VI, VII major
+        return (rel == 3 || rel == 8 || rel == 10) ? 4 : 3;
+    if (mode == 2) // Fixed Major
+        return 4;
+    return 3; // Fixed Minor
+}
+
+// Fifth above a chord root: flat-5 on the diminished degree
+// (vii in Major, ii in Natural minor)
+static constexpr int diatonicFifthSemitones(int mode, int rel)
+{
+    if ((mode == 0 && rel == 11) || (mode == 1 && rel == 2))
+        return 6;
+    return 7;
+}
+
+// True if a note 'rel' semitones above the key is in the mode's scale.
+// Major and natural minor use their 7-note scales; the Fixed modes build
+// the same chord on any root, so every note counts.
+static constexpr bool scaleContains(int mode, int rel)
+{
+    if (mode == 0) // Major: 0 2 4 5 7 9 11
+        return (0xAB5 >> rel) & 1;
+    if (mode == 1) // Natural minor: 0 2 3 5 7 8 10
+        return (0x5AD >> rel) & 1;
+    return true;
+}
+
+// Interval semitones indexed [key][mode][pitch class of the chord root]
+struct ChordIntervalTable
+{
+    uint8_t third[12][HARMONY_MODES][12];
+    uint8_t fifth[12][HARMONY_MODES][12];
+
+    constexpr ChordIntervalTable() : third(), fifth()
+    {
+        for (int key = 0; key < 12; key++)
+            for (int mode = 0; mode < HARMONY_MODES; mode++)
+                for (int pc = 0; pc < 12; pc++)
+                {
+                    int rel = (pc - key + 12) % 12;
+                    third[key][mode][pc] = diatonicThirdSemitones(mode, rel);
+                    fifth[key][mode][pc] = diatonicFifthSemitones(mode, rel);
+                }
+    }
+};
+
+static constexpr ChordIntervalTable chordIntervals{};
+
+static inline int chordThirdSemitones(int key, int mode, int pitchClass)
+{
+    if (mode < 0 || mode >= HARMONY_MODES)
+        return 3;
+    return chordIntervals.third[key][mode][pitchClass];
+}
+
+static inline int chordFifthSemitones(int key, int mode, int pitchClass)
+{
+    if (mode < 0 || mode >= HARMONY_MODES)
+        return 7;
+    return chordIntervals.fifth[key][mode][pitchClass];
+}
+
+#endif // HARMONY_H
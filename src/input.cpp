@@ -1,4 +1,5 @@
 #include "input.h"
+#include "config.h"
 
 // Pin Assignments
 const int ENC_A = 2;
@@ -13,6 +14,16 @@ volatile int encoderRaw = 0;      // high-resolution transitions (4 per detent)
 volatile int encoderPosition = 0; // user-facing detent count
 volatile uint8_t encoderState = 0;
 
+// Debounced switches
+DebouncedSwitch encButtonSwitch = {ENC_BTN, false, 0};
+
+// Footswitch events (interrupt-driven)
+SpscQueue<FootswitchEvent, FOOTSWITCH_EVENT_QUEUE> footswitchEvents;
+
+// Debounced level and time of the last accepted edge per footswitch
+static volatile bool footDown[2] = {false, false};
+static volatile uint32_t footChangedUs[2] = {0, 0};
+
 // state transition table: index = (prev<<2)|curr
 const int8_t encoder_table[16] = {
     0, -1, +1, 0,
@@ -43,6 +54,39 @@ void encoderISR()
     }
 }
 
+// Runs in interrupt context (or with interrupts disabled), so it is the
+// only producer for footswitchEvents
+static void footswitchEdge(int index, int pin)
+{
+    uint32_t us = micros();
+    bool down = !digitalRead(pin);
+    if (down == footDown[index])
+        return; // bounced back to the level already reported
+    if (us - footChangedUs[index] < SWITCH_DEBOUNCE_MS * 1000UL)
+        return; // still inside the lockout of the previous edge
+    footDown[index] = down;
+    footChangedUs[index] = us;
+    footswitchEvents.push(FootswitchEvent{(uint8_t)(index + 1), down, us, (uint32_t)millis()});
+}
+
+void foot1ISR()
+{
+    footswitchEdge(0, FOOT1);
+}
+
+void foot2ISR()
+{
+    footswitchEdge(1, FOOT2);
+}
+
+void pollFootswitches()
+{
+    noInterrupts();
+    footswitchEdge(0, FOOT1);
+    footswitchEdge(1, FOOT2);
+    interrupts();
+}
+
 void setupInput()
 {
     pinMode(ENC_A, INPUT_PULLUP);
@@ -58,4 +102,21 @@ void setupInput()
     encoderState = (digitalRead(ENC_A) << 1) | digitalRead(ENC_B);
     attachInterrupt(digitalPinToInterrupt(ENC_A), encoderISR, CHANGE);
     attachInterrupt(digitalPinToInterrupt(ENC_B), encoderISR, CHANGE);
+
+    // Footswitches: timestamp every edge
+    footDown[0] = !digitalRead(FOOT1);
+    footDown[1] = !digitalRead(FOOT2);
+    attachInterrupt(digitalPinToInterrupt(FOOT1), foot1ISR, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(FOOT2), foot2ISR, CHANGE);
+}
+
+bool readSwitch(DebouncedSwitch &sw, unsigned long nowMs)
+{
+    bool raw = !digitalRead(sw.pin);
+    if (raw != sw.down && (nowMs - sw.changedMs) >= SWITCH_DEBOUNCE_MS)
+    {
+        sw.down = raw;
+        sw.changedMs = nowMs;
+    }
+    return sw.down;
 }
@@ -2,6 +2,7 @@
 #define INPUT_H
 
 #include <Arduino.h>
+#include "spsc.h"
 
 // Pin Assignments
 extern const int ENC_A;
@@ -16,7 +17,40 @@ extern volatile int encoderRaw;
 extern volatile int encoderPosition;
 extern volatile uint8_t encoderState;
 
+// Switch debouncing (leading edge): a change is taken as soon as it is seen,
+// then further changes are ignored for SWITCH_DEBOUNCE_MS so contact bounce
+// cannot re-trigger
+struct DebouncedSwitch
+{
+    int pin; // active low
+    bool down;
+    unsigned long changedMs;
+};
+
+extern DebouncedSwitch encButtonSwitch;
+
+// Footswitch events, timestamped by pin-change interrupts. Debouncing is
+// done in the interrupt (leading edge, SWITCH_DEBOUNCE_MS lockout).
+#define FOOTSWITCH_EVENT_QUEUE 32
+
+struct FootswitchEvent
+{
+    uint8_t footswitch; // 1 = FS1, 2 = FS2
+    bool down;
+    uint32_t us; // micros() at the edge
+    uint32_t ms; // millis() at the edge
+};
+
+extern SpscQueue<FootswitchEvent, FOOTSWITCH_EVENT_QUEUE> footswitchEvents;
+
 void setupInput();
 void encoderISR();
+void foot1ISR();
+void foot2ISR();
+// Re-check the footswitch levels and emit any edge the interrupts skipped
+// during a debounce lockout (e.g. a very short tap). Call regularly.
+void pollFootswitches();
+// Sample a switch and return its debounced state (true = pressed)
+bool readSwitch(DebouncedSwitch &sw, unsigned long nowMs);
 
 #endif // INPUT_H
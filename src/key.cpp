@@ -0,0 +1,141 @@
+#include "key.h"
+#include "config.h"
+#include "NVRAM.h"
+#include <math.h>
+
+// Krumhansl-Kessler key profiles, indexed by semitones above the tonic
+static const float majorProfile[12] = {6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f};
+static const float minorProfile[12] = {6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f};
+
+// Profiles with mean removed and unit length, so a dot product with the
+// histogram gives the correlation numerator directly
+static float majorNorm[12];
+static float minorNorm[12];
+static bool profilesReady = false;
+
+// Decaying pitch-class histogram and the last correlation per key:
+// scores[0..11] = major keys C..B, scores[12..23] = minor keys C..B
+static float histogram[12];
+static float totalWeight = 0.0f;
+static float scores[24];
+static unsigned long lastUpdateMs = 0;
+
+static void normalizeProfile(const float *in, float *out)
+{
+    float mean = 0.0f;
+    for (int i = 0; i < 12; i++)
+        mean += in[i];
+    mean /= 12.0f;
+    float norm = 0.0f;
+    for (int i = 0; i < 12; i++)
+    {
+        out[i] = in[i] - mean;
+        norm += out[i] * out[i];
+    }
+    norm = sqrtf(norm);
+    for (int i = 0; i < 12; i++)
+        out[i] /= norm;
+}
+
+void resetKeyEstimate()
+{
+    for (int i = 0; i < 12; i++)
+        histogram[i] = 0.0f;
+    for (int i = 0; i < 24; i++)
+        scores[i] = 0.0f;
+    totalWeight = 0.0f;
+}
+
+void keyAddPitch(float cents, float weight, unsigned long nowMs)
+{
+    if (!profilesReady)
+    {
+        normalizeProfile(majorProfile, majorNorm);
+        normalizeProfile(minorProfile, minorNorm);
+        profilesReady = true;
+        lastUpdateMs = nowMs;
+    }
+
+    // Exponential decay by elapsed time
+    float decay = expf(-(float)(nowMs - lastUpdateMs) / KEY_DECAY_MS);
+    lastUpdateMs = nowMs;
+    totalWeight *= decay;
+    for (int i = 0; i < 12; i++)
+        histogram[i] *= decay;
+
+    int pc = ((int)lroundf(cents / 100.0f)) % 12;
+    if (pc < 0)
+        pc += 12;
+    histogram[pc] += weight;
+    totalWeight += weight;
+
+    // Correlate against every key: r = sum(h * p) / |h - mean(h)|
+    float sumSq = 0.0f;
+    float h2[24];
+    for (int i = 0; i < 12; i++)
+    {
+        sumSq += histogram[i] * histogram[i];
+        h2[i] = histogram[i];
+        h2[i + 12] = histogram[i];
+    }
+    float mean = totalWeight / 12.0f;
+    float var = sumSq - 12.0f * mean * mean;
+    float inv = (var > 1e-9f) ? 1.0f / sqrtf(var) : 0.0f;
+
+    for (int k = 0; k < 12; k++)
+    {
+        float ma = 0.0f;
+        float mi = 0.0f;
+        for (int i = 0; i < 12; i++)
+        {
+            ma += h2[k + i] * majorNorm[i];
+            mi += h2[k + i] * minorNorm[i];
+        }
+        scores[k] = ma * inv;
+        scores[k + 12] = mi * inv;
+    }
+}
+
+bool getKeyEstimate(int &key, int &mode, float &confidence)
+{
+    int best = 0;
+    for (int i = 1; i < 24; i++)
+    {
+        if (scores[i] > scores[best])
+            best = i;
+    }
+    key = best % 12;
+    mode = best / 12;
+    confidence = scores[best];
+    return totalWeight >= KEY_MIN_WEIGHT;
+}
+
+void applyAutoKey()
+{
+    // Fixed interval modes do not depend on the key
+    if (currentMode > 1)
+        return;
+
+    int key, mode;
+    float confidence;
+    if (!getKeyEstimate(key, mode, confidence) || confidence < KEY_MIN_CONFIDENCE)
+        return;
+    if (key == currentKey && mode == currentMode)
+        return;
+
+    // Hysteresis: only move when the estimate clearly beats the current key
+    float currentScore = scores[currentMode * 12 + currentKey];
+    if (confidence - currentScore < KEY_SWITCH_MARGIN)
+        return;
+
+    const char *keyNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+    Serial.print("Auto key: ");
+    Serial.print(keyNames[key]);
+    Serial.print(mode == 0 ? " Major" : " Minor");
+    Serial.print(" (r=");
+    Serial.print(confidence);
+    Serial.println(")");
+
+    currentKey = key;
+    currentMode = mode;
+}
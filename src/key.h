@@ -0,0 +1,24 @@
+#ifndef KEY_H
+#define KEY_H
+
+#include <Arduino.h>
+
+// Background key estimation.
+// Every accepted pitch is folded into a 12-bin pitch-class histogram that
+// decays over time, and the histogram is correlated against the
+// Krumhansl-Kessler major and minor key profiles in all 12 transpositions.
+// Cost per pitch is fixed (12 decays + 24x12 MACs) and nothing is allocated.
+
+// Add one pitch (cents = MIDI note * 100) with the given weight (e.g. the
+// detector probability)
+void keyAddPitch(float cents, float weight, unsigned long nowMs);
+// Clear the histogram
+void resetKeyEstimate();
+// Best matching key (0=C..11=B), mode (0=Major, 1=Minor) and its correlation
+// (-1..1). Returns false until enough pitches have been seen.
+bool getKeyEstimate(int &key, int &mode, float &confidence);
+// When MusicKey is set to Auto, move currentKey/currentMode to the estimate
+// once it is confident and clearly better than the current key
+void applyAutoKey();
+
+#endif // KEY_H
@@ -0,0 +1,131 @@
+#include "latency.h"
+
+struct StageStats
+{
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t sumUs;
+    uint16_t bins[LATENCY_BINS];
+};
+
+static StageStats stages[LATENCY_STAGE_COUNT];
+static uint32_t traceStartUs = 0;
+static bool traceActive = false;
+static bool stageSeen[LATENCY_STAGE_COUNT];
+
+static const char *stageNames[LATENCY_STAGE_COUNT] = {"switch", "pitch", "chord", "output"};
+
+static uint32_t defaultClock()
+{
+    return micros();
+}
+
+static uint32_t (*clockFn)() = defaultClock;
+static void (*outputWatch)(bool active) = nullptr;
+
+void latencySetClock(uint32_t (*clock)())
+{
+    clockFn = clock ? clock : defaultClock;
+}
+
+void latencySetOutputWatch(void (*watch)(bool active))
+{
+    outputWatch = watch;
+}
+
+static void record(LatencyStage stage, uint32_t delayUs)
+{
+    StageStats &s = stages[stage];
+    if (s.count == 0 || delayUs < s.minUs)
+        s.minUs = delayUs;
+    if (delayUs > s.maxUs)
+        s.maxUs = delayUs;
+    s.sumUs += delayUs;
+    s.count++;
+
+    uint32_t bin = delayUs / LATENCY_BIN_US;
+    if (bin >= LATENCY_BINS)
+        bin = LATENCY_BINS - 1;
+    if (s.bins[bin] < 0xFFFF)
+        s.bins[bin]++;
+}
+
+void latencyMarkAt(LatencyStage stage, uint32_t us)
+{
+    if (stage == LATENCY_SWITCH_EDGE)
+    {
+        traceStartUs = us;
+        traceActive = true;
+        for (int i = 0; i < LATENCY_STAGE_COUNT; i++)
+            stageSeen[i] = false;
+        stageSeen[LATENCY_SWITCH_EDGE] = true;
+        if (outputWatch)
+            outputWatch(false);
+        return;
+    }
+
+    if (!traceActive || stageSeen[stage])
+        return;
+    if (stage == LATENCY_FIRST_OUTPUT && !stageSeen[LATENCY_CHORD_SET])
+        return;
+
+    uint32_t delay = us - traceStartUs;
+    if (delay > LATENCY_TRACE_TIMEOUT_US)
+    {
+        traceActive = false;
+        return;
+    }
+
+    stageSeen[stage] = true;
+    record(stage, delay);
+
+    // The output probe watches for the first block after the chord is set
+    if (stage == LATENCY_CHORD_SET && outputWatch)
+        outputWatch(true);
+    if (stage == LATENCY_FIRST_OUTPUT)
+        traceActive = false;
+}
+
+void latencyMark(LatencyStage stage)
+{
+    latencyMarkAt(stage, clockFn());
+}
+
+bool latencySummary(LatencyStage stage, LatencySummary &summary)
+{
+    const StageStats &s = stages[stage];
+    summary = LatencySummary{s.count, s.minUs, 0, 0, s.maxUs};
+    if (s.count == 0)
+        return false;
+
+    summary.avgUs = (uint32_t)(s.sumUs / s.count);
+
+    // Smallest bin edge with at least 99% of the samples at or below it
+    uint32_t target = s.count - s.count / 100;
+    uint32_t seen = 0;
+    for (int i = 0; i < LATENCY_BINS; i++)
+    {
+        seen += s.bins[i];
+        if (seen >= target)
+        {
+            // the last bin also holds everything later, so it has no upper edge
+            summary.p99Us = (i == LATENCY_BINS - 1) ? s.maxUs : (uint32_t)(i + 1) * LATENCY_BIN_US;
+            break;
+        }
+    }
+    if (summary.p99Us > s.maxUs)
+        summary.p99Us = s.maxUs;
+    return true;
+}
+
+void latencyReset()
+{
+    memset(stages, 0, sizeof(stages));
+    traceActive = false;
+}
+
+const char *latencyStageName(LatencyStage stage)
+{
+    return (stage >= 0 && stage < LATENCY_STAGE_COUNT) ? stageNames[stage] : "?";
+}
@@ -0,0 +1,51 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <Arduino.h>
+
+// Footswitch-to-sound latency tracing.
+// A trace starts at an FS1 press edge; each later stage is timestamped the
+// first time it happens within that trace and its delay from the switch
+// edge is added to a per-stage histogram. Traces that do not reach a
+// stage within LATENCY_TRACE_TIMEOUT_US leave that stage unrecorded.
+//
+// The clock is injectable so traces can be replayed against a simulated
+// clock; stamps can also be supplied directly with latencyMarkAt(). The
+// output stage is stamped by an audio probe (latencyprobe.h), which the
+// core starts and stops through the output watch hook.
+
+#define LATENCY_BIN_US 250          // histogram resolution
+#define LATENCY_BINS 256            // covers 0-64 ms; later samples go to the last bin
+#define LATENCY_TRACE_TIMEOUT_US 2000000
+
+enum LatencyStage
+{
+    LATENCY_SWITCH_EDGE,     // FS1 press seen
+    LATENCY_PITCH_AVAILABLE, // tracker produced the first tonic
+    LATENCY_CHORD_SET,       // chord frequencies set from that tonic
+    LATENCY_FIRST_OUTPUT,    // first non-zero synth block after that
+    LATENCY_STAGE_COUNT
+};
+
+struct LatencySummary
+{
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t avgUs;
+    uint32_t p99Us; // upper edge of the histogram bin holding the 99th percentile
+    uint32_t maxUs;
+};
+
+// Clock in microseconds (defaults to micros())
+void latencySetClock(uint32_t (*clock)());
+// Called with true once a trace's chord is set (watch for the first
+// output block) and with false when a new trace starts
+void latencySetOutputWatch(void (*watch)(bool active));
+void latencyMark(LatencyStage stage);
+void latencyMarkAt(LatencyStage stage, uint32_t us);
+bool latencySummary(LatencyStage stage, LatencySummary &summary);
+void latencyReset();
+// Short stage name for reports ("switch", "pitch", "chord", "output")
+const char *latencyStageName(LatencyStage stage);
+
+#endif // LATENCY_H
@@ -0,0 +1,55 @@
+#include "latencyprobe.h"
+#include "latency.h"
+
+AudioAnalyzeLatencyProbe latencyProbe;
+
+static void watchOutput(bool active)
+{
+    if (active)
+        latencyProbe.arm();
+    else
+        latencyProbe.disarm();
+}
+
+void setupLatencyProbe()
+{
+    latencySetOutputWatch(watchOutput);
+}
+
+void latencyPoll()
+{
+    if (latencyProbe.available())
+        latencyMarkAt(LATENCY_FIRST_OUTPUT, latencyProbe.read());
+}
+
+bool AudioAnalyzeLatencyProbe::available()
+{
+    __disable_irq();
+    bool flag = stamped;
+    if (flag)
+        stamped = false;
+    __enable_irq();
+    return flag;
+}
+
+void AudioAnalyzeLatencyProbe::update(void)
+{
+    audio_block_t *block = receiveReadOnly();
+    if (!block)
+        return;
+
+    if (armed)
+    {
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+        {
+            if (block->data[i] != 0)
+            {
+                stampUs = micros();
+                stamped = true;
+                armed = false;
+                break;
+            }
+        }
+    }
+    release(block);
+}
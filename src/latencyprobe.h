@@ -0,0 +1,36 @@
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+#include <Arduino.h>
+#include <Audio.h>
+
+// Output stage of the FS1-to-sound latency trace (latency.h): a sink object
+// that timestamps the first non-zero block once armed. Connect it to the
+// synth output.
+class AudioAnalyzeLatencyProbe : public AudioStream
+{
+public:
+    AudioAnalyzeLatencyProbe() : AudioStream(1, inputQueueArray) {}
+
+    void arm() { armed = true; }
+    void disarm() { armed = false; }
+    bool available();
+    uint32_t read() { return stampUs; }
+
+    virtual void update(void);
+
+private:
+    audio_block_t *inputQueueArray[1];
+    volatile bool armed = false;
+    volatile bool stamped = false;
+    volatile uint32_t stampUs = 0;
+};
+
+extern AudioAnalyzeLatencyProbe latencyProbe;
+
+// Let latency traces arm and disarm the probe
+void setupLatencyProbe();
+// Collect the probe's stamp; call regularly from the main loop
+void latencyPoll();
+
+#endif // LATENCYPROBE_H
@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include <math.h>
+#include <stdio.h>
 #include "config.h"
 #include "NVRAM.h"
 #include "input.h"
@@ -8,6 +9,16 @@
 #include "menu.h"
 #include "display.h"
 #include "test.h"
+#include "key.h"
+#include "scheduler.h"
+#include "latency.h"
+#include "latencyprobe.h"
+#include "profiler.h"
+#include "tempo.h"
+#include "pot.h"
+#include "graph.h"
+#include "diag.h"
+#include "chordpitch.h"
 
 // Timing state
 unsigned long fs1ForcedUntilMs = 0;
@@ -18,17 +29,41 @@ float fsControlledVolume = 0.5f;    // 0.0 to 1.0
 bool useFsControlledVolume = false; // Whether to use FS volume (persists after exiting mode)
 unsigned long lastFsVolumeActivityMs = 0;
 int lastPotRaw = -1;                             // Track pot changes to detect override
-bool fsVolumeJustActivated = false;              // Skip first adjustment when entering mode
 bool fsVolumeExitArmed = false;                  // require release before allowing simultaneous-press exit
 unsigned long fsVolumePreventReenterUntilMs = 0; // prevent immediate re-entry after exit
 unsigned long fsIgnoreInputsUntilMs = 0;         // settling time after FS volume mode changes
 
 // Tap tempo state
 bool tapTempoActive = false;
-unsigned long lastFs2TapMs = 0;
+uint32_t lastFs2TapUs = 0;
 unsigned long lastTapTempoActivityMs = 0;
 float tapTempoAbortedVolume = 0.0f; // Store volume if fadeout was aborted
 
+// State shared between the main loop tasks
+float effectiveVolume = 0.0f; // pot or FS-controlled volume, updated by the control task
+bool fs1Held = false;         // debounced FS1, updated by the input task
+bool fs2Held = false;         // debounced FS2, updated by the input task
+
+// Footswitch press tracking: presses of FS1 and FS2 within FS_COMBO_WINDOW_MS
+// of each other are one simultaneous press
+unsigned long fs1PressMs = 0;
+unsigned long fs2PressMs = 0;
+uint32_t fs1PressUs = 0;
+uint32_t fs2PressUs = 0;
+bool fs1PressPending = false;
+bool fs2PressPending = false;
+
+// Last pitch reading, shown on the home screen
+const char *displayNoteName = "---";
+float displayFrequency = 0.0f;
+unsigned long lastPitchReadingMs = 0;
+
+void taskInput();
+void taskPitch();
+void taskControl();
+void taskDisplay();
+void taskStats();
+
 void setup()
 {
     Serial.begin(9600);
@@ -36,9 +71,11 @@ void setup()
 
     // Initialize subsystems
     setupAudio();
+    setupLatencyProbe();
     setupPitchDetection();
     loadNVRAM();
     setupInput();
+    setupPot();
     setupDisplay();
 
     Serial.println("=== SETUP COMPLETE ===");
@@ -50,85 +87,50 @@ void setup()
         hardwareTestMode();
         // Never returns
     }
+
+    // Main loop tasks, run in this order on every pass
+    schedulerAddPeriodic("input", taskInput, INPUT_SCAN_PERIOD_US);
+    schedulerAddTriggered("pitch", taskPitch, pitchDataReady, PITCH_DEADLINE_US);
+    schedulerAddPeriodic("control", taskControl, CONTROL_PERIOD_US);
+    schedulerAddPeriodic("display", taskDisplay, DISPLAY_PERIOD_US);
+    schedulerAddPeriodic("stats", taskStats, SCHED_STATS_PERIOD_US);
 }
 
 void loop()
+{
+    diagLoopTick();
+    schedulerRun();
+}
+
+// ----------------------
+// Input task (1 kHz): footswitches, encoder and menu navigation
+// ----------------------
+// Called once per footswitch event (with the event's time) and once per
+// scan with the current time, so pending presses expire without new edges
+void handleFootswitches(unsigned long now, uint32_t nowUs, bool fs1_raw, bool fs2)
 {
     static bool prevFs1 = false;
     static bool prevFs2 = false;
-    static bool prevEncButton = false;
-    static int lastEncoderPosition = 0;
-    unsigned long now = millis();
-
-    // Read pot for volume control
-    int potRaw = analogRead(POT_PIN);
-    float potNorm = potRaw / 1023.0;
 
-    // Track pot and show volume display when user adjusts pot (do NOT enter FS volume mode)
-    if (lastPotRaw == -1)
-    {
-        lastPotRaw = potRaw; // Initialize on first loop
-    }
-
-    if (abs(potRaw - lastPotRaw) > 10) // ~1% threshold
+    bool fs1Edge = fs1_raw && !prevFs1;
+    bool fs2Edge = fs2 && !prevFs2;
+    if (fs1Edge)
     {
-        // If we were using FS-controlled volume, revert back to pot control
-        if (useFsControlledVolume)
-        {
-            useFsControlledVolume = false;
-            if (fsVolumeControlActive)
-            {
-                fsVolumeControlActive = false;
-                fsVolumeExitArmed = false;
-            }
-            Serial.println("FS volume control overridden by pot");
-        }
-
-        // Show the volume-control display and reset the idle timer.
-        // NOTE: we do NOT set fsVolumeControlActive or useFsControlledVolume here.
-        currentScreen = SCREEN_VOLUME_CONTROL;
-        lastFsVolumeActivityMs = now;
-        lastPotRaw = potRaw;
+        fs1PressMs = now;
+        fs1PressUs = nowUs;
+        fs1PressPending = true;
     }
-    else if (!useFsControlledVolume)
+    if (fs2Edge)
     {
-        lastPotRaw = potRaw;
+        fs2PressMs = now;
+        fs2PressUs = nowUs;
+        fs2PressPending = true;
     }
 
-    // Determine effective volume based on control mode
-    float effectiveVolume = useFsControlledVolume ? fsControlledVolume : potNorm;
-
-    // Update chord volume in real-time
-    updateChordVolume(effectiveVolume);
-
-    // Handle non-blocking fade-out
-    updateChordFade();
-
-    // Apply any synth vibrato (e.g., organ) each loop
-    updateVibrato();
-
-    // Apply Rhodes decay if active
-    updateRhodesDecay();
-
-    // Update arpeggiator if active
-    updateArpeggiator();
-
-    // Return to home screen after fade completes
-    if (!chordFading && currentScreen == SCREEN_FADE)
-    {
-        currentScreen = SCREEN_HOME;
-    }
-
-    // Restart chord if not active (ensure continuous playback)
-    if (!chordActive && !chordSuppressed)
-    {
-        startChord(effectiveVolume, currentChordTonic, currentKey, currentMode);
-    }
-
-    // Read inputs
-    bool encButton = !digitalRead(ENC_BTN);
-    bool fs1_raw = !digitalRead(FOOT1);
-    bool fs2 = !digitalRead(FOOT2);
+    // Both footswitches down, the second one just now, and their presses
+    // close enough together to be one simultaneous press
+    unsigned long pressGap = (fs1PressMs > fs2PressMs) ? fs1PressMs - fs2PressMs : fs2PressMs - fs1PressMs;
+    bool comboPress = fs1_raw && fs2 && (fs1Edge || fs2Edge) && pressGap <= FS_COMBO_WINDOW_MS;
 
     // If currently in FS volume control, require a full release before
     // allowing a simultaneous FS1+FS2 press to exit the mode. This avoids
@@ -143,10 +145,12 @@ void loop()
         }
 
         // If both pressed and we've seen a release since activation, exit
-        if (fs1_raw && fs2 && fsVolumeExitArmed)
+        if (comboPress && fsVolumeExitArmed)
         {
             fsVolumeControlActive = false;
             fsVolumeExitArmed = false;
+            fs1PressPending = false;
+            fs2PressPending = false;
             // Prevent immediate re-entry on the same held press
             fsVolumePreventReenterUntilMs = now + 200; // 200ms cooldown
             // Ignore all FS inputs for settling time to prevent accidental triggers
@@ -158,12 +162,13 @@ void loop()
     }
 
     // Detect both footswitches pressed simultaneously to enter FS volume control mode
-    if (fs1_raw && fs2 && !prevFs1 && !prevFs2 && now >= fsVolumePreventReenterUntilMs)
+    if (comboPress && !fsVolumeControlActive && now >= fsVolumePreventReenterUntilMs)
     {
         fsVolumeControlActive = true;
         useFsControlledVolume = true;
-        fsVolumeJustActivated = true;         // Skip adjustment on activation
         fsVolumeExitArmed = false;            // require a release before allowing exit
+        fs1PressPending = false;              // the activating presses do not adjust
+        fs2PressPending = false;
         fsControlledVolume = effectiveVolume; // Start with current volume
         lastFsVolumeActivityMs = now;
         // Ignore all FS inputs for settling time to prevent accidental triggers
@@ -172,144 +177,90 @@ void loop()
         Serial.println("FS volume control mode activated");
     }
 
+    // A single press is acted on once it can no longer become part of a
+    // simultaneous press. FS1 outside FS volume mode starts the chord, so it
+    // is taken at once; a second press arriving within the window then
+    // still enters FS volume mode.
+    bool fs1Press = fs1PressPending && (!fsVolumeControlActive || now - fs1PressMs > FS_COMBO_WINDOW_MS);
+    bool fs2Press = fs2PressPending && (now - fs2PressMs > FS_COMBO_WINDOW_MS);
+    if (fs1Press)
+        fs1PressPending = false;
+    if (fs2Press)
+        fs2PressPending = false;
+
     // Handle FS volume control mode
     if (fsVolumeControlActive)
     {
-        // Check for timeout
-        if ((now - lastFsVolumeActivityMs) > FS_VOLUME_TIMEOUT_MS)
+        // Handle FS1 press (decrement volume) - operate in dB space so
+        // steps correspond to the logarithmic display. Each FS step
+        // moves ~15 percentage points on the displayed scale -> that's
+        // (15% of 60 dB) = 9 dB per step when minDb=-60.
+        const float minDb = -60.0f;
+        const float dbStep = 9.0f; // corresponds to ~15% displayed
+
+        if (fs1Press)
         {
-            fsVolumeControlActive = false;
-            fsVolumeExitArmed = false;
-            // Keep useFsControlledVolume true so volume persists until pot is moved
-            currentScreen = SCREEN_HOME;
-            Serial.println("FS volume control timeout");
-        }
-        else
-        {
-            // Skip adjustments on the initial activation cycle
-            if (fsVolumeJustActivated)
-            {
-                fsVolumeJustActivated = false;
-            }
+            // convert current linear volume to dB
+            float curDb;
+            if (fsControlledVolume <= 0.000001f)
+                curDb = minDb;
             else
-            {
-                // Handle FS1 press (decrement volume) - operate in dB space so
-                // steps correspond to the logarithmic display. Each FS step
-                // moves ~15 percentage points on the displayed scale -> that's
-                // (15% of 60 dB) = 9 dB per step when minDb=-60.
-                const float minDb = -60.0f;
-                const float dbStep = 9.0f; // corresponds to ~15% displayed
-
-                if (fs1_raw && !prevFs1)
-                {
-                    // convert current linear volume to dB
-                    float curDb;
-                    if (fsControlledVolume <= 0.000001f)
-                        curDb = minDb;
-                    else
-                        curDb = 20.0f * log10f(fsControlledVolume);
-
-                    curDb -= dbStep;
-                    if (curDb < minDb)
-                        curDb = minDb;
-
-                    fsControlledVolume = powf(10.0f, curDb / 20.0f);
-                    lastFsVolumeActivityMs = now;
-                    updateChordVolume(fsControlledVolume);
-
-                    // Show logged percent in serial to match display
-                    float pct = (curDb - minDb) / (-minDb) * 100.0f;
-                    Serial.print("FS volume decreased to: ");
-                    Serial.println((int)(pct + 0.5f));
-                }
+                curDb = 20.0f * log10f(fsControlledVolume);
 
-                // Handle FS2 press (increment volume)
-                if (fs2 && !prevFs2)
-                {
-                    float curDb;
-                    if (fsControlledVolume <= 0.000001f)
-                        curDb = minDb;
-                    else
-                        curDb = 20.0f * log10f(fsControlledVolume);
-
-                    curDb += dbStep;
-                    if (curDb > 0.0f)
-                        curDb = 0.0f;
-
-                    fsControlledVolume = powf(10.0f, curDb / 20.0f);
-                    lastFsVolumeActivityMs = now;
-                    updateChordVolume(fsControlledVolume);
-
-                    float pct = (curDb - minDb) / (-minDb) * 100.0f;
-                    Serial.print("FS volume increased to: ");
-                    Serial.println((int)(pct + 0.5f));
-                }
-            }
-        }
-    }
+            curDb -= dbStep;
+            if (curDb < minDb)
+                curDb = minDb;
 
-    // Pot-driven volume display timeout (only when not in FS volume mode)
-    if (!fsVolumeControlActive && currentScreen == SCREEN_VOLUME_CONTROL && (now - lastFsVolumeActivityMs) > FS_VOLUME_TIMEOUT_MS)
-    {
-        currentScreen = SCREEN_HOME;
-        Serial.println("Volume display timeout (pot)");
-    }
+            fsControlledVolume = powf(10.0f, curDb / 20.0f);
+            lastFsVolumeActivityMs = now;
+            updateChordVolume(fsControlledVolume);
 
-    // On raw press-edge, ensure FS1 remains true for at least the minimum window
-    if (fs1_raw && !prevFs1 && !fsVolumeControlActive)
-    {
-        fs1ForcedUntilMs = now + FS1_MIN_ACTIVATION_MS;
-    }
+            // Show logged percent in serial to match display
+            float pct = (curDb - minDb) / (-minDb) * 100.0f;
+            Serial.print("FS volume decreased to: ");
+            Serial.println((int)(pct + 0.5f));
+        }
 
-    // Pot-driven volume display timeout (only when not in FS volume mode)
-    if (!fsVolumeControlActive && currentScreen == SCREEN_VOLUME_CONTROL && (now - lastFsVolumeActivityMs) > FS_VOLUME_TIMEOUT_MS)
-    {
-        currentScreen = SCREEN_HOME;
-        Serial.println("Volume display timeout (pot)");
-    }
+        // Handle FS2 press (increment volume)
+        if (fs2Press)
+        {
+            float curDb;
+            if (fsControlledVolume <= 0.000001f)
+                curDb = minDb;
+            else
+                curDb = 20.0f * log10f(fsControlledVolume);
 
+            curDb += dbStep;
+            if (curDb > 0.0f)
+                curDb = 0.0f;
 
-    // Effective FS1 seen by the rest of the loop (remains true for short taps)
-    bool fs1 = fs1_raw || (now < fs1ForcedUntilMs);
+            fsControlledVolume = powf(10.0f, curDb / 20.0f);
+            lastFsVolumeActivityMs = now;
+            updateChordVolume(fsControlledVolume);
 
-    // Optionally suppress chord audio output while the FS1 forced window is active
-    // Muting menu overrides the behavior: when Muting is Enabled -> suppress during transition, when Disabled -> do not suppress
-    bool suppressChordDuringTransition = (now < fs1ForcedUntilMs) && currentMutingEnabled;
-    if (suppressChordDuringTransition)
-    {
-        // Only mute if not currently fading (let fades complete)
-        if (!chordFading)
-        {
-            myEffect.amplitude(0);
-            myEffect2.amplitude(0);
-            myEffect3.amplitude(0);
+            float pct = (curDb - minDb) / (-minDb) * 100.0f;
+            Serial.print("FS volume increased to: ");
+            Serial.println((int)(pct + 0.5f));
         }
     }
-    else
+
+    // On raw press-edge, ensure FS1 remains true for at least the minimum window
+    if (fs1Edge && !fsVolumeControlActive)
     {
-        // If chord is active and not fading, ensure amplitude reflects stored beepAmp
-        if (chordActive && !chordFading)
-        {
-            float perVoice = beepAmp / 3.0f;
-            myEffect.amplitude(perVoice);
-            myEffect2.amplitude(perVoice);
-            myEffect3.amplitude(perVoice);
-        }
+        fs1ForcedUntilMs = now + FS1_MIN_ACTIVATION_MS;
     }
 
-    // FS2 press edge: handle tap tempo or chord stop
-    if (fs2 && !prevFs2 && !fsVolumeControlActive && now >= fsIgnoreInputsUntilMs)
+    // FS2 press: handle tap tempo or chord stop. Tap intervals use the time
+    // of the press edge, not the time the press was acted on.
+    if (fs2Press && !fsVolumeControlActive && fs2PressMs >= fsIgnoreInputsUntilMs)
     {
         // Check if we're in tap tempo mode
         if (tapTempoActive)
         {
-            // Calculate tempo from tap interval
-            unsigned long tapInterval = now - lastFs2TapMs;
-            if (tapInterval > 50) // Debounce: ignore taps less than 50ms apart
+            // Tempo from the averaged tap intervals (outliers are held back)
+            float newBPM;
+            if (tapTempoTap(fs2PressUs, newBPM))
             {
-                // Convert interval to BPM: BPM = 60000 / interval_ms
-                float newBPM = 60000.0f / (float)tapInterval;
-
                 // Clamp to 40-200 BPM range
                 if (newBPM < 40.0f)
                     newBPM = 40.0f;
@@ -318,28 +269,28 @@ void loop()
 
                 globalTempoBPM = newBPM;
 
-                // Update arp step duration: eighth note = (60000 / BPM) / 2
-                arpStepDurationMs = (unsigned long)(30000.0f / globalTempoBPM);
-
-                // Update the timer interval if arpeggiator is running
-                updateArpTimerInterval();
+                // The arpeggiator picks the new tempo up at its next step
+                updateArpTempo();
 
-                lastTapTempoActivityMs = now;
                 Serial.print("Tap tempo: ");
                 Serial.print(globalTempoBPM);
                 Serial.println(" BPM");
             }
-            lastFs2TapMs = now;
+            lastTapTempoActivityMs = now;
+            lastFs2TapUs = fs2PressUs;
         }
         else
         {
             // Check for double-tap to enter tap tempo mode
-            if ((now - lastFs2TapMs) <= 1000) // Double-tap within 1 second
+            if ((fs2PressUs - lastFs2TapUs) <= 1000000) // Double-tap within 1 second
             {
-                // Enter tap tempo mode
+                // Enter tap tempo mode; this tap starts the interval sequence
                 tapTempoActive = true;
                 lastTapTempoActivityMs = now;
-                lastFs2TapMs = now;
+                lastFs2TapUs = fs2PressUs;
+                float unusedBpm;
+                tapTempoReset();
+                tapTempoTap(fs2PressUs, unusedBpm);
                 currentScreen = SCREEN_TAP_TEMPO;
 
                 // If fadeout was just started, abort it and restore volume
@@ -348,8 +299,9 @@ void loop()
                     chordFading = false;
                     tapTempoAbortedVolume = chordFadeStartAmp;
                     beepAmp = tapTempoAbortedVolume;
-                    // Restore oscillator amplitudes
-                    updateChordVolume(tapTempoAbortedVolume);
+                    // Restore oscillator amplitudes and reopen the envelope
+                    updateChordVolume(effectiveVolume);
+                    chordSynth.noteOn();
                     Serial.println("Tap tempo mode activated - fadeout aborted");
                 }
                 else
@@ -373,21 +325,15 @@ void loop()
                 }
             }
 
-            lastFs2TapMs = now;
+            lastFs2TapUs = fs2PressUs;
         }
     }
 
-    // Tap tempo timeout: exit after 3 seconds of inactivity
-    if (tapTempoActive && (now - lastTapTempoActivityMs) > 3000)
+    // FS1 press: if chord was suppressed (stopped by FS2), re-enable it (unless in FS volume control mode, within settling time, or in tap tempo mode)
+    if (fs1Press && !fsVolumeControlActive && now >= fsIgnoreInputsUntilMs && !tapTempoActive)
     {
-        tapTempoActive = false;
-        currentScreen = SCREEN_HOME;
-        Serial.println("Tap tempo mode timeout");
-    }
+        latencyMarkAt(LATENCY_SWITCH_EDGE, fs1PressUs);
 
-    // FS1 press edge: if chord was suppressed (stopped by FS2), re-enable it (unless in FS volume control mode, within settling time, or in tap tempo mode)
-    if (fs1_raw && !prevFs1 && !fsVolumeControlActive && now >= fsIgnoreInputsUntilMs && !tapTempoActive)
-    {
         // Reset pitch detection to clear stale frequency data
         resetPitchDetection();
 
@@ -398,26 +344,25 @@ void loop()
         }
     }
 
-    // Read pitch detection
-    float frequency = 0.0;
-    float probability = 0.0;
-    const char *noteName = "---";
-    updatePitchDetection(frequency, probability, noteName, currentInstrumentIsBass);
-
-    // Update chord in real-time while sampling (only when FS1 is held and NOT in FS volume control mode or tap tempo mode)
-    if (fs1 && lastDetectedFrequency > 0.0f && !fsVolumeControlActive && !tapTempoActive)
-    {
-        updateChordTonic(lastDetectedFrequency, currentKey, currentMode);
-    }
-
     // FS1 release edge: start Rhodes decay if Rhodes is active
     if (!fs1_raw && prevFs1)
     {
         startRhodesDecay();
     }
 
+    // Track state for edge detection next scan
+    prevFs1 = fs1_raw;
+    prevFs2 = fs2;
+}
+
+void handleEncoder(unsigned long now, bool encButton)
+{
+    static bool prevEncButton = false;
+    static int lastEncoderPosition = 0;
+
     // Detect encoder activity for UI timeout and menu navigation
-    if (encoderPosition != lastEncoderPosition)
+    int position = encoderPosition;
+    if (position != lastEncoderPosition)
     {
         lastEncoderActivityMs = now;
         if (currentScreen == SCREEN_HOME)
@@ -425,16 +370,22 @@ void loop()
             currentScreen = SCREEN_MENU;
             currentMenuLevel = MENU_TOP;
         }
+        else if (currentScreen == SCREEN_DIAGNOSTICS)
+        {
+            // Leave the diagnostics page back to the Config menu
+            currentScreen = SCREEN_MENU;
+            currentMenuLevel = MENU_CONFIG_SELECT;
+        }
 
         // Handle encoder changes based on current menu level
-        if (currentScreen == SCREEN_MENU)
+        else if (currentScreen == SCREEN_MENU)
         {
             // REVERSED direction: turning encoder one way now moves selection opposite
-            int delta = lastEncoderPosition - encoderPosition;
+            int delta = lastEncoderPosition - position;
             handleMenuEncoder(delta);
         }
 
-        lastEncoderPosition = encoderPosition;
+        lastEncoderPosition = position;
     }
 
     // Handle encoder button press for menu selection
@@ -447,6 +398,12 @@ void loop()
             currentMenuLevel = MENU_TOP;
             lastEncoderActivityMs = now;
         }
+        else if (currentScreen == SCREEN_DIAGNOSTICS)
+        {
+            currentScreen = SCREEN_MENU;
+            currentMenuLevel = MENU_CONFIG_SELECT;
+            lastEncoderActivityMs = now;
+        }
         else if (currentScreen == SCREEN_MENU)
         {
             lastEncoderActivityMs = now; // keep menu active
@@ -461,6 +418,213 @@ void loop()
         }
     }
 
+    prevEncButton = encButton;
+}
+
+void taskInput()
+{
+    unsigned long now = millis();
+
+    bool encButton = readSwitch(encButtonSwitch, now);
+
+    // Catch edges the interrupts skipped during a debounce lockout
+    pollFootswitches();
+
+    // Replay footswitch edges in order, at the time they happened
+    PROFILE_BEGIN(PROF_FOOTSWITCH);
+    FootswitchEvent event;
+    while (footswitchEvents.pop(event))
+    {
+        if (event.footswitch == 1)
+            fs1Held = event.down;
+        else
+            fs2Held = event.down;
+        handleFootswitches(event.ms, event.us, fs1Held, fs2Held);
+    }
+    handleFootswitches(now, micros(), fs1Held, fs2Held);
+    PROFILE_END(PROF_FOOTSWITCH);
+
+    PROFILE_BEGIN(PROF_ENCODER);
+    handleEncoder(now, encButton);
+    PROFILE_END(PROF_ENCODER);
+}
+
+// ----------------------
+// Pitch task: runs as soon as the detector has a new estimate or attack
+// ----------------------
+void taskPitch()
+{
+    unsigned long now = millis();
+
+    float frequency = 0.0;
+    float probability = 0.0;
+    const char *noteName = "---";
+    PROFILE_BEGIN(PROF_PITCH);
+    updatePitchDetection(frequency, probability, noteName, currentInstrumentIsBass);
+    PROFILE_END(PROF_PITCH);
+    if (frequency > 0.0f)
+    {
+        displayNoteName = noteName;
+        displayFrequency = frequency;
+        lastPitchReadingMs = now;
+    }
+
+    // Follow the estimated key when MusicKey is set to Auto
+    if (currentKeyAuto)
+    {
+        applyAutoKey();
+    }
+
+    // Effective FS1 (remains true for short taps)
+    bool fs1 = fs1Held || (now < fs1ForcedUntilMs);
+
+    // Update chord in real-time while sampling (only when FS1 is held and NOT in FS volume control mode or tap tempo mode)
+    if (fs1 && lastDetectedFrequency > 0.0f && !fsVolumeControlActive && !tapTempoActive)
+    {
+        latencyMark(LATENCY_PITCH_AVAILABLE);
+
+        // The chord is retuned only when its root note changes (Quantized
+        // or Follow, see chordpitch.h); Follow bends it in between
+        bool retune = updateChordPitch(lastDetectedFrequency, lastFineFrequency, currentKey, currentMode,
+                                       pitchJustLocked(), now);
+        if (retune && !pitchJustLocked() && currentPitchMode == PITCH_MODE_FOLLOW)
+        {
+            // Settled on a new note while bent to it: same pitch, new chord
+            rebaseChordTonic(chordPitchRoot(), chordPitchBend(), currentKey, currentMode);
+        }
+        else if (retune || pitchJustLocked())
+        {
+            updateChordTonic(chordPitchRoot(), currentKey, currentMode);
+            latencyMark(LATENCY_CHORD_SET);
+        }
+        chordSynth.bend(chordPitchBend());
+
+        // Telemetry: time from the attack to the chord taking the new note
+        if (pitchJustLocked())
+        {
+            Serial.print("Onset->chord latency: ");
+            Serial.print((micros() - pitchOnsetMicros()) / 1000.0f, 1);
+            Serial.println(" ms");
+        }
+    }
+}
+
+// ----------------------
+// Control task: volume, fades, vibrato, decay and UI timeouts
+// ----------------------
+void taskControl()
+{
+    unsigned long now = millis();
+
+    // Pot for volume control (sampled and filtered in the background)
+    PROFILE_BEGIN(PROF_POT);
+    int potRaw = potReading();
+    float potNorm = potRaw / 1023.0;
+    PROFILE_END(PROF_POT);
+
+    PROFILE_BEGIN(PROF_VOLUME);
+
+    // Track pot and show volume display when user adjusts pot (do NOT enter FS volume mode)
+    if (lastPotRaw == -1)
+    {
+        lastPotRaw = potRaw; // Initialize on first run
+    }
+
+    if (abs(potRaw - lastPotRaw) > 10) // ~1% threshold
+    {
+        // If we were using FS-controlled volume, revert back to pot control
+        if (useFsControlledVolume)
+        {
+            useFsControlledVolume = false;
+            if (fsVolumeControlActive)
+            {
+                fsVolumeControlActive = false;
+                fsVolumeExitArmed = false;
+            }
+            Serial.println("FS volume control overridden by pot");
+        }
+
+        // Show the volume-control display and reset the idle timer.
+        // NOTE: we do NOT set fsVolumeControlActive or useFsControlledVolume here.
+        currentScreen = SCREEN_VOLUME_CONTROL;
+        lastFsVolumeActivityMs = now;
+        lastPotRaw = potRaw;
+    }
+    else if (!useFsControlledVolume)
+    {
+        lastPotRaw = potRaw;
+    }
+
+    // Determine effective volume based on control mode
+    effectiveVolume = useFsControlledVolume ? fsControlledVolume : potNorm;
+
+    // Update chord volume in real-time
+    updateChordVolume(effectiveVolume);
+    PROFILE_END(PROF_VOLUME);
+
+    // Collect the latency probe's output stamp
+    latencyPoll();
+
+    // Profiler dump/reset commands
+    profilerPollSerial();
+
+    // Handle non-blocking fade-out
+    PROFILE_BEGIN(PROF_FADE);
+    updateChordFade();
+    PROFILE_END(PROF_FADE);
+
+    // Apply any synth vibrato (e.g., organ)
+    PROFILE_BEGIN(PROF_VIBRATO);
+    updateVibrato();
+    PROFILE_END(PROF_VIBRATO);
+
+    // Apply Rhodes decay if active
+    PROFILE_BEGIN(PROF_DECAY);
+    updateRhodesDecay();
+    PROFILE_END(PROF_DECAY);
+
+    // Update arpeggiator if active
+    PROFILE_BEGIN(PROF_ARP);
+    updateArpeggiator();
+    PROFILE_END(PROF_ARP);
+
+    // Return to home screen after fade completes
+    if (!chordFading && currentScreen == SCREEN_FADE)
+    {
+        currentScreen = SCREEN_HOME;
+    }
+
+    // Restart chord if not active (ensure continuous playback)
+    if (!chordActive && !chordSuppressed)
+    {
+        startChord(effectiveVolume, currentChordTonic, currentKey, currentMode);
+    }
+
+    // FS volume control timeout
+    if (fsVolumeControlActive && (now - lastFsVolumeActivityMs) > FS_VOLUME_TIMEOUT_MS)
+    {
+        fsVolumeControlActive = false;
+        fsVolumeExitArmed = false;
+        // Keep useFsControlledVolume true so volume persists until pot is moved
+        currentScreen = SCREEN_HOME;
+        Serial.println("FS volume control timeout");
+    }
+
+    // Pot-driven volume display timeout (only when not in FS volume mode)
+    if (!fsVolumeControlActive && currentScreen == SCREEN_VOLUME_CONTROL && (now - lastFsVolumeActivityMs) > FS_VOLUME_TIMEOUT_MS)
+    {
+        currentScreen = SCREEN_HOME;
+        Serial.println("Volume display timeout (pot)");
+    }
+
+    // Tap tempo timeout: exit after 3 seconds of inactivity
+    if (tapTempoActive && (now - lastTapTempoActivityMs) > 3000)
+    {
+        tapTempoActive = false;
+        currentScreen = SCREEN_HOME;
+        Serial.println("Tap tempo mode timeout");
+    }
+
     // Timeout back to home screen after inactivity
     if (currentScreen == SCREEN_MENU && (now - lastEncoderActivityMs) > SCREEN_TIMEOUT_MS)
     {
@@ -468,31 +632,44 @@ void loop()
         currentMenuLevel = MENU_TOP;
     }
 
-    // Serial output for debugging
-    // Serial.print("AudioShield: ");
-    // Serial.print(audioShieldEnabled ? "ENABLED " : "DISABLED ");
-    // Serial.print("Enc:");
-    // Serial.print(encoderPosition);
-    // Serial.print(" Btn:");
-    // Serial.print(encButton ? "PRESSED" : "released");
-    // Serial.print(" FS1:");
-    // Serial.print(fs1 ? "ON" : "off");
-    // Serial.print(" FS2:");
-    // Serial.print(fs2 ? "ON" : "off");
-    // Serial.print(" Pot raw: ");
-    // Serial.print(potRaw);
-    // Serial.print(" Note: ");
-    // Serial.print(noteName);
-    // Serial.print(" (");
-    // Serial.print(frequency, 1);
-    // Serial.print(" Hz, prob: ");
-    // Serial.print(probability, 2);
-    // Serial.println(")");
+    // Optionally suppress chord audio output while the FS1 forced window is active
+    // Muting menu overrides the behavior: when Muting is Enabled -> suppress during transition, when Disabled -> do not suppress
+    bool suppressChordDuringTransition = (now < fs1ForcedUntilMs) && currentMutingEnabled;
+    if (suppressChordDuringTransition)
+    {
+        // Only mute if not currently fading (let fades complete)
+        if (!chordFading)
+        {
+            muteChord(true);
+        }
+    }
+    else
+    {
+        // Release the transition mute; the envelope re-attacks the chord
+        muteChord(false);
+    }
+}
+
+// ----------------------
+// Display task: redraw at a capped frame rate
+// ----------------------
+void taskDisplay()
+{
+    // Audio resource snapshot (refreshes itself every DIAG_REFRESH_MS)
+    diagUpdate();
+
+    // Drop a stale reading so the home screen shows "---" between notes
+    if (millis() - lastPitchReadingMs > PITCH_DISPLAY_HOLD_MS)
+    {
+        displayNoteName = "---";
+        displayFrequency = 0.0f;
+    }
 
     // Render appropriate screen
+    PROFILE_BEGIN(PROF_RENDER);
     if (currentScreen == SCREEN_HOME)
     {
-        renderHomeScreen(noteName, frequency);
+        renderHomeScreen(displayNoteName, displayFrequency);
     }
     else if (currentScreen == SCREEN_MENU)
     {
@@ -510,12 +687,58 @@ void loop()
     {
         renderTapTempoScreen(globalTempoBPM);
     }
+    else if (currentScreen == SCREEN_DIAGNOSTICS)
+    {
+        // Only redraw when the snapshot has been refreshed
+        static uint32_t lastDiagRenderMs = 0;
+        if (millis() - lastDiagRenderMs >= DIAG_REFRESH_MS)
+        {
+            lastDiagRenderMs = millis();
+            renderDiagnosticsScreen();
+        }
+    }
+    PROFILE_END(PROF_RENDER);
+}
 
-    // Track state for edge detection next iteration
-    prevFs1 = fs1_raw;
-    prevFs2 = fs2;
-    prevEncButton = encButton;
+static void printSchedulerStats()
+{
+    Serial.println("Task       runs  overruns  maxJitterUs  maxRunUs");
+    TaskStats s;
+    for (int id = 0; schedulerGetStats(id, s); id++)
+    {
+        char line[64];
+        snprintf(line, sizeof(line), "%-8s %6lu %9lu %12lu %9lu", s.name, (unsigned long)s.runs,
+                 (unsigned long)s.overruns, (unsigned long)s.maxJitterUs, (unsigned long)s.maxRunUs);
+        Serial.println(line);
+    }
+}
+
+static void printLatencyStats()
+{
+    LatencySummary s;
+    if (!latencySummary(LATENCY_PITCH_AVAILABLE, s))
+        return;
 
-    delay(50);
+    Serial.println("FS1 latency (us)   count      min      avg      p99      max");
+    for (int i = LATENCY_PITCH_AVAILABLE; i < LATENCY_STAGE_COUNT; i++)
+    {
+        latencySummary((LatencyStage)i, s);
+        char line[80];
+        snprintf(line, sizeof(line), "  to %-12s %7lu %8lu %8lu %8lu %8lu", latencyStageName((LatencyStage)i),
+                 (unsigned long)s.count, (unsigned long)s.minUs, (unsigned long)s.avgUs,
+                 (unsigned long)s.p99Us, (unsigned long)s.maxUs);
+        Serial.println(line);
+    }
 }
 
+// Task timing report (jitter/overruns since the last report), per-object
+// audio CPU since the last report and the cumulative FS1-to-sound latency
+// histograms
+void taskStats()
+{
+    printSchedulerStats();
+    schedulerResetStats();
+    graphPrint();
+    graphResetUsage();
+    printLatencyStats();
+}
@@ -1,6 +1,9 @@
 #include "menu.h"
 #include "NVRAM.h"
 #include "audio.h"
+#include "config.h"
+#include "display.h"
+#include "chordpitch.h"
 
 // Menu state
 MenuLevel currentMenuLevel = MENU_TOP;
@@ -26,15 +29,18 @@ int arpViewportStart = 0;
 int configViewportStart = 0;
 int outputViewportStart = 0;
 int stopModeViewportStart = 0;
+int glideViewportStart = 0;
+int pitchModeViewportStart = 0;
 
 // Menu display names
 const char *menuTopItems[] = {"MusicKey", "Maj/Min", "Octave", "SynthSnd", "Arp/Poly", "Config"};
 const int MENU_TOP_COUNT = 6;
 
-const char *keyMenuNames[] = {"A", "Bb", "B", "C", "C#/Db", "D", "D#/Eb", "E", "F", "F#/Gb", "G", "G#/Ab"};
-const int KEY_MENU_COUNT = 12;
-// Map menu index to chromatic scale (C=0, C#=1, ... B=11)
+const char *keyMenuNames[] = {"A", "Bb", "B", "C", "C#/Db", "D", "D#/Eb", "E", "F", "F#/Gb", "G", "G#/Ab", "Auto"};
+const int KEY_MENU_COUNT = 13;
+// Map menu index to chromatic scale (C=0, C#=1, ... B=11); the last entry is Auto
 const int keyMenuToChromatic[] = {9, 10, 11, 0, 1, 2, 3, 4, 5, 6, 7, 8}; // A, Bb, B, C, C#, D, D#, E, F, F#, G, G#
+const int KEY_MENU_AUTO = 12;
 
 const char *modeMenuNames[] = {"Major", "Minor", "Fixed Ma", "Fixed Mi"};
 const int MODE_MENU_COUNT = 4;
@@ -56,13 +62,13 @@ int menuMutingIndex = 0; // 0=Disabled, 1=Enabled
 const char *synthSndMenuNames[] = {"Sine", "Organ", "Rhodes", "Strings"};
 const int SYNTHSND_MENU_COUNT = 4;
 
-// Arpeggiator options
-const char *arpMenuNames[] = {"Arp", "Poly"};
-const int ARP_MENU_COUNT = 2;
+// Arpeggiator options, indexed by ARP_MODE_* (Arp and Poly keep 0 and 1)
+const char *arpMenuNames[] = {"Arp Up", "Poly", "Arp Down", "Arp UpDn", "Arp Rand", "Stab"};
+const int ARP_MENU_COUNT = ARP_MODE_COUNT;
 
 // Config submenu options
-const char *configMenuNames[] = {"Bass/Gtr", "Muting", "Output", "StopMode"};
-const int CONFIG_MENU_COUNT = 4;
+const char *configMenuNames[] = {"Bass/Gtr", "Muting", "Output", "StopMode", "Glide", "Pitch", "Diagnost"};
+const int CONFIG_MENU_COUNT = 7;
 
 // Output options
 const char *outputMenuNames[] = {"Mix", "Split"};
@@ -73,6 +79,16 @@ const char *stopModeMenuNames[] = {"Fade", "Immediate"};
 const int STOPMODE_MENU_COUNT = 2;
 int menuStopModeIndex = 0; // 0=Fade, 1=Immediate
 
+// Glide options, indexed like glideTimesMs (audio.cpp)
+const char *glideMenuNames[] = {"Off", "15ms", "30ms", "60ms", "120ms", "250ms"};
+const int GLIDE_MENU_COUNT = GLIDE_TIME_COUNT;
+int menuGlideIndex = 0; // 0=Off
+
+// Pitch mode options (PITCH_MODE_* in config.h)
+const char *pitchModeMenuNames[] = {"Quantize", "Follow"};
+const int PITCHMODE_MENU_COUNT = PITCH_MODE_COUNT;
+int menuPitchModeIndex = 0; // 0=Quantized, 1=Follow
+
 void handleMenuEncoder(int delta)
 {
     if (currentMenuLevel == MENU_TOP)
@@ -163,6 +179,22 @@ void handleMenuEncoder(int delta)
         if (menuStopModeIndex > STOPMODE_MENU_COUNT)
             menuStopModeIndex = STOPMODE_MENU_COUNT; // allow Parent
     }
+    else if (currentMenuLevel == MENU_GLIDE_SELECT)
+    {
+        menuGlideIndex += delta;
+        if (menuGlideIndex < 0)
+            menuGlideIndex = 0;
+        if (menuGlideIndex > GLIDE_MENU_COUNT)
+            menuGlideIndex = GLIDE_MENU_COUNT; // allow Parent
+    }
+    else if (currentMenuLevel == MENU_PITCHMODE_SELECT)
+    {
+        menuPitchModeIndex += delta;
+        if (menuPitchModeIndex < 0)
+            menuPitchModeIndex = 0;
+        if (menuPitchModeIndex > PITCHMODE_MENU_COUNT)
+            menuPitchModeIndex = PITCHMODE_MENU_COUNT; // allow Parent
+    }
 }
 
 void handleMenuButton()
@@ -173,8 +205,9 @@ void handleMenuButton()
         if (menuTopIndex == 0) // Key
         {
             currentMenuLevel = MENU_KEY_SELECT;
-            // Initialize to current key
-            for (int i = 0; i < KEY_MENU_COUNT; i++)
+            // Initialize to current key (or Auto)
+            menuKeyIndex = KEY_MENU_AUTO;
+            for (int i = 0; i < KEY_MENU_AUTO && !currentKeyAuto; i++)
             {
                 if (keyMenuToChromatic[i] == currentKey)
                 {
@@ -211,7 +244,7 @@ void handleMenuButton()
         else if (menuTopIndex == 4) // Arp (was index 6)
         {
             currentMenuLevel = MENU_ARP_SELECT;
-            // Initialize to current arp mode (0=Arp, 1=Poly)
+            // Initialize to current arp mode (ARP_MODE_*)
             menuArpIndex = currentArpMode;
         }
         else if (menuTopIndex == 5) // Config (new)
@@ -227,8 +260,15 @@ void handleMenuButton()
         {
             currentMenuLevel = MENU_TOP;
         }
+        else if (menuKeyIndex == KEY_MENU_AUTO)
+        {
+            currentKeyAuto = true;
+            saveNVRAM();
+            currentMenuLevel = MENU_TOP;
+        }
         else
         {
+            currentKeyAuto = false;
             currentKey = keyMenuToChromatic[menuKeyIndex];
             saveNVRAM();
             currentMenuLevel = MENU_TOP;
@@ -356,6 +396,23 @@ void handleMenuButton()
             // Initialize to current stop mode setting (0=Fade,1=Immediate)
             menuStopModeIndex = currentStopMode;
         }
+        else if (menuConfigIndex == 4) // Glide
+        {
+            currentMenuLevel = MENU_GLIDE_SELECT;
+            // Initialize to current glide setting (0=Off)
+            menuGlideIndex = currentGlide;
+        }
+        else if (menuConfigIndex == 5) // Pitch mode
+        {
+            currentMenuLevel = MENU_PITCHMODE_SELECT;
+            // Initialize to current pitch mode (0=Quantized)
+            menuPitchModeIndex = currentPitchMode;
+        }
+        else if (menuConfigIndex == 6) // Diagnostics
+        {
+            // Live audio resource page; any encoder input returns to Config
+            currentScreen = SCREEN_DIAGNOSTICS;
+        }
     }
     else if (currentMenuLevel == MENU_OUTPUT_SELECT)
     {
@@ -395,4 +452,36 @@ void handleMenuButton()
             currentMenuLevel = MENU_CONFIG_SELECT;
         }
     }
+    else if (currentMenuLevel == MENU_GLIDE_SELECT)
+    {
+        // If Parent selected, return to Config. Otherwise apply glide time.
+        if (menuGlideIndex == GLIDE_MENU_COUNT)
+        {
+            currentMenuLevel = MENU_CONFIG_SELECT;
+        }
+        else
+        {
+            currentGlide = menuGlideIndex;
+            applyGlide();
+            saveNVRAM();
+            currentMenuLevel = MENU_CONFIG_SELECT;
+        }
+    }
+    else if (currentMenuLevel == MENU_PITCHMODE_SELECT)
+    {
+        // If Parent selected, return to Config. Otherwise apply pitch mode.
+        if (menuPitchModeIndex == PITCHMODE_MENU_COUNT)
+        {
+            currentMenuLevel = MENU_CONFIG_SELECT;
+        }
+        else
+        {
+            currentPitchMode = menuPitchModeIndex;
+            // Start over from the next pitch; drop any Follow bend
+            resetChordPitch();
+            chordSynth.bend(0.0f);
+            saveNVRAM();
+            currentMenuLevel = MENU_CONFIG_SELECT;
+        }
+    }
 }
@@ -16,7 +16,9 @@ enum MenuLevel
     MENU_ARP_SELECT,
     MENU_CONFIG_SELECT,
     MENU_OUTPUT_SELECT,
-    MENU_STOPMODE_SELECT
+    MENU_STOPMODE_SELECT,
+    MENU_GLIDE_SELECT,
+    MENU_PITCHMODE_SELECT
 };
 
 extern MenuLevel currentMenuLevel;
@@ -31,6 +33,8 @@ extern int menuArpIndex;
 extern int menuConfigIndex;
 extern int menuOutputIndex;
 extern int menuStopModeIndex;
+extern int menuGlideIndex;
+extern int menuPitchModeIndex;
 
 // Viewport tracking for scrolling submenus
 extern int keyViewportStart;
@@ -44,6 +48,8 @@ extern int arpViewportStart;
 extern int configViewportStart;
 extern int outputViewportStart;
 extern int stopModeViewportStart;
+extern int glideViewportStart;
+extern int pitchModeViewportStart;
 
 // Menu display names
 extern const char *menuTopItems[];
@@ -51,6 +57,7 @@ extern const int MENU_TOP_COUNT;
 extern const char *keyMenuNames[];
 extern const int KEY_MENU_COUNT;
 extern const int keyMenuToChromatic[];
+extern const int KEY_MENU_AUTO;
 extern const char *modeMenuNames[];
 extern const int MODE_MENU_COUNT;
 extern const char *bassGuitMenuNames[];
@@ -70,6 +77,10 @@ extern const char *outputMenuNames[];
 extern const int OUTPUT_MENU_COUNT;
 extern const char *stopModeMenuNames[];
 extern const int STOPMODE_MENU_COUNT;
+extern const char *glideMenuNames[];
+extern const int GLIDE_MENU_COUNT;
+extern const char *pitchModeMenuNames[];
+extern const int PITCHMODE_MENU_COUNT;
 
 extern bool currentInstrumentIsBass;
 
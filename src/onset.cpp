@@ -0,0 +1,85 @@
+#include "onset.h"
+
+// Envelope time constants
+#define ONSET_FAST_MS 2.0f
+#define ONSET_SLOW_MS 60.0f
+
+void AudioAnalyzeOnset::begin(float r, float fl, uint16_t refractoryMs)
+{
+    const float fs = AUDIO_SAMPLE_RATE_EXACT;
+    __disable_irq();
+    fastCoef = 1.0f - expf(-1000.0f / (fs * ONSET_FAST_MS));
+    slowCoef = 1.0f - expf(-1000.0f / (fs * ONSET_SLOW_MS));
+    ratio = r;
+    noiseFloor = fl * 32768.0f;
+    refractorySamples = (uint32_t)(refractoryMs * fs / 1000.0f);
+    sinceOnset = refractorySamples;
+    newOutput = false;
+    __enable_irq();
+}
+
+bool AudioAnalyzeOnset::available()
+{
+    __disable_irq();
+    bool flag = newOutput;
+    if (flag)
+        newOutput = false;
+    __enable_irq();
+    return flag;
+}
+
+uint32_t AudioAnalyzeOnset::read()
+{
+    __disable_irq();
+    uint32_t t = onsetMicros;
+    __enable_irq();
+    return t;
+}
+
+uint32_t AudioAnalyzeOnset::count()
+{
+    __disable_irq();
+    uint32_t n = onsetCount;
+    __enable_irq();
+    return n;
+}
+
+void AudioAnalyzeOnset::update(void)
+{
+    audio_block_t *block = receiveReadOnly();
+    if (!block)
+        return;
+
+    // This block ends now; time of sample i is blockEnd - (N - i) periods
+    uint32_t blockEnd = micros();
+    int onsetIndex = -1;
+
+    float fe = fastEnv;
+    float se = slowEnv;
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+    {
+        float x = fabsf((float)block->data[i]);
+        fe += fastCoef * (x - fe);
+        se += slowCoef * (x - se);
+        if (sinceOnset < refractorySamples)
+        {
+            sinceOnset++;
+        }
+        else if (fe > noiseFloor && fe > ratio * se)
+        {
+            onsetIndex = i;
+            sinceOnset = 0;
+        }
+    }
+    fastEnv = fe;
+    slowEnv = se;
+    release(block);
+
+    if (onsetIndex >= 0)
+    {
+        uint32_t ago = (uint32_t)((AUDIO_BLOCK_SAMPLES - onsetIndex) * 1000000.0f / AUDIO_SAMPLE_RATE_EXACT);
+        onsetMicros = blockEnd - ago;
+        onsetCount++;
+        newOutput = true;
+    }
+}
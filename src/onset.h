@@ -0,0 +1,50 @@
+#ifndef ONSET_H
+#define ONSET_H
+
+#include <Arduino.h>
+#include <Audio.h>
+
+// Audio-rate onset (attack) detector.
+// Follows the rectified input with a fast and a slow envelope; an attack is
+// reported when the fast envelope rises above the slow one by a given ratio
+// and over a noise floor. A refractory period stops one pluck from
+// triggering several times. Each attack is timestamped to the sample.
+class AudioAnalyzeOnset : public AudioStream
+{
+public:
+    AudioAnalyzeOnset() : AudioStream(1, inputQueueArray) {}
+
+    // ratio: fast/slow envelope ratio that counts as an attack
+    // noiseFloor: minimum fast envelope (0.0-1.0 of full scale)
+    // refractoryMs: minimum time between attacks
+    void begin(float ratio, float noiseFloor, uint16_t refractoryMs);
+
+    // True once per detected attack
+    bool available();
+    // True while an attack is waiting to be read (does not clear it)
+    bool pending() const { return newOutput; }
+    // micros() timestamp of the most recent attack
+    uint32_t read();
+    // Total attacks since begin()
+    uint32_t count();
+
+    virtual void update(void);
+
+private:
+    audio_block_t *inputQueueArray[1];
+
+    float fastCoef = 0.0f;
+    float slowCoef = 0.0f;
+    float fastEnv = 0.0f;
+    float slowEnv = 0.0f;
+    float ratio = 2.0f;
+    float noiseFloor = 0.01f * 32768.0f;
+    uint32_t refractorySamples = 0;
+    uint32_t sinceOnset = 0;
+
+    volatile bool newOutput = false;
+    uint32_t onsetMicros = 0;
+    uint32_t onsetCount = 0;
+};
+
+#endif // ONSET_H
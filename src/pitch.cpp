@@ -2,20 +2,39 @@
 #include "NVRAM.h"
 #include "audio.h"
 #include "config.h"
+#include "tracker.h"
+#include "key.h"
 
-// Pitch detection object
-AudioAnalyzeNoteFrequency noteDetect;
+// Pitch detection object (incremental YIN, see yin.h)
+AudioAnalyzeYin noteDetect;
+AudioAnalyzeOnset onsetDetect;
 
 // keep track of last detected tonic frequency
 float lastDetectedFrequency = 0.0f;
-
-// Static state for pitch detection
-static float sampledFrequency = 0.0f; // frequency sampled while FS1 held
-static float freqBuf[3] = {0, 0, 0};  // median filter buffer
-static int freqBufIdx = 0;
-
-// add near top of file (file-scope)
-AudioConnection *patchPitchPtr = nullptr;
+float lastFineFrequency = 0.0f;
+
+// Pitch tracker (smoothing strategy selected by PITCH_TRACKER in config.h)
+#if PITCH_TRACKER == PITCH_TRACKER_MEDIAN
+static PitchTracker<MedianFilter<PITCH_MEDIAN_LENGTH>> tracker;
+#elif PITCH_TRACKER == PITCH_TRACKER_ONEPOLE
+static PitchTracker<LogOnePoleFilter> tracker;
+#else
+static PitchTracker<KalmanCentsFilter> tracker;
+#endif
+
+static int configuredInstrument = -1; // -1 = not yet configured, 0 = Guitar, 1 = Bass
+
+// Attack handling: after an onset (or reset) the tracker waits for the first
+// stable period before it accepts estimates again
+static bool awaitingLock = false;
+static float lockCandidateCents = 0.0f;
+static int lockCount = 0;
+static bool justLocked = false;
+static unsigned long onsetMicros = 0;
+
+// Queued estimates discarded because a newer attack made them stale
+static uint32_t supersededCount = 0;
+static uint32_t lastResultBlock = 0;
 
 void setupPitchDetection()
 {
@@ -25,130 +44,201 @@ void setupPitchDetection()
     Serial.print("Pitch detector initialized with threshold ");
     Serial.println(NOTE_DETECT_THRESHOLD);
 
-    // create the connection at runtime so initialization order is safe
-    if (!patchPitchPtr)
+    onsetDetect.begin(ONSET_RATIO, ONSET_FLOOR, ONSET_REFRACTORY_MS);
+}
+
+// Select detection range, analysis window and tracker tuning for the current
+// instrument. Bass needs a longer window to see several periods of a low E,
+// so its input is low-passed and decimated first to keep the lag search cheap.
+static void configurePitchForInstrument(bool isBass)
+{
+    if (isBass)
+    {
+        noteDetect.configure(PITCH_MIN_FREQ_BASS, PITCH_MAX_FREQ_BASS, PITCH_WINDOW_BASS, PITCH_BASS_DECIMATION);
+        tracker.configure(bassTuning);
+    }
+    else
     {
-        // audioInput is declared in audio.h as extern; include audio.h if needed
-        patchPitchPtr = new AudioConnection(audioInput, 0, noteDetect, 0);
-        Serial.println("patchPitch connection created");
+        noteDetect.configure(PITCH_MIN_FREQ_GUITAR, PITCH_MAX_FREQ, PITCH_WINDOW_GUITAR);
+        tracker.configure(guitarTuning);
     }
+    configuredInstrument = isBass ? 1 : 0;
+    Serial.print("Pitch detector configured for ");
+    Serial.println(isBass ? "Bass" : "Guitar");
+}
+
+// Called for each raw estimate while waiting for a lock. Locks on a single
+// confident estimate, or on PITCH_LOCK_COUNT estimates that agree.
+static bool checkPitchLock(float frequency, float probability)
+{
+    if (frequency <= 0.0f)
+        return false;
+    float cents = hzToCents(frequency);
+    if (lockCount > 0 && fabsf(cents - lockCandidateCents) < PITCH_LOCK_CENTS)
+    {
+        lockCount++;
+    }
+    else
+    {
+        lockCandidateCents = cents;
+        lockCount = 1;
+    }
+    return (probability >= PITCH_LOCK_PROBABILITY || lockCount >= PITCH_LOCK_COUNT);
 }
 
 void updatePitchDetection(float &frequency, float &probability, const char *&noteName, bool currentInstrumentIsBass)
 {
     static unsigned long lastDebugMs = 0;
-    static int availableCount = 0;
-    static int notAvailableCount = 0;
-    float lowMedianFreq = 50.0f;
+    static int resultCount = 0;
+    static uint32_t maxAgeBlocks = 0;
 
     frequency = 0.0;
     probability = 0.0;
     noteName = "---";
+    justLocked = false;
 
-    if (noteDetect.available())
+    // Reconfigure the detector when the Bass/Gtr setting changes
+    if (configuredInstrument != (currentInstrumentIsBass ? 1 : 0))
     {
-        availableCount++;
-        frequency = noteDetect.read();
-        probability = noteDetect.probability();
+        configurePitchForInstrument(currentInstrumentIsBass);
+    }
 
-        // Debug: log raw readings periodically
-        unsigned long now = millis();
-        if (now - lastDebugMs > 2000)
-        {
-            Serial.print("Pitch detect - available: ");
-            Serial.print(availableCount);
-            Serial.print(", not available: ");
-            Serial.print(notAvailableCount);
-            Serial.print(", last freq: ");
-            Serial.print(frequency);
-            Serial.print(" Hz, prob: ");
-            Serial.println(probability);
-            lastDebugMs = now;
-            availableCount = 0;
-            notAvailableCount = 0;
-        }
+    // A new attack: forget the previous note and wait for a stable period
+    if (onsetDetect.available())
+    {
+        onsetMicros = onsetDetect.read();
+        tracker.reset();
+        lastFineFrequency = 0.0f;
+        awaitingLock = true;
+        lockCount = 0;
+    }
 
-        // Add raw frequency to median filter buffer
-        freqBuf[freqBufIdx] = frequency;
-        freqBufIdx = (freqBufIdx + 1) % 3;
-
-        // Copy and sort for median calculation
-        float sorted[3];
-        memcpy(sorted, freqBuf, sizeof(sorted));
-        for (int i = 0; i < 3; i++)
-            for (int j = i + 1; j < 3; j++)
-                if (sorted[j] < sorted[i])
-                {
-                    float temp = sorted[i];
-                    sorted[i] = sorted[j];
-                    sorted[j] = temp;
-                }
-
-        float medianFreq = sorted[1]; // middle value after sorting (index 1 of 3 elements)
-
-        // Use probability as a smoothing weight (rather than gating on a threshold).
-        // Normalize the new median into the same octave range as `sampledFrequency`
-        if (currentInstrumentIsBass)
+    // Consume every queued estimate in order
+    PitchResult result;
+    bool gotResult = false;
+    while (noteDetect.readResult(result))
+    {
+        // Made before the latest attack (or reset): it describes the old note
+        if ((int32_t)(result.micros - onsetMicros) < 0)
         {
-            lowMedianFreq = 25.0f;
+            supersededCount++;
+            continue;
         }
-        else
+
+        gotResult = true;
+        resultCount++;
+        lastResultBlock = result.block;
+        uint32_t age = noteDetect.blockCount() - result.block;
+        if (age > maxAgeBlocks)
+            maxAgeBlocks = age;
+
+        frequency = result.frequency;
+        probability = result.probability;
+
+        if (awaitingLock && checkPitchLock(frequency, probability))
         {
-            lowMedianFreq = 50.0f;
+            awaitingLock = false;
+            justLocked = true;
         }
 
-        if (medianFreq > lowMedianFreq && medianFreq < 2000.0)
+        // Octave correction, smoothing and register folding
+        if (!awaitingLock && tracker.update(frequency, probability))
         {
-            float newNorm = medianFreq;
-            if (newNorm < 200.0f)
-                newNorm = newNorm * 2.0f;
-            else if (newNorm > 950.0f)
-                newNorm = newNorm / 2.0f;
-            if (sampledFrequency <= 0.0f)
-            {
-                // First valid sample: initialize without smoothing
-                sampledFrequency = newNorm;
-            }
-            else
-            {
-                // Smooth using probability as weight: higher probability -> more trust in new value
-                float smoothed = probability * newNorm + (1.0f - probability) * sampledFrequency;
-                sampledFrequency = smoothed;
-            }
-
             // Update last detected frequency for external use
-            lastDetectedFrequency = sampledFrequency;
-        }
+            lastDetectedFrequency = tracker.frequency();
 
-        // Simple note name lookup (A4 = 440 Hz)
-        if (sampledFrequency > 0.0f)
-        {
-            // Calculate note from frequency: n = 12 * log2(f/440) + 69 (MIDI note number)
-            float n = 12.0 * log2f(sampledFrequency / 440.0) + 69.0;
-            int noteNum = (int)(n + 0.5) % 12;
-            if (noteNum < 0)
-                noteNum += 12;
-            const char *noteNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
-            noteName = noteNames[noteNum];
+            // Feed the background key estimator
+            keyAddPitch(tracker.cents(), probability, millis());
         }
     }
-    else
+
+    // Fine estimate: the detector may sit on another octave than the
+    // tracker (which corrects and folds it), so only its distance from the
+    // track within an octave is used
+    PitchResult fine;
+    if (noteDetect.readFine(fine) && (int32_t)(fine.micros - onsetMicros) >= 0 &&
+        !awaitingLock && tracker.valid())
     {
-        notAvailableCount++;
+        float dev = hzToCents(fine.frequency) - tracker.cents();
+        dev -= 1200.0f * roundf(dev / 1200.0f);
+        if (fabsf(dev) <= PITCH_FINE_MAX_CENTS)
+            lastFineFrequency = lastDetectedFrequency * exp2f(dev / 1200.0f);
+    }
+
+    // Debug: log raw readings periodically
+    unsigned long now = millis();
+    if (gotResult && now - lastDebugMs > 2000)
+    {
+        Serial.print("Pitch detect - results: ");
+        Serial.print(resultCount);
+        Serial.print(", dropped: ");
+        Serial.print(noteDetect.droppedCount());
+        Serial.print(", superseded: ");
+        Serial.print(supersededCount);
+        Serial.print(", max age: ");
+        Serial.print(maxAgeBlocks);
+        Serial.print(" blocks, last freq: ");
+        Serial.print(frequency);
+        Serial.print(" Hz, prob: ");
+        Serial.print(probability);
+        Serial.print(", cpu max: ");
+        Serial.print(noteDetect.processorUsageMax());
+        Serial.println("%");
+        noteDetect.processorUsageMaxReset();
+        lastDebugMs = now;
+        resultCount = 0;
+        maxAgeBlocks = 0;
+    }
+
+    // Simple note name lookup (tracker works in cents: MIDI note * 100)
+    if (gotResult && tracker.valid())
+    {
+        float n = tracker.cents() / 100.0f;
+        int noteNum = (int)(n + 0.5) % 12;
+        if (noteNum < 0)
+            noteNum += 12;
+        const char *noteNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+        noteName = noteNames[noteNum];
     }
 }
 
 void resetPitchDetection()
 {
-    // Clear median filter buffer
-    for (int i = 0; i < 3; i++)
-    {
-        freqBuf[i] = 0.0f;
-    }
-    freqBufIdx = 0;
+    // Clear tracker state (smoothing, octave history, register fold) and
+    // treat the reset like an attack
+    tracker.reset();
+    awaitingLock = true;
+    lockCount = 0;
+    onsetMicros = micros();
 
     // Reset last detected frequency so chord doesn't use stale data
     lastDetectedFrequency = 0.0f;
+    lastFineFrequency = 0.0f;
 
     Serial.println("Pitch detection reset");
 }
+
+bool pitchDataReady()
+{
+    return noteDetect.pending() || noteDetect.finePending() || onsetDetect.pending();
+}
+
+bool pitchJustLocked()
+{
+    return justLocked;
+}
+
+unsigned long pitchOnsetMicros()
+{
+    return onsetMicros;
+}
+
+uint32_t pitchResultBlock()
+{
+    return lastResultBlock;
+}
+
+uint32_t pitchDroppedCount()
+{
+    return noteDetect.droppedCount() + supersededCount;
+}
@@ -3,17 +3,38 @@
 
 #include <Arduino.h>
 #include <Audio.h>
+#include "yin.h"
+#include "onset.h"
 
 // Pitch detection object
-extern AudioAnalyzeNoteFrequency noteDetect;
+extern AudioAnalyzeYin noteDetect;
+// Attack detector (resets the tracker on each new note)
+extern AudioAnalyzeOnset onsetDetect;
 
 // Pitch tracking state
 extern float lastDetectedFrequency;
+// Detector's fine estimate in the tracked octave and register (Hz, 0 =
+// none). Updated every audio block, so it follows bends and vibrato that
+// the smoothed lastDetectedFrequency lags behind.
+extern float lastFineFrequency;
 
 void setupPitchDetection();
 void updatePitchDetection(float &frequency, float &probability, const char *&noteName, bool currentInstrumentIsBass);
+// True when the detector has queued estimates, a fine estimate or an
+// attack waiting
+bool pitchDataReady();
 
 // Reset pitch detection state (call when starting fresh sampling)
 void resetPitchDetection();
 
+// True during the update in which the tracker locked onto the first stable
+// pitch after an attack (or reset); pitchOnsetMicros() is that attack's time.
+bool pitchJustLocked();
+unsigned long pitchOnsetMicros();
+
+// Audio block index of the most recently consumed estimate
+uint32_t pitchResultBlock();
+// Estimates never used: dropped by a full queue or superseded by an attack
+uint32_t pitchDroppedCount();
+
 #endif // PITCH_H
@@ -0,0 +1,108 @@
+#include "pot.h"
+#include "config.h"
+#include "input.h"
+#include <math.h>
+
+static IntervalTimer potTimer;
+
+static int medianBuf[3];
+static int medianIdx = 0;
+static float filtered = -1.0f; // < 0 until the first sample
+static float filterAlpha = 0.0f;
+static volatile int potOutput = 0;
+static volatile int potRaw = 0;
+
+// Noise statistics for the current window
+static int noiseCount = 0;
+static int32_t rawSum = 0;
+static int64_t rawSumSq = 0;
+static int32_t outSum = 0;
+static int64_t outSumSq = 0;
+static volatile float rawNoiseResult = 0.0f;
+static volatile float outNoiseResult = 0.0f;
+static volatile bool noiseReady = false;
+
+static float stdDev(int32_t sum, int64_t sumSq, int n)
+{
+    float mean = (float)sum / (float)n;
+    float var = (float)sumSq / (float)n - mean * mean;
+    return (var > 0.0f) ? sqrtf(var) : 0.0f;
+}
+
+static int median3(int a, int b, int c)
+{
+    if (a > b)
+    {
+        int t = a;
+        a = b;
+        b = t;
+    }
+    if (b > c)
+        b = c;
+    return (a > b) ? a : b;
+}
+
+// Timer interrupt
+static void potSampleISR()
+{
+    int raw = analogRead(POT_PIN);
+    potRaw = raw;
+
+    medianBuf[medianIdx] = raw;
+    medianIdx = (medianIdx + 1) % 3;
+
+    if (filtered < 0.0f)
+    {
+        medianBuf[0] = medianBuf[1] = medianBuf[2] = raw;
+        filtered = (float)raw;
+        potOutput = raw;
+    }
+    int med = median3(medianBuf[0], medianBuf[1], medianBuf[2]);
+    filtered += filterAlpha * ((float)med - filtered);
+
+    if (fabsf(filtered - (float)potOutput) > POT_HYSTERESIS)
+        potOutput = (int)lrintf(filtered);
+
+    int out = potOutput;
+    rawSum += raw;
+    rawSumSq += (int64_t)raw * raw;
+    outSum += out;
+    outSumSq += (int64_t)out * out;
+    if (++noiseCount >= POT_NOISE_WINDOW)
+    {
+        rawNoiseResult = stdDev(rawSum, rawSumSq, noiseCount);
+        outNoiseResult = stdDev(outSum, outSumSq, noiseCount);
+        noiseReady = true;
+        noiseCount = 0;
+        rawSum = outSum = 0;
+        rawSumSq = outSumSq = 0;
+    }
+}
+
+void setupPot()
+{
+    // One-pole coefficient for a POT_FILTER_MS time constant
+    filterAlpha = 1.0f - expf(-1000.0f / (POT_FILTER_MS * (float)POT_SAMPLE_RATE_HZ));
+    potTimer.begin(potSampleISR, 1000000.0f / POT_SAMPLE_RATE_HZ);
+    Serial.println("Pot sampling started");
+}
+
+int potReading()
+{
+    return potOutput;
+}
+
+int potLastRaw()
+{
+    return potRaw;
+}
+
+bool potNoise(float &rawNoise, float &filteredNoise)
+{
+    __disable_irq();
+    rawNoise = rawNoiseResult;
+    filteredNoise = outNoiseResult;
+    bool ready = noiseReady;
+    __enable_irq();
+    return ready;
+}
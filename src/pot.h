@@ -0,0 +1,22 @@
+#ifndef POT_H
+#define POT_H
+
+#include <Arduino.h>
+
+// Background pot acquisition.
+// A timer interrupt samples the pot at POT_SAMPLE_RATE_HZ. Each sample goes
+// through a 3-point median (spike rejection) and a one-pole low-pass, and
+// the reported value only moves once the filtered value is more than
+// POT_HYSTERESIS counts away from it, so a resting pot reads steady.
+
+void setupPot();
+// Filtered pot position with hysteresis, 0-1023
+int potReading();
+// Most recent unfiltered ADC sample, 0-1023
+int potLastRaw();
+// Standard deviation (ADC counts) of the raw samples and of the reported
+// value over the last POT_NOISE_WINDOW samples. Returns false until the
+// first window has completed.
+bool potNoise(float &rawNoise, float &filteredNoise);
+
+#endif // POT_H
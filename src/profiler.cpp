@@ -0,0 +1,147 @@
+#include "profiler.h"
+
+#if PROFILER_ENABLED
+
+// Histogram: 4 bins per octave of ticks, enough for 32-bit durations
+#define PROFILER_SUBBINS 4
+#define PROFILER_BINS (32 * PROFILER_SUBBINS)
+
+struct StageProfile
+{
+    uint32_t count;
+    uint32_t minTicks;
+    uint32_t maxTicks;
+    uint64_t sumTicks;
+    uint32_t bins[PROFILER_BINS];
+};
+
+static StageProfile profiles[PROF_STAGE_COUNT];
+
+static const char *stageNames[PROF_STAGE_COUNT] = {
+    "pot", "volume", "fade", "vibrato", "decay", "arp", "footswitch", "pitch", "encoder", "render"};
+
+// Bin index: octave (position of the top bit) and the next two bits below it
+static int binFor(uint32_t ticks)
+{
+    if (ticks < PROFILER_SUBBINS)
+        return ticks;
+    int octave = 31 - __builtin_clz(ticks);
+    int sub = (ticks >> (octave - 2)) & (PROFILER_SUBBINS - 1);
+    return octave * PROFILER_SUBBINS + sub;
+}
+
+// Upper edge of a bin, in ticks
+static uint32_t binEdge(int bin)
+{
+    if (bin < PROFILER_SUBBINS)
+        return bin;
+    int octave = bin / PROFILER_SUBBINS;
+    int sub = bin % PROFILER_SUBBINS;
+    uint64_t edge = ((uint64_t)(PROFILER_SUBBINS + sub + 1) << (octave - 2)) - 1;
+    return edge > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)edge;
+}
+
+void profilerRecord(ProfileStage stage, uint32_t ticks)
+{
+    StageProfile &p = profiles[stage];
+    if (p.count == 0 || ticks < p.minTicks)
+        p.minTicks = ticks;
+    if (ticks > p.maxTicks)
+        p.maxTicks = ticks;
+    p.sumTicks += ticks;
+    p.count++;
+    p.bins[binFor(ticks)]++;
+}
+
+void profilerReset()
+{
+    memset(profiles, 0, sizeof(profiles));
+}
+
+// Percentile (0-100) from the histogram, clamped to the observed range
+static uint32_t percentile(const StageProfile &p, uint32_t pct)
+{
+    if (p.count == 0)
+        return 0;
+    uint64_t target = ((uint64_t)p.count * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < PROFILER_BINS; i++)
+    {
+        seen += p.bins[i];
+        if (seen >= target)
+        {
+            uint32_t v = binEdge(i);
+            if (v > p.maxTicks)
+                v = p.maxTicks;
+            if (v < p.minTicks)
+                v = p.minTicks;
+            return v;
+        }
+    }
+    return p.maxTicks;
+}
+
+void profilerDumpCsv()
+{
+    Serial.print("# profiler ticks_per_us=");
+    Serial.println(PROFILER_TICKS_PER_US);
+    Serial.println("stage,count,min,mean,p50,p90,p99,max");
+    for (int i = 0; i < PROF_STAGE_COUNT; i++)
+    {
+        const StageProfile &p = profiles[i];
+        uint32_t mean = p.count ? (uint32_t)(p.sumTicks / p.count) : 0;
+        char line[112];
+        snprintf(line, sizeof(line), "%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu", stageNames[i], (unsigned long)p.count,
+                 (unsigned long)p.minTicks, (unsigned long)mean, (unsigned long)percentile(p, 50),
+                 (unsigned long)percentile(p, 90), (unsigned long)percentile(p, 99), (unsigned long)p.maxTicks);
+        Serial.println(line);
+    }
+}
+
+// Binary record (little-endian):
+//   "PRF1", uint8 stage count, uint32 ticks per us,
+//   then per stage: count, min, mean, p50, p90, p99, max as uint32
+void profilerDumpBinary()
+{
+    uint8_t buf[9 + PROF_STAGE_COUNT * 7 * 4];
+    int n = 0;
+    auto put32 = [&](uint32_t v) {
+        buf[n++] = v & 0xFF;
+        buf[n++] = (v >> 8) & 0xFF;
+        buf[n++] = (v >> 16) & 0xFF;
+        buf[n++] = (v >> 24) & 0xFF;
+    };
+
+    memcpy(buf, "PRF1", 4);
+    n = 4;
+    buf[n++] = PROF_STAGE_COUNT;
+    put32(PROFILER_TICKS_PER_US);
+    for (int i = 0; i < PROF_STAGE_COUNT; i++)
+    {
+        const StageProfile &p = profiles[i];
+        put32(p.count);
+        put32(p.minTicks);
+        put32(p.count ? (uint32_t)(p.sumTicks / p.count) : 0);
+        put32(percentile(p, 50));
+        put32(percentile(p, 90));
+        put32(percentile(p, 99));
+        put32(p.maxTicks);
+    }
+    Serial.write(buf, n);
+}
+
+void profilerPollSerial()
+{
+    while (Serial.available() > 0)
+    {
+        int c = Serial.read();
+        if (c == 'c')
+            profilerDumpCsv();
+        else if (c == 'b')
+            profilerDumpBinary();
+        else if (c == 'r')
+            profilerReset();
+    }
+}
+
+#endif // PROFILER_ENABLED
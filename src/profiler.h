@@ -0,0 +1,72 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Per-stage profiler for the main loop tasks.
+// Wrap a stage in PROFILE_BEGIN(stage) / PROFILE_END(stage) in the same
+// scope. Each stage keeps count/min/max/mean and a log-scale histogram for
+// percentiles. Time is counted in DWT cycles on the Teensy and in
+// nanoseconds (std::chrono) elsewhere.
+//
+// Send 'c' over serial for a CSV dump, 'b' for a binary record, 'r' to
+// reset. With PROFILER_ENABLED 0 the macros expand to nothing and the
+// functions are empty inlines.
+
+enum ProfileStage
+{
+    PROF_POT,
+    PROF_VOLUME,
+    PROF_FADE,
+    PROF_VIBRATO,
+    PROF_DECAY,
+    PROF_ARP,
+    PROF_FOOTSWITCH,
+    PROF_PITCH,
+    PROF_ENCODER,
+    PROF_RENDER,
+    PROF_STAGE_COUNT
+};
+
+#if PROFILER_ENABLED
+
+#if defined(ARM_DWT_CYCCNT)
+static inline uint32_t profilerNow()
+{
+    return ARM_DWT_CYCCNT;
+}
+#define PROFILER_TICKS_PER_US (F_CPU_ACTUAL / 1000000)
+#else
+#include <chrono>
+static inline uint32_t profilerNow()
+{
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+#define PROFILER_TICKS_PER_US 1000
+#endif
+
+#define PROFILE_BEGIN(stage) uint32_t profileStart_##stage = profilerNow()
+#define PROFILE_END(stage) profilerRecord(stage, profilerNow() - profileStart_##stage)
+
+void profilerRecord(ProfileStage stage, uint32_t ticks);
+void profilerReset();
+void profilerDumpCsv();
+void profilerDumpBinary();
+// Handle single-character dump/reset commands from serial
+void profilerPollSerial();
+
+#else
+
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+
+static inline void profilerReset() {}
+static inline void profilerDumpCsv() {}
+static inline void profilerDumpBinary() {}
+static inline void profilerPollSerial() {}
+
+#endif // PROFILER_ENABLED
+
+#endif // PROFILER_H
@@ -0,0 +1,174 @@
+#include "reverb.h"
+#include "config.h"
+#include <math.h>
+
+// Tap level that counts as silence: REVERB_TAIL_DB below full scale
+static const int32_t silenceLevel = (int32_t)(32768.0f * powf(10.0f, -REVERB_TAIL_DB / 20.0f));
+
+static const uint16_t lineLength[REVERB_FDN_LINES] = {REVERB_FDN_LINE0, REVERB_FDN_LINE1,
+                                                     REVERB_FDN_LINE2, REVERB_FDN_LINE3};
+
+static inline int16_t saturate16(int32_t v)
+{
+    return (int16_t)constrain(v, (int32_t)-32768, (int32_t)32767);
+}
+
+AudioEffectReverbFDN::AudioEffectReverbFDN() : AudioStream(1, inputQueueArray)
+{
+    memset(lines, 0, sizeof(lines));
+    roomsize(0.5f);
+    damping(0.5f);
+}
+
+void AudioEffectReverbFDN::roomsize(float n)
+{
+    if (n < 0.0f)
+        n = 0.0f;
+    if (n > 1.0f)
+        n = 1.0f;
+    // Each line loses 60 dB over the decay time: g = 10^(-3 * length / (rate * T60))
+    float t60 = REVERB_FDN_T60_MIN + n * (REVERB_FDN_T60_MAX - REVERB_FDN_T60_MIN);
+    for (int k = 0; k < REVERB_FDN_LINES; k++)
+    {
+        float g = powf(10.0f, -3.0f * lineLength[k] / (AUDIO_SAMPLE_RATE_EXACT * t60));
+        feedback[k] = (int32_t)(g * 32768.0f + 0.5f);
+    }
+}
+
+void AudioEffectReverbFDN::damping(float n)
+{
+    if (n < 0.0f)
+        n = 0.0f;
+    if (n > 1.0f)
+        n = 1.0f;
+    // low-pass coefficient in the loop: 1.0 (open) down to 0.2
+    dampCoef = (int32_t)((1.0f - 0.8f * n) * 32768.0f + 0.5f);
+}
+
+void AudioEffectReverbFDN::update(void)
+{
+    audio_block_t *in = receiveReadOnly(0);
+    if (in && !enabled)
+    {
+        release(in);
+        in = NULL;
+    }
+    if (!in && idle)
+        return; // tail has decayed: nothing to do
+    idle = false;
+
+    audio_block_t *outL = allocate();
+    audio_block_t *outR = allocate();
+    if (!outL || !outR)
+    {
+        if (outL)
+            release(outL);
+        if (outR)
+            release(outR);
+        if (in)
+            release(in);
+        return;
+    }
+
+    int16_t *line[REVERB_FDN_LINES];
+    int32_t g[REVERB_FDN_LINES];
+    for (int k = 0, start = 0; k < REVERB_FDN_LINES; start += lineLength[k], k++)
+    {
+        line[k] = lines + start;
+        g[k] = feedback[k];
+    }
+    const int32_t damp = dampCoef;
+    int32_t peak = 0;
+
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+    {
+        int32_t o[REVERB_FDN_LINES];
+        for (int k = 0; k < REVERB_FDN_LINES; k++)
+            o[k] = line[k][pos[k]];
+
+        // 4x4 Hadamard mix; its 1/2 scale (which makes it lossless) is
+        // folded into the feedback multiply
+        int32_t a = o[0] + o[1], b = o[0] - o[1];
+        int32_t c = o[2] + o[3], d = o[2] - o[3];
+        int32_t h[REVERB_FDN_LINES] = {a + c, b + d, a - c, b - d};
+
+        int32_t x = in ? in->data[i] : 0;
+        // OR of the magnitudes: a cheap upper bound on the peak
+        peak |= abs(x) | abs(o[0]) | abs(o[1]) | abs(o[2]) | abs(o[3]);
+        x >>= 2; // headroom for the recirculating lines
+
+        for (int k = 0; k < REVERB_FDN_LINES; k++)
+        {
+            // rounded, not truncated: truncation biases the loop into a
+            // small limit cycle that would never decay to silence
+            lowpass[k] += (int32_t)(((int64_t)(h[k] - lowpass[k]) * damp + (1 << 14)) >> 15);
+            line[k][pos[k]] = saturate16((int32_t)(((int64_t)lowpass[k] * g[k] + (1 << 15)) >> 16) + x);
+            if (++pos[k] >= lineLength[k])
+                pos[k] = 0;
+        }
+
+        outL->data[i] = saturate16(o[0] + o[2]);
+        outR->data[i] = saturate16(o[1] + o[3]);
+    }
+    if (in)
+        release(in);
+
+    transmit(outL, 0);
+    transmit(outR, 1);
+    release(outL);
+    release(outR);
+
+    // Quiet for a whole pass of the longest line: every stored sample is
+    // below the threshold, so clear the lines and stop until input returns
+    quietSamples = (peak < silenceLevel) ? quietSamples + AUDIO_BLOCK_SAMPLES : 0;
+    if (quietSamples >= REVERB_FDN_LINE3)
+    {
+        memset(lines, 0, sizeof(lines));
+        for (int k = 0; k < REVERB_FDN_LINES; k++)
+            lowpass[k] = 0;
+        quietSamples = 0;
+        idle = true;
+    }
+}
+
+void AudioEffectReverbSend::update(void)
+{
+    audio_block_t *block = receiveReadOnly(0);
+    if (block && enabled)
+    {
+        quiet = 0;
+        transmit(block);
+    }
+    else if (quiet < 0xFFFFFFFF - AUDIO_BLOCK_SAMPLES)
+    {
+        quiet = quiet + AUDIO_BLOCK_SAMPLES;
+    }
+    if (block)
+        release(block);
+}
+
+// Freeverb's longest comb (with the stereo spread) and its allpass chain,
+// in samples at 44.1 kHz
+#define FREEVERB_COMB_SAMPLES (1617 + 23)
+#define FREEVERB_ALLPASS_SAMPLES (556 + 441 + 341 + 225 + 4 * 23)
+
+void AudioEffectFreeverbGated::roomsize(float n)
+{
+    if (n < 0.0f)
+        n = 0.0f;
+    if (n > 1.0f)
+        n = 1.0f;
+    AudioEffectFreeverb::roomsize(n);
+    // The library sets comb feedback to 0.7 + 0.28 * n; the slowest comb
+    // loses 20*log10(g) dB per pass. Damping only shortens the real tail.
+    float g = 0.7f + 0.28f * n;
+    float passes = (-REVERB_TAIL_DB / 20.0f) * logf(10.0f) / logf(g);
+    tailSamples = (uint32_t)(passes * FREEVERB_COMB_SAMPLES) + FREEVERB_ALLPASS_SAMPLES;
+}
+
+void AudioEffectFreeverbGated::update(void)
+{
+    if (bypassed())
+        return; // the send has been silent all tail long; nothing is queued
+    AudioEffectFreeverb::update();
+}
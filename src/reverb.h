@@ -0,0 +1,93 @@
+#ifndef REVERB_H
+#define REVERB_H
+
+#include <Arduino.h>
+#include <Audio.h>
+
+// Reverb engines. Both take a mono input, give stereo output and skip
+// their processing once the input has been silent long enough for the
+// tail to decay below REVERB_TAIL_DB, so an idle chord costs nothing.
+// Cutting an engine's input (enable(false) on the FDN or on Freeverb's
+// send) lets its tail ring out, so switching engines is seamless.
+
+// Lines of the feedback delay network, in samples (mutually prime)
+#define REVERB_FDN_LINES 4
+#define REVERB_FDN_LINE0 1021
+#define REVERB_FDN_LINE1 1327
+#define REVERB_FDN_LINE2 1597
+#define REVERB_FDN_LINE3 1871
+#define REVERB_FDN_SAMPLES (REVERB_FDN_LINE0 + REVERB_FDN_LINE1 + REVERB_FDN_LINE2 + REVERB_FDN_LINE3)
+
+// Four-line feedback delay network in 16-bit fixed point: the line
+// outputs are mixed by a Hadamard matrix, low-pass damped and fed back
+// with a per-line gain that gives the decay time set by roomsize().
+// About a quarter of Freeverb's work per sample.
+class AudioEffectReverbFDN : public AudioStream
+{
+public:
+    AudioEffectReverbFDN();
+
+    // Same ranges as AudioEffectFreeverb: 0.0 to 1.0. Room size sets the
+    // decay time (REVERB_FDN_T60_MIN to REVERB_FDN_T60_MAX seconds).
+    void roomsize(float n);
+    void damping(float n);
+    void enable(bool on) { enabled = on; }
+    // True while the tail has decayed and processing is skipped
+    bool bypassed() const { return idle; }
+
+    virtual void update(void);
+
+private:
+    audio_block_t *inputQueueArray[1];
+    int16_t lines[REVERB_FDN_SAMPLES];
+    uint16_t pos[REVERB_FDN_LINES] = {0, 0, 0, 0};
+    int32_t lowpass[REVERB_FDN_LINES] = {0, 0, 0, 0};
+    uint32_t quietSamples = 0;
+
+    // written by the main loop
+    volatile int32_t feedback[REVERB_FDN_LINES]; // Q15
+    volatile int32_t dampCoef = 32768;            // Q15, 1.0 = no damping
+    volatile bool enabled = true;
+    volatile bool idle = true;
+};
+
+// Reverb send: passes its input through and counts the samples since the
+// last block, so an engine that cannot inspect its own input (Freeverb)
+// knows when the input went silent. Disabling the send cuts the input.
+// Define it before the reverb so it updates first in each block period.
+class AudioEffectReverbSend : public AudioStream
+{
+public:
+    AudioEffectReverbSend() : AudioStream(1, inputQueueArray) {}
+
+    void enable(bool on) { enabled = on; }
+    uint32_t quietSamples() const { return quiet; }
+
+    virtual void update(void);
+
+private:
+    audio_block_t *inputQueueArray[1];
+    volatile bool enabled = true;
+    volatile uint32_t quiet = 0xFFFFFFFF; // silent since boot
+};
+
+// Freeverb that stops running once its send has been silent for the
+// estimated tail time. Its buffers are not visible, so the time is worked
+// out from the comb feedback that roomsize() sets.
+class AudioEffectFreeverbGated : public AudioEffectFreeverb
+{
+public:
+    AudioEffectFreeverbGated(const AudioEffectReverbSend &input) : send(input) { roomsize(0.5f); }
+
+    // Hides AudioEffectFreeverb::roomsize to keep the tail estimate in step
+    void roomsize(float n);
+    bool bypassed() const { return send.quietSamples() >= tailSamples; }
+
+    virtual void update(void);
+
+private:
+    const AudioEffectReverbSend &send;
+    volatile uint32_t tailSamples = 0;
+};
+
+#endif // REVERB_H
@@ -0,0 +1,127 @@
+#include "scheduler.h"
+
+struct Task
+{
+    const char *name;
+    TaskFunction fn;
+    TaskTrigger trigger; // null for periodic tasks
+    uint32_t periodUs;   // period, or deadline for triggered tasks
+    uint32_t nextDueUs;  // periodic: next start time
+    uint32_t lastCheckUs; // triggered: previous trigger check
+    TaskStats stats;
+};
+
+static Task tasks[SCHEDULER_MAX_TASKS];
+static int taskCount = 0;
+
+static uint32_t defaultClock()
+{
+    return micros();
+}
+
+static SchedulerClock clockFn = defaultClock;
+
+void schedulerSetClock(SchedulerClock clock)
+{
+    clockFn = clock ? clock : defaultClock;
+}
+
+static int addTask(const char *name, TaskFunction fn, TaskTrigger trigger, uint32_t periodUs)
+{
+    if (taskCount >= SCHEDULER_MAX_TASKS || !fn || periodUs == 0)
+        return -1;
+
+    uint32_t now = clockFn();
+    Task &t = tasks[taskCount];
+    t.name = name;
+    t.fn = fn;
+    t.trigger = trigger;
+    t.periodUs = periodUs;
+    t.nextDueUs = now + periodUs; // first run one period after registration
+    t.lastCheckUs = now;
+    t.stats = TaskStats{name, 0, 0, 0, 0};
+    return taskCount++;
+}
+
+int schedulerAddPeriodic(const char *name, TaskFunction fn, uint32_t periodUs)
+{
+    return addTask(name, fn, nullptr, periodUs);
+}
+
+int schedulerAddTriggered(const char *name, TaskFunction fn, TaskTrigger trigger, uint32_t deadlineUs)
+{
+    if (!trigger)
+        return -1;
+    return addTask(name, fn, trigger, deadlineUs);
+}
+
+static void runTask(Task &t, uint32_t start)
+{
+    t.fn();
+    uint32_t elapsed = clockFn() - start;
+    if (elapsed > t.stats.maxRunUs)
+        t.stats.maxRunUs = elapsed;
+    t.stats.runs++;
+}
+
+void schedulerRun()
+{
+    for (int i = 0; i < taskCount; i++)
+    {
+        Task &t = tasks[i];
+        uint32_t now = clockFn();
+
+        if (t.trigger)
+        {
+            uint32_t gap = now - t.lastCheckUs;
+            t.lastCheckUs = now;
+            if (gap > t.stats.maxJitterUs)
+                t.stats.maxJitterUs = gap;
+            if (gap > t.periodUs)
+                t.stats.overruns++;
+            if (t.trigger())
+                runTask(t, now);
+            continue;
+        }
+
+        int32_t late = (int32_t)(now - t.nextDueUs);
+        if (late < 0)
+            continue;
+
+        if ((uint32_t)late > t.stats.maxJitterUs)
+            t.stats.maxJitterUs = late;
+        if ((uint32_t)late >= t.periodUs)
+        {
+            // Missed one or more slots: count it and skip ahead rather than
+            // running a burst of catch-up calls
+            t.stats.overruns++;
+            t.nextDueUs += t.periodUs * ((uint32_t)late / t.periodUs);
+        }
+        t.nextDueUs += t.periodUs;
+        runTask(t, now);
+    }
+}
+
+void schedulerClear()
+{
+    taskCount = 0;
+}
+
+bool schedulerGetStats(int id, TaskStats &stats)
+{
+    if (id < 0 || id >= taskCount)
+        return false;
+    stats = tasks[id].stats;
+    return true;
+}
+
+void schedulerResetStats()
+{
+    for (int i = 0; i < taskCount; i++)
+    {
+        tasks[i].stats.runs = 0;
+        tasks[i].stats.overruns = 0;
+        tasks[i].stats.maxJitterUs = 0;
+        tasks[i].stats.maxRunUs = 0;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+// Lightweight cooperative scheduler.
+// Tasks are plain functions run to completion from loop(). A task is either
+// periodic (runs when its period has elapsed) or triggered (runs whenever
+// its trigger function returns true, checked on every pass).
+//
+// Statistics per task:
+// - periodic: jitter = how late a run started versus its due time;
+//   overrun = a run started a full period late (missed slots are skipped)
+// - triggered: jitter = gap between trigger checks (worst-case response);
+//   overrun = a gap longer than the task's period (its deadline)
+//
+// The clock is injectable so the core can run against a simulated clock.
+// Reporting is left to the caller (see schedulerGetStats()).
+
+#define SCHEDULER_MAX_TASKS 8
+
+typedef void (*TaskFunction)();
+typedef bool (*TaskTrigger)();
+typedef uint32_t (*SchedulerClock)();
+
+struct TaskStats
+{
+    const char *name;
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t maxJitterUs;
+    uint32_t maxRunUs;
+};
+
+// Clock in microseconds (defaults to micros())
+void schedulerSetClock(SchedulerClock clock);
+// Returns the task id, or -1 if the table is full
+int schedulerAddPeriodic(const char *name, TaskFunction fn, uint32_t periodUs);
+int schedulerAddTriggered(const char *name, TaskFunction fn, TaskTrigger trigger, uint32_t deadlineUs);
+// One pass over all tasks in the order they were added
+void schedulerRun();
+// Remove all tasks
+void schedulerClear();
+
+// Statistics of task id (ids run from 0 in the order tasks were added);
+// false past the last task
+bool schedulerGetStats(int id, TaskStats &stats);
+void schedulerResetStats();
+
+#endif // SCHEDULER_H
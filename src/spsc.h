@@ -0,0 +1,63 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <Arduino.h>
+
+// Lock-free single-producer/single-consumer queue.
+// The producer (typically an audio interrupt) only writes head and the
+// consumer (the main loop) only writes tail, so neither side has to
+// disable interrupts. head and tail are free-running counters; N must be
+// a power of two.
+//
+// On a single-core Cortex-M a compiler barrier is enough to make the slot
+// contents visible before the index that publishes them.
+template <class T, uint32_t N>
+class SpscQueue
+{
+    static_assert((N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    // Producer side. Returns false (and counts a drop) if the queue is full.
+    bool push(const T &item)
+    {
+        uint32_t h = head;
+        if (h - tail >= N)
+        {
+            dropped++;
+            return false;
+        }
+        slots[h & (N - 1)] = item;
+        __asm__ volatile("" ::: "memory");
+        head = h + 1;
+        return true;
+    }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool pop(T &item)
+    {
+        uint32_t t = tail;
+        if (t == head)
+            return false;
+        __asm__ volatile("" ::: "memory");
+        item = slots[t & (N - 1)];
+        __asm__ volatile("" ::: "memory");
+        tail = t + 1;
+        return true;
+    }
+
+    bool empty() const { return head == tail; }
+    uint32_t size() const { return head - tail; }
+    // Items rejected by push() because the consumer fell behind
+    uint32_t droppedCount() const { return dropped; }
+
+    // Consumer side: discard everything queued
+    void clear() { tail = head; }
+
+private:
+    T slots[N];
+    volatile uint32_t head = 0;
+    volatile uint32_t tail = 0;
+    volatile uint32_t dropped = 0;
+};
+
+#endif // SPSC_H
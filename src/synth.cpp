@@ -0,0 +1,507 @@
+#include "synth.h"
+
+// Envelope segment shapes, Q15 (0 to 32767), indexed by segment progress
+static int16_t envelopeShapes[2][257];
+
+static bool initEnvelopeShapes()
+{
+    const float k = 5.0f; // exponential segments reach ~99% at the end
+    const float norm = 1.0f / (1.0f - expf(-k));
+    for (int i = 0; i <= 256; i++)
+    {
+        float x = i / 256.0f;
+        envelopeShapes[ENV_LINEAR][i] = (int16_t)(x * 32767.0f + 0.5f);
+        envelopeShapes[ENV_EXPONENTIAL][i] = (int16_t)((1.0f - expf(-k * x)) * norm * 32767.0f + 0.5f);
+    }
+    return true;
+}
+
+// Filled during static initialization, before any envelope can render
+static const bool envelopeShapesReady = initEnvelopeShapes();
+
+static uint32_t msToSamples(float ms)
+{
+    if (ms <= 0.0f)
+        return 0;
+    return (uint32_t)(ms * (AUDIO_SAMPLE_RATE_EXACT / 1000.0f));
+}
+
+void SynthEnvelope::set(const EnvelopeSettings &settings)
+{
+    float sustain = settings.sustain;
+    if (sustain < 0.0f)
+        sustain = 0.0f;
+    else if (sustain > 1.0f)
+        sustain = 1.0f;
+    attackSamples = msToSamples(settings.attackMs);
+    decaySamples = msToSamples(settings.decayMs);
+    sustainLevel = (int32_t)(sustain * 65536.0f);
+    curve = (settings.curve == ENV_EXPONENTIAL) ? ENV_EXPONENTIAL : ENV_LINEAR;
+}
+
+void SynthEnvelope::noteOn()
+{
+    gate = true;
+    command = CMD_ON;
+}
+
+void SynthEnvelope::noteOff(float releaseMs)
+{
+    gate = false;
+    releaseSamples = msToSamples(releaseMs);
+    command = CMD_OFF;
+}
+
+// Segments start from the current level, so retriggering or releasing
+// mid-segment never jumps
+void SynthEnvelope::startSegment(uint8_t next, int32_t to, uint32_t samples)
+{
+    stage = next;
+    from = level;
+    target = to;
+    pos = 0;
+    remaining = samples;
+    inc = samples ? 0xFFFFFFFFu / samples : 0;
+}
+
+bool SynthEnvelope::render(int32_t *out)
+{
+    uint8_t cmd = command;
+    command = CMD_NONE;
+    if (cmd == CMD_ON)
+        startSegment(STAGE_ATTACK, 65536, attackSamples);
+    else if (cmd == CMD_OFF && stage != STAGE_IDLE)
+        startSegment(STAGE_RELEASE, 0, releaseSamples);
+
+    if (stage == STAGE_IDLE)
+        return false;
+
+    const int16_t *shape = envelopeShapes[curve];
+    int i = 0;
+    while (i < AUDIO_BLOCK_SAMPLES)
+    {
+        if (stage == STAGE_SUSTAIN || stage == STAGE_IDLE)
+        {
+            // flat: hold the level to the end of the block
+            for (; i < AUDIO_BLOCK_SAMPLES; i++)
+                out[i] = level;
+            break;
+        }
+
+        uint32_t n = AUDIO_BLOCK_SAMPLES - i;
+        if (remaining < n)
+            n = remaining;
+        const int32_t span = target - from;
+        for (uint32_t k = 0; k < n; k++, i++)
+        {
+            uint32_t idx = pos >> 24;
+            int32_t frac = (pos >> 9) & 0x7FFF;
+            int32_t a = shape[idx];
+            int32_t x = a + (((shape[idx + 1] - a) * frac) >> 15);
+            out[i] = from + ((span * x) >> 15);
+            pos += inc;
+        }
+        remaining -= n;
+        if (n)
+            level = out[i - 1];
+
+        if (remaining == 0)
+        {
+            // segment done: land exactly on the target and move on
+            level = target;
+            if (stage == STAGE_ATTACK)
+                startSegment(STAGE_DECAY, sustainLevel, decaySamples);
+            else if (stage == STAGE_DECAY)
+                stage = STAGE_SUSTAIN;
+            else
+                stage = STAGE_IDLE;
+        }
+    }
+    return true;
+}
+
+AudioSynthChord::AudioSynthChord() : AudioStream(0, NULL)
+{
+    float blockMs = AUDIO_BLOCK_SAMPLES * 1000.0f / AUDIO_SAMPLE_RATE_EXACT;
+    lfoCoef = (int32_t)((1.0f - expf(-blockMs / SYNTH_LFO_SMOOTH_MS)) * 65536.0f + 0.5f);
+    bendCoef = 1.0f - expf(-blockMs / SYNTH_BEND_SMOOTH_MS);
+}
+
+void AudioSynthChord::envelopeSettings(const EnvelopeSettings &settings)
+{
+    for (int v = 0; v < SYNTH_VOICES; v++)
+        envelope[v].set(settings);
+}
+
+void AudioSynthChord::noteOn()
+{
+    for (int v = 0; v < SYNTH_VOICES; v++)
+        envelope[v].noteOn();
+}
+
+void AudioSynthChord::noteOff(float releaseMs)
+{
+    for (int v = 0; v < SYNTH_VOICES; v++)
+        envelope[v].noteOff(releaseMs);
+}
+
+bool AudioSynthChord::active() const
+{
+    for (int v = 0; v < SYNTH_VOICES; v++)
+    {
+        if (envelope[v].active())
+            return true;
+    }
+    return false;
+}
+
+void SynthLfo::rate(float hz)
+{
+    if (hz < 0.0f)
+        hz = 0.0f;
+    else if (hz > 50.0f)
+        hz = 50.0f;
+    targetInc = (uint32_t)(hz * (4294967296.0f / AUDIO_SAMPLE_RATE_EXACT));
+}
+
+void SynthLfo::depth(float fraction)
+{
+    if (fraction < 0.0f)
+        fraction = 0.0f;
+    else if (fraction > 0.25f)
+        fraction = 0.25f;
+    targetDepth = (int32_t)(fraction * 16777216.0f);
+}
+
+void AudioSynthChord::vibrato(float hz, float depth)
+{
+    for (int v = 0; v < SYNTH_VOICES; v++)
+    {
+        lfo[v].rate(hz);
+        lfo[v].depth(depth);
+    }
+}
+
+void AudioSynthChord::glide(float ms, uint8_t mode)
+{
+    glideMs = (ms > 0.0f) ? ms : 0.0f;
+    glideModeSetting = (mode == GLIDE_RATE) ? GLIDE_RATE : GLIDE_TIME;
+}
+
+void AudioSynthChord::bend(float cents, bool snap)
+{
+    bendTarget = constrain(cents, -SYNTH_BEND_MAX_CENTS, SYNTH_BEND_MAX_CENTS);
+    if (snap)
+        bendSnapPending = true;
+}
+
+void SynthOscillator::begin(short waveform)
+{
+    switch (waveform)
+    {
+    case WAVEFORM_SAWTOOTH:
+    case WAVEFORM_SQUARE:
+    case WAVEFORM_BANDLIMIT_SAWTOOTH:
+    case WAVEFORM_BANDLIMIT_SQUARE:
+        wave = waveform;
+        break;
+    default:
+        wave = WAVEFORM_SINE;
+        break;
+    }
+}
+
+void SynthOscillator::frequency(float hz)
+{
+    if (hz < 0.0f)
+        hz = 0.0f;
+    else if (hz > AUDIO_SAMPLE_RATE_EXACT / 2.0f)
+        hz = AUDIO_SAMPLE_RATE_EXACT / 2.0f;
+    phaseInc = (uint32_t)(hz * (4294967296.0f / AUDIO_SAMPLE_RATE_EXACT));
+}
+
+void SynthOscillator::amplitude(float level)
+{
+    if (level < 0.0f)
+        level = 0.0f;
+    else if (level > 1.0f)
+        level = 1.0f;
+    magnitude = (int32_t)(level * 65536.0f);
+}
+
+void AudioSynthChord::arpTempo(float bpm, int stepsPerBeat)
+{
+    if (bpm < 1.0f)
+        bpm = 1.0f;
+    if (stepsPerBeat < 1)
+        stepsPerBeat = 1;
+    float samples = AUDIO_SAMPLE_RATE_EXACT * 60.0f / (bpm * stepsPerBeat);
+    arp.stepSamples((samples < 1.0f) ? 1 : (uint32_t)(samples + 0.5f));
+}
+
+// PolyBLEP residual (Q15) for a unit step at phase wrap. p is the phase
+// relative to the step; within one sample either side of it the naive
+// waveform is corrected by a two-sample polynomial, removing most of the
+// aliasing of the hard edge.
+static inline int32_t polyBlep(uint32_t p, uint32_t inc, float invInc)
+{
+    if (p < inc)
+    {
+        float x = 1.0f - (float)p * invInc; // just after the step
+        return -(int32_t)(x * x * 32768.0f);
+    }
+    uint32_t r = 0u - p; // distance to the next step
+    if (r <= inc)
+    {
+        float x = 1.0f - (float)r * invInc; // just before the step
+        return (int32_t)(x * x * 32768.0f);
+    }
+    return 0;
+}
+
+static inline int32_t clampSample(int32_t s)
+{
+    return s > 32767 ? 32767 : (s < -32768 ? -32768 : s);
+}
+
+// Add one oscillator's block to acc, scaled per sample by gain (Q16).
+// The phase increment moves by incStep per sample (pitch modulation).
+// Returns the advanced phase.
+static uint32_t renderOscillator(uint32_t ph, uint32_t inc, int32_t incStep, int32_t mag, uint8_t wave,
+                                 int32_t *acc, const int32_t *gain)
+{
+    // band-limiting needs a non-zero step; at 0 Hz the naive shape is exact
+    if (inc == 0 && wave == WAVEFORM_BANDLIMIT_SAWTOOTH)
+        wave = WAVEFORM_SAWTOOTH;
+    else if (inc == 0 && wave == WAVEFORM_BANDLIMIT_SQUARE)
+        wave = WAVEFORM_SQUARE;
+    // modulation moves inc by a few percent per block at most, so the
+    // block's starting inc serves for the PolyBLEP width
+    const float invInc = inc ? 1.0f / (float)inc : 0.0f;
+
+    switch (wave)
+    {
+    case WAVEFORM_SAWTOOTH:
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+        {
+            int32_t s = ((int32_t)(int16_t)(ph >> 16) * mag) >> 16;
+            acc[i] += (s * (gain[i] >> 1)) >> 15;
+            ph += inc;
+            inc += incStep;
+        }
+        break;
+    case WAVEFORM_BANDLIMIT_SAWTOOTH:
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+        {
+            // same waveform as above; its falling edge is at phase 0x80000000
+            uint32_t p = ph + 0x80000000u;
+            int32_t s = clampSample((int32_t)(p >> 16) - 32768 - polyBlep(p, inc, invInc));
+            s = (s * mag) >> 16;
+            acc[i] += (s * (gain[i] >> 1)) >> 15;
+            ph += inc;
+            inc += incStep;
+        }
+        break;
+    case WAVEFORM_SQUARE:
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+        {
+            int32_t s = (ph < 0x80000000u) ? (mag >> 1) : -(mag >> 1);
+            acc[i] += (s * (gain[i] >> 1)) >> 15;
+            ph += inc;
+            inc += incStep;
+        }
+        break;
+    case WAVEFORM_BANDLIMIT_SQUARE:
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+        {
+            // rising edge at phase 0, falling edge half a cycle later
+            int32_t s = (ph < 0x80000000u) ? 32767 : -32768;
+            s = clampSample(s + polyBlep(ph, inc, invInc) - polyBlep(ph + 0x80000000u, inc, invInc));
+            s = (s * mag) >> 16;
+            acc[i] += (s * (gain[i] >> 1)) >> 15;
+            ph += inc;
+            inc += incStep;
+        }
+        break;
+    default:
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+        {
+            // shared 257-entry sine table, linear interpolation
+            uint32_t idx = ph >> 24;
+            int32_t frac = (ph >> 8) & 0xFFFF;
+            int32_t v = AudioWaveformSine[idx] * (0x10000 - frac) + AudioWaveformSine[idx + 1] * frac;
+            int32_t s = (int32_t)(((int64_t)v * mag) >> 32);
+            acc[i] += (s * (gain[i] >> 1)) >> 15;
+            ph += inc;
+            inc += incStep;
+        }
+        break;
+    }
+    return ph;
+}
+
+// Advance a voice LFO by one block, gliding its rate and depth toward
+// their settings. Returns the pitch deviation (Q24) at the block's end.
+int32_t AudioSynthChord::lfoNext(SynthLfo &l)
+{
+    int32_t ti = (int32_t)(l.targetInc - l.inc);
+    int32_t step = (int32_t)(((int64_t)ti * lfoCoef) >> 16);
+    l.inc = (step == 0) ? l.targetInc : l.inc + step;
+    int32_t td = l.targetDepth - l.depthQ24;
+    step = (int32_t)(((int64_t)td * lfoCoef) >> 16);
+    l.depthQ24 = (step == 0) ? l.targetDepth : l.depthQ24 + step;
+
+    l.phase += l.inc * AUDIO_BLOCK_SAMPLES;
+    if (l.depthQ24 == 0)
+        return 0;
+    uint32_t idx = l.phase >> 24;
+    int32_t frac = (l.phase >> 8) & 0xFFFF;
+    int32_t v = AudioWaveformSine[idx] * (0x10000 - frac) + AudioWaveformSine[idx + 1] * frac;
+    return (int32_t)(((int64_t)(v >> 16) * l.depthQ24) >> 15);
+}
+
+// Follow a retuned voice and advance its glide by one block. Returns the
+// sounding pitch relative to the oscillator settings, in cents, at the
+// block's end (0 once the glide has arrived).
+float AudioSynthChord::glideNext(int v, bool snap)
+{
+    uint32_t target = osc[v * SYNTH_OSCS_PER_VOICE].phaseInc;
+    if (target != voiceInc[v])
+    {
+        float ms = glideMs;
+        if (snap || ms <= 0.0f || voiceInc[v] == 0 || target == 0)
+        {
+            glideCents[v] = 0.0f;
+        }
+        else
+        {
+            // start from wherever the voice is now, even mid-glide
+            float cents = glideCents[v] + 1200.0f * log2f((float)voiceInc[v] / (float)target);
+            cents = constrain(cents, -SYNTH_GLIDE_MAX_CENTS, SYNTH_GLIDE_MAX_CENTS);
+            if (glideModeSetting == GLIDE_RATE)
+                ms *= fabsf(cents) / 100.0f;
+            float blocks = ms * (AUDIO_SAMPLE_RATE_EXACT / 1000.0f) / AUDIO_BLOCK_SAMPLES;
+            glideCents[v] = cents;
+            glideStep[v] = fabsf(cents) / (blocks > 1.0f ? blocks : 1.0f);
+        }
+        voiceInc[v] = target;
+    }
+    else if (snap)
+    {
+        glideCents[v] = 0.0f;
+    }
+
+    float c = glideCents[v];
+    if (c > glideStep[v])
+        c -= glideStep[v];
+    else if (c < -glideStep[v])
+        c += glideStep[v];
+    else
+        c = 0.0f;
+    glideCents[v] = c;
+    return c;
+}
+
+// Pitch deviation (Q24) of 1 + mod multiplied by ratio
+static int32_t scaleMod(int32_t mod, float ratio)
+{
+    float x = ((1.0f + mod * (1.0f / 16777216.0f)) * ratio - 1.0f) * 16777216.0f;
+    return (int32_t)constrain(x, -16777216.0f, 2130706432.0f); // -1 to 127
+}
+
+// Phase increment scaled by 1 + mod (Q24)
+static inline uint32_t modulateInc(uint32_t inc, int32_t mod)
+{
+    return inc + (int32_t)(((int64_t)inc * mod) >> 24);
+}
+
+void AudioSynthChord::update(void)
+{
+    int32_t acc[AUDIO_BLOCK_SAMPLES];
+    int32_t gain[AUDIO_BLOCK_SAMPLES];
+    int32_t gates[SYNTH_VOICES][AUDIO_BLOCK_SAMPLES];
+    int32_t *const gateOut[SYNTH_VOICES] = {gates[0], gates[1], gates[2]};
+    uint8_t gateState[SYNTH_VOICES];
+    bool any = false;
+
+    updates++;
+    arp.render(gateOut, AUDIO_BLOCK_SAMPLES, gateState);
+    bool snap = glideSnapPending;
+    glideSnapPending = false;
+    float bendTo = bendTarget;
+    bendCents += (bendTo - bendCents) * bendCoef;
+    if (bendSnapPending || fabsf(bendTo - bendCents) < 0.01f)
+        bendCents = bendTo;
+    bendSnapPending = false;
+
+    for (int v = 0; v < SYNTH_VOICES; v++)
+    {
+        // Pitch modulation (glide and bend x LFO) ramps from last block's
+        // end value to this one's
+        int32_t modFrom = pitchMod[v];
+        int32_t modTo = lfoNext(lfo[v]);
+        uint32_t prevInc = voiceInc[v];
+        float cents = glideNext(v, snap) + bendCents;
+        if (cents != 0.0f)
+            modTo = scaleMod(modTo, exp2f(cents * (1.0f / 1200.0f)));
+        if (snap)
+            modFrom = modTo; // a snap jumps straight to the new pitch
+        else if (voiceInc[v] != prevInc && prevInc != 0 && voiceInc[v] != 0)
+            modFrom = scaleMod(modFrom, (float)prevInc / (float)voiceInc[v]); // same pitch, new reference
+        pitchMod[v] = modTo;
+
+        // Voice gain = envelope x arp gate; an idle envelope or a closed
+        // gate leaves the voice silent
+        bool voiceOn = envelope[v].render(gain) && gateState[v] != ARP_GATE_CLOSED;
+        if (voiceOn && gateState[v] == ARP_GATE_RAMPING)
+        {
+            const int32_t *g = gates[v];
+            for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+                gain[i] = ((gain[i] >> 1) * (g[i] >> 1)) >> 14;
+        }
+
+        for (int k = 0; k < SYNTH_OSCS_PER_VOICE; k++)
+        {
+            SynthOscillator &o = osc[v * SYNTH_OSCS_PER_VOICE + k];
+            uint32_t inc = o.phaseInc;
+            int32_t mag = o.magnitude;
+            int32_t incStep = 0;
+            if (modFrom != 0 || modTo != 0)
+            {
+                uint32_t incEnd = modulateInc(inc, modTo);
+                inc = modulateInc(inc, modFrom);
+                incStep = (int32_t)(incEnd - inc) / AUDIO_BLOCK_SAMPLES;
+            }
+
+            // Silent oscillators (zero amplitude, e.g. Sine companions, or a
+            // silent voice) only keep their phase running
+            if (!voiceOn || mag == 0)
+            {
+                o.phase += inc * AUDIO_BLOCK_SAMPLES +
+                           (uint32_t)incStep * (AUDIO_BLOCK_SAMPLES * (AUDIO_BLOCK_SAMPLES - 1) / 2);
+                continue;
+            }
+
+            if (!any)
+            {
+                memset(acc, 0, sizeof(acc));
+                any = true;
+            }
+            o.phase = renderOscillator(o.phase, inc, incStep, mag, o.wave, acc, gain);
+        }
+    }
+
+    if (!any)
+        return; // silence: transmit nothing
+
+    audio_block_t *block = allocate();
+    if (!block)
+        return;
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+    {
+        int32_t s = acc[i];
+        block->data[i] = (int16_t)(s > 32767 ? 32767 : (s < -32768 ? -32768 : s));
+    }
+    transmit(block);
+    release(block);
+}
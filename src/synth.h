@@ -0,0 +1,219 @@
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <Arduino.h>
+#include <Audio.h>
+#include "arp.h"
+
+// Chord voice engine: three voices (root, third, fifth) with a primary and
+// a detuned companion oscillator each, rendered into one audio block per
+// update. All oscillators share the library sine table and the same
+// phase-accumulator code, so a chord costs one object dispatch and one
+// output block instead of six oscillators plus mixers.
+#define SYNTH_VOICES 3
+#define SYNTH_OSCS_PER_VOICE 2
+#define SYNTH_OSCS (SYNTH_VOICES * SYNTH_OSCS_PER_VOICE)
+static_assert(SYNTH_VOICES == ARP_VOICES, "the arpeggiator gates every voice");
+
+// Envelope curves. Exponential segments move fast first and settle
+// slowly, like an RC charge/discharge.
+enum EnvelopeCurve
+{
+    ENV_LINEAR = 0,
+    ENV_EXPONENTIAL = 1
+};
+
+// Attack/decay/sustain of a sound; the release time is given per note-off
+// so fades, decays and mutes can share one envelope
+struct EnvelopeSettings
+{
+    float attackMs;
+    float decayMs;
+    float sustain; // 0.0 to 1.0
+    uint8_t curve; // EnvelopeCurve
+};
+
+// ADSR envelope rendered sample by sample inside the audio update. Each
+// segment walks a 257-entry shape table with a phase accumulator, so the
+// per-sample cost is one interpolated lookup whatever the curve.
+class SynthEnvelope
+{
+public:
+    void set(const EnvelopeSettings &settings);
+    void noteOn();
+    void noteOff(float releaseMs);
+    bool gated() const { return gate; }
+    bool active() const { return stage != STAGE_IDLE || command != CMD_NONE; }
+
+    // Audio interrupt only: fill one block of Q16 gain. Returns false (and
+    // leaves out untouched) when the envelope is idle, i.e. silent.
+    bool render(int32_t *out);
+
+private:
+    enum
+    {
+        STAGE_IDLE,
+        STAGE_ATTACK,
+        STAGE_DECAY,
+        STAGE_SUSTAIN,
+        STAGE_RELEASE
+    };
+    enum
+    {
+        CMD_NONE,
+        CMD_ON,
+        CMD_OFF
+    };
+    void startSegment(uint8_t next, int32_t to, uint32_t samples);
+
+    // written by the main loop, picked up at the next update
+    volatile uint32_t attackSamples = 0;
+    volatile uint32_t decaySamples = 0;
+    volatile uint32_t releaseSamples = 0;
+    volatile int32_t sustainLevel = 65536; // Q16
+    volatile uint8_t curve = ENV_LINEAR;
+    volatile uint8_t command = CMD_NONE;
+    bool gate = false;
+
+    // audio interrupt state
+    volatile uint8_t stage = STAGE_IDLE;
+    int32_t level = 0; // Q16
+    int32_t from = 0;
+    int32_t target = 0;
+    uint32_t pos = 0;
+    uint32_t inc = 0;
+    uint32_t remaining = 0;
+};
+
+// Time for LFO rate and depth changes to settle (one-pole time constant)
+#define SYNTH_LFO_SMOOTH_MS 50.0f
+
+// Sine pitch LFO of one voice (vibrato). The engine evaluates it once per
+// block and ramps the oscillators' phase increments across the block, so
+// the pitch moves every sample instead of in control-rate steps.
+class SynthLfo
+{
+public:
+    void rate(float hz);
+    // Peak frequency deviation as a fraction (0.015 = +/-1.5%), 0.0 to 0.25
+    void depth(float fraction);
+
+private:
+    friend class AudioSynthChord;
+    // written by the main loop; the audio interrupt glides toward them
+    volatile uint32_t targetInc = 0;
+    volatile int32_t targetDepth = 0; // Q24
+    uint32_t inc = 0;
+    int32_t depthQ24 = 0;
+    uint32_t phase = 0;
+};
+
+// Glide (portamento) timing
+enum GlideMode
+{
+    GLIDE_TIME = 0, // every pitch change takes the glide time
+    GLIDE_RATE = 1  // the glide time is per semitone (constant cents per ms)
+};
+
+// Largest glide handled, in cents; wider jumps start from this distance
+#define SYNTH_GLIDE_MAX_CENTS 4800.0f
+
+// Pitch bend range (cents either way) and smoothing time constant
+#define SYNTH_BEND_MAX_CENTS 1200.0f
+#define SYNTH_BEND_SMOOTH_MS 4.0f
+
+// One oscillator slot. Same controls as AudioSynthWaveform; supports
+// WAVEFORM_SINE, WAVEFORM_SAWTOOTH, WAVEFORM_SQUARE and the band-limited
+// (PolyBLEP) WAVEFORM_BANDLIMIT_SAWTOOTH and WAVEFORM_BANDLIMIT_SQUARE.
+// Anything else plays a sine.
+class SynthOscillator
+{
+public:
+    void begin(short waveform);
+    void frequency(float hz);
+    // 0.0 to 1.0 of full scale
+    void amplitude(float level);
+
+private:
+    friend class AudioSynthChord;
+    volatile uint32_t phaseInc = 0;
+    volatile int32_t magnitude = 0; // Q16
+    volatile uint8_t wave = WAVEFORM_SINE;
+    uint32_t phase = 0;
+};
+
+class AudioSynthChord : public AudioStream
+{
+public:
+    AudioSynthChord();
+
+    // osc[voice * SYNTH_OSCS_PER_VOICE + 0] = primary, + 1 = companion
+    SynthOscillator osc[SYNTH_OSCS];
+
+    // Per-voice amplitude envelopes; the calls below drive all three
+    SynthEnvelope envelope[SYNTH_VOICES];
+    void envelopeSettings(const EnvelopeSettings &settings);
+    void noteOn();
+    void noteOff(float releaseMs);
+    bool gated() const { return envelope[0].gated(); }
+    bool active() const;
+
+    // Per-voice pitch LFOs; vibrato() sets all three alike
+    SynthLfo lfo[SYNTH_VOICES];
+    void vibrato(float hz, float depth);
+
+    // Glide: when a voice's primary oscillator is retuned, the voice slides
+    // from the pitch it is sounding to the new one, linearly in cents.
+    // Retune a voice's oscillators together (inside AudioNoInterrupts) so
+    // the engine sees one change. ms <= 0 switches glide off.
+    void glide(float ms, uint8_t mode);
+    // Take the retuning done since the last update without gliding
+    void glideSnap() { glideSnapPending = true; }
+
+    // Bend all voices by the given cents. Applied on top of the oscillator
+    // settings (no glide) and smoothed, so it can follow a pitch estimate
+    // that arrives in steps. snap: jump there at the next update instead.
+    void bend(float cents, bool snap = false);
+
+    // Arpeggiator: a step sequencer (arp.h) run in the audio update that
+    // gates the voices, so steps land on exact sample positions. Settings
+    // are picked up at the next step; nothing needs restarting.
+    void arpeggiate(bool on) { arp.enable(on); }
+    void arpReset() { arp.reset(); } // restart the pattern at its first step
+    void arpPattern(uint8_t pattern) { arp.pattern(pattern); }
+    void arpTempo(float bpm, int stepsPerBeat);
+    void arpGate(float fraction) { arp.gate(fraction); } // part of each step a voice sounds (0.05 to 1.0)
+    void arpSwing(float amount) { arp.swing(amount); }   // lengthen even steps, shorten odd ones (0 to 0.75)
+    // Voice of the current step (0=root, 1=third, 2=fifth), -1 for all
+    int arpVoice() const { return arp.voice(); }
+
+    // Audio updates run so far (one per block period)
+    uint32_t blockCount() const { return updates; }
+
+    virtual void update(void);
+
+private:
+    int32_t lfoNext(SynthLfo &l);
+    float glideNext(int voice, bool snap);
+
+    // written by the main loop
+    volatile float glideMs = 0.0f;
+    volatile uint8_t glideModeSetting = GLIDE_TIME;
+    volatile bool glideSnapPending = false;
+    volatile float bendTarget = 0.0f;
+    volatile bool bendSnapPending = false;
+
+    volatile uint32_t updates = 0;
+
+    // audio interrupt state
+    int32_t lfoCoef = 65536;                      // Q16, per block
+    int32_t pitchMod[SYNTH_VOICES] = {0, 0, 0}; // Q24 deviation at the end of the last block
+    uint32_t voiceInc[SYNTH_VOICES] = {0, 0, 0}; // primary increment the glide heads for
+    float glideCents[SYNTH_VOICES] = {0.0f, 0.0f, 0.0f}; // sounding pitch relative to it
+    float glideStep[SYNTH_VOICES] = {0.0f, 0.0f, 0.0f};  // cents per block
+    float bendCents = 0.0f;
+    float bendCoef = 1.0f; // per block
+    ArpSequencer arp; // gates the voices
+};
+
+#endif // SYNTH_H
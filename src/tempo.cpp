@@ -0,0 +1,81 @@
+#include "tempo.h"
+#include "config.h"
+#include <math.h>
+
+static uint32_t intervals[TAP_TEMPO_AVERAGE];
+static int intervalCount = 0;
+static int intervalIdx = 0;
+static uint32_t lastTapUs = 0;
+static bool haveLastTap = false;
+static uint32_t outlierUs = 0; // held-back interval, 0 = none
+
+static void addInterval(uint32_t us)
+{
+    intervals[intervalIdx] = us;
+    intervalIdx = (intervalIdx + 1) % TAP_TEMPO_AVERAGE;
+    if (intervalCount < TAP_TEMPO_AVERAGE)
+        intervalCount++;
+}
+
+static float meanInterval()
+{
+    float sum = 0.0f;
+    for (int i = 0; i < intervalCount; i++)
+        sum += (float)intervals[i];
+    return sum / (float)intervalCount;
+}
+
+static bool near(float a, float b)
+{
+    return fabsf(a - b) <= TAP_TEMPO_OUTLIER * b;
+}
+
+void tapTempoReset()
+{
+    intervalCount = 0;
+    intervalIdx = 0;
+    haveLastTap = false;
+    outlierUs = 0;
+}
+
+bool tapTempoTap(uint32_t tapUs, float &bpm)
+{
+    if (!haveLastTap)
+    {
+        lastTapUs = tapUs;
+        haveLastTap = true;
+        return false;
+    }
+
+    uint32_t interval = tapUs - lastTapUs;
+    if (interval < TAP_TEMPO_MIN_INTERVAL_US)
+        return false; // too close to be a separate tap
+    lastTapUs = tapUs;
+
+    if (interval > TAP_TEMPO_MAX_INTERVAL_US)
+    {
+        // A pause: start a new sequence from this tap
+        intervalCount = 0;
+        intervalIdx = 0;
+        outlierUs = 0;
+        return false;
+    }
+
+    if (intervalCount > 0 && !near((float)interval, meanInterval()))
+    {
+        if (outlierUs == 0 || !near((float)interval, (float)outlierUs))
+        {
+            outlierUs = interval;
+            return false;
+        }
+        // Two agreeing outliers: the tempo really changed
+        intervalCount = 0;
+        intervalIdx = 0;
+        addInterval(outlierUs);
+    }
+    outlierUs = 0;
+    addInterval(interval);
+
+    bpm = 60000000.0f / meanInterval();
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef TEMPO_H
+#define TEMPO_H
+
+#include <Arduino.h>
+
+// Tap tempo estimation.
+// The tempo is the mean of the last TAP_TEMPO_AVERAGE tap intervals. An
+// interval more than TAP_TEMPO_OUTLIER (fraction) away from that mean is
+// held back as an outlier: it is dropped unless the next interval agrees
+// with it, in which case the player changed tempo and the average restarts
+// from those two intervals.
+
+// Forget all taps
+void tapTempoReset();
+// Feed one tap (micros() timestamp). Returns true with bpm set when the
+// tap produced a tempo estimate.
+bool tapTempoTap(uint32_t tapUs, float &bpm);
+
+#endif // TEMPO_H
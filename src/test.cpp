@@ -2,14 +2,360 @@
 #include "input.h"
 #include "audio.h"
 #include "display.h"
+#include "dsp.h"
+#include "pot.h"
+#include "config.h"
+#include "pitch.h"
+#include "latencyprobe.h"
+
+// Check each DSP kernel against a plain C reference and report cycles per
+// audio block (DWT cycle counter) over serial
+static void benchmarkDspKernels()
+{
+    const int n = AUDIO_BLOCK_SAMPLES;
+    static int16_t a[AUDIO_BLOCK_SAMPLES + 1];
+    static int16_t b[AUDIO_BLOCK_SAMPLES + 1];
+    static int16_t c[AUDIO_BLOCK_SAMPLES];
+    static int16_t ref[AUDIO_BLOCK_SAMPLES];
+    for (int i = 0; i <= n; i++)
+    {
+        a[i] = (int16_t)(random(-16384, 16384));
+        b[i] = (int16_t)(random(-16384, 16384));
+    }
+    // odd offset exercises unaligned loads, like odd lags in the pitch detector
+    const int16_t *bu = b + 1;
+
+    uint32_t t0 = ARM_DWT_CYCCNT;
+    int64_t ssd = dspSumSquaredDiff(a, bu, n);
+    uint32_t ssdCycles = ARM_DWT_CYCCNT - t0;
+    int64_t ssdRef = 0;
+    for (int i = 0; i < n; i++)
+        ssdRef += (int64_t)(a[i] - bu[i]) * (a[i] - bu[i]);
+
+    t0 = ARM_DWT_CYCCNT;
+    int32_t dot = dspDotProduct(a, bu, n);
+    uint32_t dotCycles = ARM_DWT_CYCCNT - t0;
+    int32_t dotRef = 0;
+    for (int i = 0; i < n; i++)
+        dotRef += (int32_t)a[i] * bu[i];
+
+    memcpy(c, a, sizeof(c));
+    t0 = ARM_DWT_CYCCNT;
+    dspGainRamp(c, n, 0, DSP_UNITY_GAIN * 2);
+    uint32_t rampCycles = ARM_DWT_CYCCNT - t0;
+    int32_t g = 0;
+    int32_t step = (DSP_UNITY_GAIN * 2) / n;
+    bool rampOk = true;
+    for (int i = 0; i < n; i++, g += step)
+    {
+        int32_t v = (int32_t)(((int64_t)g * a[i]) >> 16);
+        ref[i] = (int16_t)constrain(v, (int32_t)-32768, (int32_t)32767);
+        rampOk = rampOk && (ref[i] == c[i]);
+    }
+
+    Serial.println("DSP kernels (cycles per block):");
+    Serial.print(" sumSquaredDiff: ");
+    Serial.print(ssdCycles);
+    Serial.println(ssd == ssdRef ? " OK" : " MISMATCH");
+    Serial.print(" dotProduct: ");
+    Serial.print(dotCycles);
+    Serial.println(dot == dotRef ? " OK" : " MISMATCH");
+    Serial.print(" gainRamp: ");
+    Serial.print(rampCycles);
+    Serial.println(rampOk ? " OK" : " MISMATCH");
+}
+
+// Run all six chord oscillators on each waveform for a moment and report
+// the engine's peak CPU per oscillator (percent of one block period)
+static void benchmarkSynthWaveforms()
+{
+    static const short waves[] = {WAVEFORM_SINE, WAVEFORM_SAWTOOTH, WAVEFORM_BANDLIMIT_SAWTOOTH,
+                                  WAVEFORM_SQUARE, WAVEFORM_BANDLIMIT_SQUARE};
+    static const char *const names[] = {"sine", "saw", "saw (PolyBLEP)", "square", "square (PolyBLEP)"};
+
+    Serial.println("Synth CPU per oscillator (% of block):");
+    chordSynth.noteOn();
+    for (unsigned w = 0; w < sizeof(waves) / sizeof(waves[0]); w++)
+    {
+        for (int i = 0; i < SYNTH_OSCS; i++)
+        {
+            chordSynth.osc[i].begin(waves[w]);
+            chordSynth.osc[i].frequency(220.0f * (i + 1));
+            chordSynth.osc[i].amplitude(0.1f);
+        }
+        delay(20);
+        chordSynth.processorUsageMaxReset();
+        delay(200);
+        Serial.print(" ");
+        Serial.print(names[w]);
+        Serial.print(": ");
+        Serial.println(chordSynth.processorUsageMax() / SYNTH_OSCS, 3);
+    }
+    chordSynth.noteOff(0.0f);
+    for (int i = 0; i < SYNTH_OSCS; i++)
+    {
+        chordSynth.osc[i].begin(WAVEFORM_SINE);
+        chordSynth.osc[i].amplitude(0);
+    }
+    delay(20);
+}
+
+// Peak CPU (percent of one block) of a set of audio objects, over 200 ms
+static float objectsUsageMax(AudioStream *const *objects, int count)
+{
+    for (int i = 0; i < count; i++)
+        objects[i]->processorUsageMaxReset();
+    AudioProcessorUsageMaxReset();
+    AudioMemoryUsageMaxReset();
+    delay(200);
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++)
+        sum += objects[i]->processorUsageMax();
+    return sum;
+}
+
+static void printSynthPathUsage(const char *name, float pathCpu)
+{
+    Serial.print(" ");
+    Serial.print(name);
+    Serial.print(": synth path ");
+    Serial.print(pathCpu, 2);
+    Serial.print("%, graph max ");
+    Serial.print(AudioProcessorUsageMax(), 1);
+    Serial.print("%, blocks max ");
+    Serial.println(AudioMemoryUsageMax());
+}
+
+// The graph the chord engine replaced: six AudioSynthWaveform, a smoothed
+// gain per voice and the reverb send mixer, with the detuned companions
+// running but not patched in. Left unconnected and silent outside
+// benchmarkSynthBaseline(), so it costs nothing in normal running.
+static AudioSynthWaveform oldOsc[SYNTH_OSCS];
+static AudioEffectSmoothGain oldGain[SYNTH_VOICES];
+static AudioMixer4 oldSynthMix;
+static AudioConnection oldPatch[SYNTH_VOICES * 2];
+
+// Play the same six-oscillator chord through the old graph and through the
+// engine and its volume stage, and report the synth path's CPU, the whole
+// graph's CPU and AudioMemoryUsageMax() for each. mixerLeft/mixerRight are
+// common to both and not counted in the synth path.
+static void benchmarkSynthBaseline()
+{
+    Serial.println("Synth path vs old six-waveform graph (% of block):");
+    for (int v = 0; v < SYNTH_VOICES; v++)
+    {
+        oldPatch[v * 2].connect(oldOsc[v * SYNTH_OSCS_PER_VOICE], 0, oldGain[v], 0);
+        oldPatch[v * 2 + 1].connect(oldGain[v], 0, oldSynthMix, v);
+        oldGain[v].gain(1.0f);
+    }
+    for (int i = 0; i < SYNTH_OSCS; i++)
+    {
+        oldOsc[i].begin(WAVEFORM_SINE);
+        oldOsc[i].frequency(220.0f * (i + 1));
+        oldOsc[i].amplitude(0.1f);
+    }
+    delay(20);
+    AudioStream *oldPath[SYNTH_OSCS + SYNTH_VOICES + 1];
+    int n = 0;
+    for (int i = 0; i < SYNTH_OSCS; i++)
+        oldPath[n++] = &oldOsc[i];
+    for (int v = 0; v < SYNTH_VOICES; v++)
+        oldPath[n++] = &oldGain[v];
+    oldPath[n++] = &oldSynthMix;
+    float oldCpu = objectsUsageMax(oldPath, n);
+    printSynthPathUsage("old graph", oldCpu);
+
+    for (int i = 0; i < SYNTH_OSCS; i++)
+        oldOsc[i].amplitude(0);
+    for (int i = 0; i < SYNTH_VOICES * 2; i++)
+        oldPatch[i].disconnect();
+    delay(20);
+
+    for (int i = 0; i < SYNTH_OSCS; i++)
+    {
+        chordSynth.osc[i].begin(WAVEFORM_SINE);
+        chordSynth.osc[i].frequency(220.0f * (i + 1));
+        chordSynth.osc[i].amplitude(0.1f);
+    }
+    chordSynth.noteOn();
+    delay(20);
+    AudioStream *const enginePath[] = {&chordSynth, &synthVolume};
+    printSynthPathUsage("chord engine", objectsUsageMax(enginePath, 2));
+    chordSynth.noteOff(0.0f);
+    for (int i = 0; i < SYNTH_OSCS; i++)
+        chordSynth.osc[i].amplitude(0);
+    delay(20);
+}
+
+// Play a chord through each reverb engine and report its CPU while
+// sounding, how long the tail runs before the bypass kicks in, and the
+// CPU once bypassed (percent of one block period)
+static void benchmarkReverbEngines()
+{
+    static const char *const names[] = {"freeverb", "fdn"};
+    AudioStream *const engines[] = {&reverb, &fdnReverb};
+
+    Serial.println("Reverb CPU (% of block): playing / bypassed, tail");
+    for (int i = 0; i < SYNTH_OSCS; i++)
+    {
+        chordSynth.osc[i].begin(WAVEFORM_SINE);
+        chordSynth.osc[i].frequency(220.0f * (i + 1));
+        chordSynth.osc[i].amplitude(0.1f);
+    }
+    for (int e = REVERB_ENGINE_FREEVERB; e <= REVERB_ENGINE_FDN; e++)
+    {
+        setReverbEngine(e);
+        chordSynth.noteOn();
+        delay(50);
+        engines[e]->processorUsageMaxReset();
+        delay(300);
+        float playing = engines[e]->processorUsageMax();
+
+        chordSynth.noteOff(0.0f);
+        unsigned long releaseMs = millis();
+        while (!(e == REVERB_ENGINE_FDN ? fdnReverb.bypassed() : reverb.bypassed()) &&
+               millis() - releaseMs < 10000)
+            delay(1);
+        unsigned long tailMs = millis() - releaseMs;
+        delay(20);
+        engines[e]->processorUsageMaxReset();
+        delay(200);
+
+        Serial.print(" ");
+        Serial.print(names[e]);
+        Serial.print(": ");
+        Serial.print(playing, 2);
+        Serial.print(" / ");
+        Serial.print(engines[e]->processorUsageMax(), 2);
+        Serial.print(", ");
+        Serial.print(tailMs);
+        Serial.println(" ms");
+    }
+    for (int i = 0; i < SYNTH_OSCS; i++)
+        chordSynth.osc[i].amplitude(0);
+    setReverbEngine(REVERB_ENGINE);
+}
+
+// Time from the chord engine rendering a tone burst to the onset detector
+// hearing it at the input, through the codec and a cable from line out L
+// to line in L. The input is taken out of the mix meanwhile so the cable
+// cannot feed back. Includes the onset detector's rise time (< 1 ms).
+static int measureRoundTrip(uint32_t &minUs, uint32_t &avgUs, uint32_t &maxUs)
+{
+    static const EnvelopeSettings burst = {0.0f, 0.0f, 1.0f, ENV_LINEAR};
+    static const EnvelopeSettings declick = {5.0f, 0.0f, 1.0f, ENV_LINEAR};
+    const float inputGain = BOOST_INPUT_GAIN ? 1.5f : 1.0f;
+
+    mixerLeft.gain(0, 0.0f);
+    mixerRight.gain(0, 0.0f);
+    chordSynth.envelopeSettings(burst);
+    for (int i = 0; i < SYNTH_OSCS; i++)
+        chordSynth.osc[i].amplitude(0);
+    myEffect.begin(WAVEFORM_SINE);
+    myEffect.frequency(1000);
+    myEffect.amplitude(0.5);
+
+    int count = 0;
+    uint32_t total = 0;
+    minUs = 0xFFFFFFFF;
+    maxUs = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        delay(200); // let the detector's slow envelope settle and its refractory time pass
+        onsetDetect.available();
+        latencyProbe.available();
+        latencyProbe.arm();
+        chordSynth.noteOn();
+        unsigned long startMs = millis();
+        while (!onsetDetect.pending() && millis() - startMs < 100)
+            delay(1);
+        chordSynth.noteOff(0.0f);
+        latencyProbe.disarm();
+        if (!latencyProbe.available() || !onsetDetect.available())
+            continue;
+        int32_t us = (int32_t)(onsetDetect.read() - latencyProbe.read());
+        if (us <= 0)
+            continue; // attack heard before the burst left: not our signal
+        total += us;
+        count++;
+        if ((uint32_t)us < minUs)
+            minUs = us;
+        if ((uint32_t)us > maxUs)
+            maxUs = us;
+    }
+    avgUs = count ? total / count : 0;
+
+    myEffect.amplitude(0);
+    chordSynth.envelopeSettings(declick);
+    mixerLeft.gain(0, inputGain);
+    mixerRight.gain(0, inputGain);
+    return count;
+}
+
+// Block size, round-trip latency and audio CPU of this build, one line
+// each; flash the other platformio profile and compare
+static void reportBuildProfile()
+{
+    Serial.print("Build profile: ");
+    Serial.print(AUDIO_BLOCK_SAMPLES);
+    Serial.print("-sample blocks (");
+    Serial.print(AUDIO_BLOCK_SAMPLES * 1000.0f / AUDIO_SAMPLE_RATE_EXACT, 2);
+    Serial.println(" ms)");
+
+    uint32_t minUs, avgUs, maxUs;
+    int count = measureRoundTrip(minUs, avgUs, maxUs);
+    if (count > 0)
+    {
+        Serial.print(" round trip (ms): min ");
+        Serial.print(minUs / 1000.0f, 2);
+        Serial.print(" avg ");
+        Serial.print(avgUs / 1000.0f, 2);
+        Serial.print(" max ");
+        Serial.print(maxUs / 1000.0f, 2);
+        Serial.print(" (");
+        Serial.print(count);
+        Serial.println(" bursts)");
+    }
+    else
+    {
+        Serial.println(" round trip: no signal (connect line out L to line in L)");
+    }
+
+    // Full chord through the selected reverb, as in normal playing
+    for (int i = 0; i < SYNTH_OSCS; i++)
+    {
+        chordSynth.osc[i].frequency(220.0f * (i + 1));
+        chordSynth.osc[i].amplitude(0.1f);
+    }
+    chordSynth.noteOn();
+    delay(50);
+    AudioProcessorUsageMaxReset();
+    delay(500);
+    Serial.print(" audio CPU, chord + reverb: ");
+    Serial.print(AudioProcessorUsage(), 1);
+    Serial.print("% (max ");
+    Serial.print(AudioProcessorUsageMax(), 1);
+    Serial.println("%)");
+    chordSynth.noteOff(0.0f);
+    for (int i = 0; i < SYNTH_OSCS; i++)
+        chordSynth.osc[i].amplitude(0);
+    delay(20);
+}
 
 void hardwareTestMode()
 {
+    benchmarkDspKernels();
+    benchmarkSynthWaveforms();
+    benchmarkSynthBaseline();
+    benchmarkReverbEngines();
+    reportBuildProfile();
+
     // Start continuous 1kHz tone at 0.5 amplitude
     myEffect.frequency(1000);
     myEffect.amplitude(0.5);
     myEffect2.amplitude(0);
     myEffect3.amplitude(0);
+    chordSynth.noteOn();
 
     display.clearDisplay();
     display.setTextSize(1);
@@ -19,13 +365,17 @@ void hardwareTestMode()
     display.display();
     delay(1000);
 
+    unsigned long lastNoiseReportMs = 0;
+    unsigned long lastAudioReportMs = 0;
+
     while (true) // infinite loop - only exit is reset
     {
         // Read inputs
         bool encButton = !digitalRead(ENC_BTN);
         bool fs1 = !digitalRead(FOOT1);
         bool fs2 = !digitalRead(FOOT2);
-        int potRaw = analogRead(POT_PIN);
+        int potRaw = potLastRaw();
+        int potFiltered = potReading();
 
         // Read peak input level for bargraph
         float peakL = 0.0f;
@@ -77,7 +427,9 @@ void hardwareTestMode()
         // Pot value
         display.setCursor(0, y);
         display.print("Pot raw: ");
-        display.println(potRaw);
+        display.print(potRaw);
+        display.print(" filt: ");
+        display.println(potFiltered);
 
         display.display();
 
@@ -91,7 +443,37 @@ void hardwareTestMode()
         Serial.print(" FS2:");
         Serial.print(fs2 ? "ON" : "off");
         Serial.print(" Pot:");
-        Serial.println(potRaw);
+        Serial.print(potRaw);
+        Serial.print(" filtered:");
+        Serial.println(potFiltered);
+
+        // Pot noise (standard deviation in ADC counts) once per window
+        float rawNoise, filteredNoise;
+        if (potNoise(rawNoise, filteredNoise) && millis() - lastNoiseReportMs >= 1000)
+        {
+            Serial.print("Pot noise (counts rms): raw ");
+            Serial.print(rawNoise, 2);
+            Serial.print(", filtered ");
+            Serial.println(filteredNoise, 2);
+            lastNoiseReportMs = millis();
+        }
+
+        // Audio graph load, for comparing synth engine changes on hardware
+        if (millis() - lastAudioReportMs >= 1000)
+        {
+            Serial.print("Audio CPU: ");
+            Serial.print(AudioProcessorUsage(), 1);
+            Serial.print("% (max ");
+            Serial.print(AudioProcessorUsageMax(), 1);
+            Serial.print("%), chord engine max ");
+            Serial.print(chordSynth.processorUsageMax(), 1);
+            Serial.print("%, blocks ");
+            Serial.print(AudioMemoryUsage());
+            Serial.print(" (max ");
+            Serial.print(AudioMemoryUsageMax());
+            Serial.println(")");
+            lastAudioReportMs = millis();
+        }
 
         delay(50);
     }
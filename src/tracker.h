@@ -0,0 +1,288 @@
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "harmony.h"
+#include "config.h"
+
+// Pitch tracking stage: turns raw detector estimates into a steady tonic.
+//
+// All filtering is done in cents (MIDI note * 100) so that smoothing is
+// symmetric in pitch and never averages across octaves. A PitchTracker is
+// parameterised on its smoothing strategy; pick one with PITCH_TRACKER in
+// config.h. Per-instrument behaviour comes from a TrackerTuning.
+
+struct TrackerTuning
+{
+    float minHz;            // raw estimates outside [minHz, maxHz] are ignored
+    float maxHz;
+    float foldLowHz;        // tonic below this is raised an octave
+    float foldHighHz;       // tonic above this is lowered an octave
+    float foldHystCents;    // how far past a fold boundary before re-folding
+    float octaveTolCents;   // max distance of a harmonic candidate from the track
+    int octaveConfirm;      // consecutive octave-off estimates before accepting the jump
+    float jumpCents;        // larger moves are treated as a new note
+    int jumpConfirm;        // consecutive far estimates before re-acquiring
+    float onePoleAlpha;     // LogOnePoleFilter: smoothing at probability 1.0
+    float kalmanQ;          // KalmanCentsFilter: process noise (cents^2 per update)
+    float kalmanR;          // KalmanCentsFilter: measurement noise at probability 1.0
+};
+
+// Per-instrument tuning (selected by the Bass/Gtr setting)
+// {minHz, maxHz, foldLowHz, foldHighHz, foldHystCents, octaveTolCents, octaveConfirm,
+//  jumpCents, jumpConfirm, onePoleAlpha, kalmanQ, kalmanR}
+static const TrackerTuning guitarTuning = {50.0f, PITCH_MAX_FREQ, 200.0f, 950.0f, 100.0f, 80.0f, 3,
+                                           80.0f, 2, 0.6f, 9.0f, 36.0f};
+static const TrackerTuning bassTuning = {25.0f, PITCH_MAX_FREQ_BASS, 200.0f, 950.0f, 100.0f, 80.0f, 3,
+                                         80.0f, 2, 0.5f, 6.0f, 49.0f};
+
+static inline float hzToCents(float hz)
+{
+    return 100.0f * freqToMidi(hz);
+}
+
+static inline float centsToHz(float cents)
+{
+    return 440.0f * exp2f((cents - 6900.0f) / 1200.0f);
+}
+
+// ----------------------
+// Smoothing strategies
+// ----------------------
+// Each provides reset(), configure(tuning) and update(cents, probability),
+// which returns the smoothed value in cents.
+
+// Median of the last N estimates (probability is ignored)
+template <int N>
+class MedianFilter
+{
+public:
+    void reset() { count = 0; idx = 0; }
+    void configure(const TrackerTuning &) {}
+    float update(float cents, float)
+    {
+        buf[idx] = cents;
+        idx = (idx + 1) % N;
+        if (count < N)
+            count++;
+
+        float sorted[N];
+        memcpy(sorted, buf, count * sizeof(float));
+        for (int i = 1; i < count; i++)
+        {
+            float v = sorted[i];
+            int j = i - 1;
+            while (j >= 0 && sorted[j] > v)
+            {
+                sorted[j + 1] = sorted[j];
+                j--;
+            }
+            sorted[j + 1] = v;
+        }
+        return sorted[count / 2];
+    }
+
+private:
+    float buf[N];
+    int count = 0;
+    int idx = 0;
+};
+
+// One-pole low-pass in log frequency, weighted by detector probability
+class LogOnePoleFilter
+{
+public:
+    void reset() { primed = false; }
+    void configure(const TrackerTuning &t) { alpha = t.onePoleAlpha; }
+    float update(float cents, float prob)
+    {
+        if (!primed)
+        {
+            y = cents;
+            primed = true;
+        }
+        else
+        {
+            y += alpha * prob * (cents - y);
+        }
+        return y;
+    }
+
+private:
+    float alpha = 0.5f;
+    float y = 0.0f;
+    bool primed = false;
+};
+
+// Scalar Kalman filter on pitch in cents (random-walk model). Low
+// probability estimates are treated as noisier measurements.
+class KalmanCentsFilter
+{
+public:
+    void reset() { primed = false; }
+    void configure(const TrackerTuning &t)
+    {
+        q = t.kalmanQ;
+        r = t.kalmanR;
+    }
+    float update(float cents, float prob)
+    {
+        if (!primed)
+        {
+            x = cents;
+            p = r;
+            primed = true;
+            return x;
+        }
+        float pr = (prob > 0.1f) ? prob : 0.1f;
+        float rEff = r / (pr * pr);
+        p += q;
+        float k = p / (p + rEff);
+        x += k * (cents - x);
+        p *= (1.0f - k);
+        return x;
+    }
+
+private:
+    float q = 4.0f;
+    float r = 25.0f;
+    float x = 0.0f;
+    float p = 0.0f;
+    bool primed = false;
+};
+
+// ----------------------
+// Tracker
+// ----------------------
+template <class Filter>
+class PitchTracker
+{
+public:
+    void configure(const TrackerTuning &t)
+    {
+        tuning = t;
+        filter.configure(t);
+        foldLowCents = hzToCents(t.foldLowHz);
+        foldHighCents = hzToCents(t.foldHighHz);
+        reset();
+    }
+
+    void reset()
+    {
+        filter.reset();
+        hasTrack = false;
+        trackCents = 0.0f;
+        foldShift = 0;
+        octaveCount = 0;
+        jumpCount = 0;
+    }
+
+    // Feed one raw estimate. Returns true if it was accepted; the tonic
+    // (octave-folded, in Hz) is then available from frequency().
+    bool update(float hz, float prob)
+    {
+        if (hz <= tuning.minHz || hz >= tuning.maxHz)
+            return false;
+
+        float cents = correctOctave(hzToCents(hz));
+
+        if (hasTrack && fabsf(cents - trackCents) > tuning.jumpCents)
+        {
+            // Far from the track: a new note once it has been seen repeatedly
+            if (++jumpCount < tuning.jumpConfirm)
+                return false;
+            filter.reset();
+            hasTrack = false;
+        }
+        jumpCount = 0;
+
+        bool fresh = !hasTrack;
+        trackCents = filter.update(cents, prob);
+        hasTrack = true;
+        updateFold(fresh);
+        return true;
+    }
+
+    bool valid() const { return hasTrack; }
+    float cents() const { return trackCents; }
+    float frequency() const { return centsToHz(trackCents + 1200.0f * foldShift); }
+
+private:
+    // The detector tends to lock onto the 2nd or 3rd harmonic, or onto a
+    // sub-harmonic. If the raw estimate is far from the track but one of
+    // those relatives is close to it, use the relative instead. A real
+    // octave change is accepted after octaveConfirm consecutive estimates.
+    float correctOctave(float cents)
+    {
+        if (!hasTrack)
+            return cents;
+
+        static const float relatives[] = {-1200.0f, 1200.0f, -1901.955f}; // f/2, 2f, f/3
+        float best = cents;
+        float bestDist = fabsf(cents - trackCents);
+        for (unsigned i = 0; i < sizeof(relatives) / sizeof(relatives[0]); i++)
+        {
+            float cand = cents + relatives[i];
+            float dist = fabsf(cand - trackCents);
+            if (dist < tuning.octaveTolCents && dist < bestDist)
+            {
+                best = cand;
+                bestDist = dist;
+            }
+        }
+
+        if (best == cents)
+        {
+            octaveCount = 0;
+            return cents;
+        }
+        if (++octaveCount >= tuning.octaveConfirm)
+        {
+            // persistent: the player really changed octave, start over
+            octaveCount = 0;
+            filter.reset();
+            hasTrack = false;
+            return cents;
+        }
+        return best;
+    }
+
+    // Keep the tonic in the [foldLow, foldHigh] register by at most one
+    // octave. A fresh track is folded directly; after that the fold only
+    // changes once the pitch is foldHystCents past a boundary, so notes
+    // near a boundary do not flip octaves.
+    void updateFold(bool fresh)
+    {
+        float c = trackCents;
+        float h = fresh ? 0.0f : tuning.foldHystCents;
+        if (fresh || foldShift == 0)
+        {
+            foldShift = 0;
+            if (c < foldLowCents - h)
+                foldShift = 1;
+            else if (c > foldHighCents + h)
+                foldShift = -1;
+        }
+        else if (foldShift == 1 && c > foldLowCents + h)
+        {
+            foldShift = 0;
+        }
+        else if (foldShift == -1 && c < foldHighCents - h)
+        {
+            foldShift = 0;
+        }
+    }
+
+    Filter filter;
+    TrackerTuning tuning;
+    float foldLowCents = 0.0f;
+    float foldHighCents = 0.0f;
+    float trackCents = 0.0f;
+    bool hasTrack = false;
+    int foldShift = 0;
+    int octaveCount = 0;
+    int jumpCount = 0;
+};
+
+#endif // TRACKER_H
@@ -0,0 +1,302 @@
+#include "yin.h"
+#include "dsp.h"
+
+void AudioAnalyzeYin::begin(float thresh)
+{
+    __disable_irq();
+    threshold = thresh;
+    __enable_irq();
+}
+
+void AudioAnalyzeYin::configure(float minFreq, float maxFreq, uint16_t windowSamples, uint8_t decim)
+{
+    if (decim != 2 && decim != 4 && decim != 8)
+        decim = 1;
+
+    // Design the anti-alias filter here rather than in the interrupt:
+    // Hamming-windowed sinc with its transition band ending at the new
+    // Nyquist frequency, 16 taps per unit of decimation.
+    int16_t q15[YIN_MAX_TAPS];
+    int n = (decim > 1) ? decim * YIN_TAPS_PER_PHASE : 0;
+    if (n > 0)
+    {
+        float fc = 0.4f / (float)decim; // cutoff, fraction of the input rate
+        float h[YIN_MAX_TAPS];
+        float sum = 0.0f;
+        for (int i = 0; i < n; i++)
+        {
+            float m = (float)i - (float)(n - 1) * 0.5f;
+            float sinc = (m == 0.0f) ? 2.0f * fc : sinf(TWO_PI * fc * m) / (PI * m);
+            float w = 0.54f - 0.46f * cosf(TWO_PI * (float)i / (float)(n - 1));
+            h[i] = sinc * w;
+            sum += h[i];
+        }
+        for (int i = 0; i < n; i++)
+            q15[i] = (int16_t)lrintf(h[i] / sum * 32767.0f); // unity DC gain
+    }
+
+    __disable_irq();
+    pendingMinFreq = minFreq;
+    pendingMaxFreq = maxFreq;
+    pendingWindow = windowSamples;
+    pendingDecimation = decim;
+    pendingNumTaps = n;
+    memcpy(pendingTaps, q15, n * sizeof(int16_t));
+    pendingConfig = true;
+    __enable_irq();
+}
+
+// Runs in the audio interrupt
+void AudioAnalyzeYin::applyConfig()
+{
+    bool rateChanged = (pendingDecimation != decimation);
+    decimation = pendingDecimation;
+    numTaps = pendingNumTaps;
+    memcpy(taps, pendingTaps, numTaps * sizeof(int16_t));
+    blockLen = AUDIO_BLOCK_SAMPLES / decimation;
+    sampleRate = AUDIO_SAMPLE_RATE_EXACT / (float)decimation;
+
+    // Window is a whole number of blocks so expiry stays block-aligned
+    uint16_t w = ((pendingWindow / decimation) / blockLen) * blockLen;
+    if (w < blockLen)
+        w = blockLen;
+
+    int hi = (int)(sampleRate / pendingMinFreq) + 2; // +1 for parabolic interpolation
+    if (hi > YIN_MAX_LAG)
+        hi = YIN_MAX_LAG;
+    // Keep the ring large enough for the window, the lag and one block
+    if (w + hi + blockLen > YIN_RING_SIZE)
+        w = ((YIN_RING_SIZE - hi - blockLen) / blockLen) * blockLen;
+    int lo = (int)(sampleRate / pendingMaxFreq);
+    if (lo < 2)
+        lo = 2;
+
+    window = w;
+    minLag = lo;
+    maxLag = hi;
+
+    // Restart the running sums. The sample history is still valid unless
+    // the analysis rate changed, in which case it is cleared.
+    if (rateChanged)
+    {
+        memset(ring, 0, sizeof(ring));
+        memset(firHistory, 0, sizeof(firHistory));
+        head = 0;
+    }
+    memset(diff, 0, sizeof(diff));
+    samplesSeen = 0;
+    fineTau = 0.0f;
+    hopSamples = YIN_HOP_SAMPLES;
+    pendingConfig = false;
+}
+
+void AudioAnalyzeYin::update(void)
+{
+    audio_block_t *block = receiveReadOnly();
+    if (!block)
+        return;
+
+    if (pendingConfig)
+        applyConfig();
+
+    // Append the new block (decimated if configured) to both halves of the
+    // mirrored ring
+    int16_t *dst = &ring[head];
+    if (decimation > 1)
+    {
+        decimateBlock(block->data, dst);
+    }
+    else
+    {
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+            dst[i] = block->data[i] >> 1;
+    }
+    release(block);
+    memcpy(dst + YIN_RING_SIZE, dst, blockLen * sizeof(int16_t));
+
+    // Update d(tau) for every lag: add the new block's terms and, once the
+    // window is full, subtract the block that just left the window.
+    // Samples are stored pre-halved, so every difference fits in 16 bits
+    // and the 64-bit sums are exact (no drift).
+    const int16_t *cur = &ring[head + YIN_RING_SIZE];
+    const int16_t *old = cur - window;
+    bool expire = (samplesSeen >= window);
+    for (int tau = 1; tau <= maxLag; tau++)
+    {
+        int64_t delta = dspSumSquaredDiff(cur, cur - tau, blockLen);
+        if (expire)
+            delta -= dspSumSquaredDiff(old, old - tau, blockLen);
+        diff[tau] += delta;
+    }
+
+    fineUpdate(cur + blockLen);
+
+    head = (head + blockLen) & (YIN_RING_SIZE - 1);
+    samplesSeen += blockLen;
+
+    blocks++;
+
+    // The running sums are kept up to date every block; the estimate
+    // itself is made once per hop, starting as soon as the window is full
+    hopSamples += AUDIO_BLOCK_SAMPLES;
+    if (samplesSeen < window || hopSamples < YIN_HOP_SAMPLES)
+        return;
+    hopSamples = 0;
+
+    PitchResult result;
+    if (!analyze(result.frequency, result.probability))
+    {
+        fineTau = 0.0f; // no pitch: the fine estimate has nothing to follow
+    }
+    else
+    {
+        // Move the fine search to this period when it has lost it
+        float tau = sampleRate / result.frequency;
+        if (fineTau == 0.0f || fabsf(tau - fineTau) > fineTau * YIN_FINE_RECENTER)
+            fineTau = tau;
+
+        result.block = blocks;
+        result.micros = micros();
+        results.push(result); // counted as dropped if the main loop fell behind
+    }
+}
+
+bool AudioAnalyzeYin::readFine(PitchResult &result)
+{
+    __disable_irq();
+    bool ready = fineReady;
+    if (ready)
+        result = fine;
+    fineReady = false;
+    __enable_irq();
+    return ready;
+}
+
+// Re-measure the period over the last YIN_FINE_PERIODS periods before end,
+// at lags within YIN_FINE_SPAN of the previous one
+void AudioAnalyzeYin::fineUpdate(const int16_t *end)
+{
+    if (fineTau == 0.0f)
+        return;
+
+    int center = (int)(fineTau + 0.5f);
+    int span = (int)(fineTau * YIN_FINE_SPAN) + 2;
+    int lo = center - span;
+    int hi = center + span;
+    if (lo < minLag)
+        lo = minLag;
+    if (hi > maxLag)
+        hi = maxLag;
+    if (lo > hi)
+    {
+        fineTau = 0.0f;
+        return;
+    }
+    int n = YIN_FINE_PERIODS * center;
+    if (n < blockLen)
+        n = blockLen;
+    if (n > YIN_RING_SIZE - blockLen - maxLag - 1)
+        n = YIN_RING_SIZE - blockLen - maxLag - 1; // history the ring still holds
+    const int16_t *x = end - n;
+
+    // d(tau) one lag past each end, so the minimum can be interpolated
+    int64_t d[YIN_FINE_MAX_LAGS];
+    int best = 1;
+    for (int tau = lo - 1; tau <= hi + 1; tau++)
+    {
+        int i = tau - lo + 1;
+        d[i] = dspSumSquaredDiff(x, x - tau, n);
+        if (i > 1 && tau <= hi && d[i] < d[best])
+            best = i;
+    }
+
+    // Aperiodicity: d(tau) against the energy of both spans (2 * sum x^2)
+    int64_t energy = 0;
+    for (int i = 0; i < n; i++)
+        energy += (int32_t)x[i] * x[i];
+    if (energy == 0 || (float)d[best] > YIN_FINE_THRESHOLD * 2.0f * (float)energy)
+    {
+        fineTau = 0.0f; // lost; wait for the next full estimate
+        return;
+    }
+
+    float s0 = (float)d[best - 1];
+    float s1 = (float)d[best];
+    float s2 = (float)d[best + 1];
+    float denom = s0 + s2 - 2.0f * s1;
+    float tau = (float)(best + lo - 1);
+    if (denom > 0.0f)
+        tau += 0.5f * (s0 - s2) / denom;
+    fineTau = tau;
+
+    fine.frequency = sampleRate / tau;
+    fine.probability = 1.0f - (float)d[best] / (2.0f * (float)energy);
+    fine.block = blocks;
+    fine.micros = micros();
+    fineReady = true;
+}
+
+// Low-pass filter and keep every decimation-th output. Writes blockLen
+// pre-halved samples to out and returns the count.
+int AudioAnalyzeYin::decimateBlock(const int16_t *in, int16_t *out)
+{
+    // firHistory holds the last numTaps-1 input samples followed by the block
+    int hist = numTaps - 1;
+    memcpy(&firHistory[hist], in, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+
+    int count = 0;
+    for (int n = decimation - 1; n < AUDIO_BLOCK_SAMPLES; n += decimation)
+    {
+        // taps are symmetric, so the time-reversed dot product is contiguous
+        int32_t acc = dspDotProduct(taps, &firHistory[n], numTaps);
+        int32_t y = acc >> 16; // Q15 product, then halved for the ring
+        if (y > 32767)
+            y = 32767;
+        else if (y < -32768)
+            y = -32768;
+        out[count++] = (int16_t)y;
+    }
+
+    memmove(firHistory, &firHistory[AUDIO_BLOCK_SAMPLES], hist * sizeof(int16_t));
+    return count;
+}
+
+// Cumulative mean normalized difference, absolute threshold and parabolic
+// interpolation (steps 3-5 of the YIN paper). Returns true on a new estimate.
+bool AudioAnalyzeYin::analyze(float &frequency, float &probability)
+{
+    float runningSum = 0.0f;
+    cmnd[0] = 1.0f;
+    for (int tau = 1; tau <= maxLag; tau++)
+    {
+        float d = (float)diff[tau];
+        runningSum += d;
+        cmnd[tau] = (runningSum > 0.0f) ? d * (float)tau / runningSum : 1.0f;
+    }
+
+    int tau = minLag;
+    for (; tau < maxLag; tau++)
+    {
+        if (cmnd[tau] < threshold)
+        {
+            // walk down to the bottom of this dip
+            while (tau + 1 < maxLag && cmnd[tau + 1] < cmnd[tau])
+                tau++;
+            break;
+        }
+    }
+    if (tau >= maxLag)
+        return false;
+
+    float s0 = cmnd[tau - 1];
+    float s1 = cmnd[tau];
+    float s2 = cmnd[tau + 1];
+    float denom = s0 + s2 - 2.0f * s1;
+    float betterTau = (float)tau;
+    if (denom != 0.0f)
+        betterTau += 0.5f * (s0 - s2) / denom;
+
+    frequency = sampleRate / betterTau;
+    probability = 1.0f - s1;
+    return true;
+}
@@ -0,0 +1,134 @@
+#ifndef YIN_H
+#define YIN_H
+
+#include <Arduino.h>
+#include <Audio.h>
+#include "spsc.h"
+
+// Sample history kept by the detector (power of two). It must hold one
+// analysis window plus the largest lag plus one audio block, so that the
+// terms leaving the window can be subtracted exactly.
+#define YIN_RING_SIZE 4096
+// Largest supported lag in samples (~29 Hz at 44.1 kHz)
+#define YIN_MAX_LAG 1536
+// Decimation front end: largest factor and FIR length per unit of decimation
+#define YIN_MAX_DECIMATION 8
+#define YIN_TAPS_PER_PHASE 16
+#define YIN_MAX_TAPS (YIN_MAX_DECIMATION * YIN_TAPS_PER_PHASE)
+// Input samples between estimates (a multiple of the audio block size).
+// Fixed rather than one per block, so the tracker's smoothing and lock
+// rules, which count estimates, behave the same in every build profile.
+#define YIN_HOP_SAMPLES 128
+// Estimates that can wait for the main loop (one per hop)
+#define YIN_RESULT_QUEUE 16
+// Fine estimate: periods of recent input it is measured over, lag search
+// range around the last period (fraction, about half a semitone), distance
+// of a full estimate that moves the search there, and the aperiodicity
+// (0..1) above which the fine estimate is dropped
+#define YIN_FINE_PERIODS 1
+#define YIN_FINE_SPAN 0.03f
+#define YIN_FINE_RECENTER 0.12f
+#define YIN_FINE_THRESHOLD 0.2f
+#define YIN_FINE_MAX_LAGS (2 * (int)(YIN_MAX_LAG * YIN_FINE_SPAN + 2) + 3)
+
+// One pitch estimate, pushed by the audio interrupt
+struct PitchResult
+{
+    float frequency;
+    float probability;
+    uint32_t block;  // detector block counter when the estimate was made
+    uint32_t micros; // time the estimate was made
+};
+
+// Incremental YIN pitch detector.
+// Instead of collecting many blocks and then running the whole difference
+// function (as AudioAnalyzeNoteFrequency does), the difference function is
+// kept as a running sum over a sliding window: each audio block adds the
+// terms of the new samples and subtracts the terms that fall out of the
+// window. An estimate is therefore available every YIN_HOP_SAMPLES once
+// the window has filled, and the history survives a tracker reset.
+//
+// For low-register instruments the input can be low-pass filtered and
+// decimated before lag analysis, which shrinks both the lag range and the
+// number of samples per block by the decimation factor.
+//
+// Between full estimates a fine estimate is made every block: the period
+// is re-measured over only the last YIN_FINE_PERIODS periods, searching a
+// few lags around the previous one. The short window follows bends and
+// vibrato within a few milliseconds; it only runs while a full estimate
+// holds a pitch, which also keeps it on the right period.
+class AudioAnalyzeYin : public AudioStream
+{
+public:
+    AudioAnalyzeYin() : AudioStream(1, inputQueueArray) {}
+
+    // threshold: 0.0 = very sensitive, 1.0 = very picky (same as noteDetect)
+    void begin(float threshold);
+    // Select the detection range, analysis window (in input samples) and
+    // decimation factor (1, 2, 4 or 8). Applied by the audio interrupt at the
+    // start of the next block; the window is rounded to whole blocks.
+    void configure(float minFreq, float maxFreq, uint16_t windowSamples, uint8_t decimation = 1);
+
+    // Estimates are queued by the audio interrupt, oldest first
+    bool readResult(PitchResult &result) { return results.pop(result); }
+    // True while an estimate is waiting to be read
+    bool pending() const { return !results.empty(); }
+    // Latest fine estimate, if one was made since the last call
+    bool readFine(PitchResult &result);
+    bool finePending() const { return fineReady; }
+    // Estimates lost because the queue was full
+    uint32_t droppedCount() const { return results.droppedCount(); }
+    // Audio blocks processed so far
+    uint32_t blockCount() const { return blocks; }
+
+    virtual void update(void);
+
+private:
+    void applyConfig();
+    int decimateBlock(const int16_t *in, int16_t *out);
+    bool analyze(float &frequency, float &probability);
+    void fineUpdate(const int16_t *end);
+
+    audio_block_t *inputQueueArray[1];
+
+    // Mirrored ring: every sample is written at i and i + YIN_RING_SIZE so
+    // that any span needed by the difference function is contiguous.
+    int16_t ring[YIN_RING_SIZE * 2];
+    uint16_t head = 0;
+
+    // Decimating low-pass FIR (Q15). Only the retained output phase is
+    // evaluated, so the cost is taps/decimation MACs per input sample.
+    int16_t taps[YIN_MAX_TAPS];
+    int16_t firHistory[YIN_MAX_TAPS - 1 + AUDIO_BLOCK_SAMPLES];
+    uint8_t numTaps = 0;
+    uint8_t decimation = 1;
+    uint16_t blockLen = AUDIO_BLOCK_SAMPLES; // analysis samples per audio block
+    float sampleRate = AUDIO_SAMPLE_RATE_EXACT;
+
+    int64_t diff[YIN_MAX_LAG + 1];
+    float cmnd[YIN_MAX_LAG + 1];
+    uint32_t samplesSeen = 0;
+    uint32_t hopSamples = 0;
+
+    float threshold = 0.15f;
+    uint16_t window = 1024;
+    uint16_t minLag = 22;
+    uint16_t maxLag = 882;
+
+    volatile bool pendingConfig = false;
+    float pendingMinFreq = 50.0f;
+    float pendingMaxFreq = 2000.0f;
+    uint16_t pendingWindow = 1024;
+    uint8_t pendingDecimation = 1;
+    uint8_t pendingNumTaps = 0;
+    int16_t pendingTaps[YIN_MAX_TAPS];
+
+    float fineTau = 0.0f; // period followed by the fine estimate, 0 = none
+    PitchResult fine;
+    volatile bool fineReady = false;
+
+    SpscQueue<PitchResult, YIN_RESULT_QUEUE> results;
+    volatile uint32_t blocks = 0;
+};
+
+#endif // YIN_H
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+# Generates the synthetic plucked-string WAVs used by test_yin_wav
+# (44.1 kHz, 16-bit mono). Each file is a stretch of near-silence followed
+# by one pluck: harmonics weighted by the pluck position, higher ones
+# decaying faster, plus a short noise burst for the pick attack. The
+# fundamental is exact, so it can be put in the file name.
+#
+#   python3 test/data/make_plucks.py
+#
+# Real recordings can be benchmarked the same way: name them
+# <anything>_<Hz>Hz.wav (prefix bass_ for the bass detector settings).
+
+import math
+import os
+import random
+import struct
+import wave
+
+RATE = 44100
+LEAD_IN = 0.15  # seconds of noise floor before the pluck
+LENGTH = 0.45   # seconds of pluck
+
+NOTES = [
+    ("guitar_E2", 82.41),
+    ("guitar_A2", 110.00),
+    ("guitar_D3", 146.83),
+    ("guitar_G3", 196.00),
+    ("guitar_E4", 329.63),
+    ("bass_E1", 41.20),
+    ("bass_A1", 55.00),
+]
+
+
+def pluck(f0, seed):
+    rnd = random.Random(seed)
+    position = 0.2  # pluck point, fraction of the string length
+    harmonics = []
+    k = 1
+    while k * f0 < 5000.0:
+        amp = abs(math.sin(math.pi * k * position)) / k
+        decay = 1.5 + 2.0 * (k - 1)  # 1/s
+        harmonics.append((k * f0, amp, decay, rnd.uniform(0, 2 * math.pi)))
+        k += 1
+    n = int(LENGTH * RATE)
+    out = []
+    for i in range(n):
+        t = i / RATE
+        x = 0.0
+        for f, a, d, ph in harmonics:
+            x += a * math.exp(-d * t) * math.sin(2 * math.pi * f * t + ph)
+        if i < 0.005 * RATE:
+            x += rnd.uniform(-0.3, 0.3) * (1.0 - i / (0.005 * RATE))
+        out.append(x)
+    peak = max(abs(v) for v in out)
+    return [v / peak * 0.5 for v in out]
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    for seed, (name, f0) in enumerate(NOTES):
+        rnd = random.Random(1000 + seed)
+        lead = [rnd.uniform(-1, 1) * 20.0 / 32768.0 for _ in range(int(LEAD_IN * RATE))]
+        samples = lead + pluck(f0, seed)
+        path = os.path.join(here, "%s_%.2fHz.wav" % (name, f0))
+        with wave.open(path, "wb") as w:
+            w.setnchannels(1)
+            w.setsampwidth(2)
+            w.setframerate(RATE)
+            w.writeframes(b"".join(struct.pack("<h", int(round(v * 32767))) for v in samples))
+        print(path)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,65 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host stand-in for the parts of the Arduino/Teensy core that the
+// host-tested modules use (env:native only). Time comes from a simulated
+// clock that tests set directly; Serial prints to stdout.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PI 3.1415926535897932384626433832795
+#define TWO_PI 6.283185307179586476925286766559
+
+#define __disable_irq() \
+    do                  \
+    {                   \
+    } while (0)
+#define __enable_irq() \
+    do                 \
+    {                  \
+    } while (0)
+
+template <class T>
+static inline T constrain(T x, T lo, T hi)
+{
+    return (x < lo) ? lo : ((x > hi) ? hi : x);
+}
+
+// Simulated clock (microseconds)
+inline uint32_t hostClockUs = 0;
+static inline uint32_t micros() { return hostClockUs; }
+static inline uint32_t millis() { return hostClockUs / 1000; }
+
+class HostSerial
+{
+public:
+    void begin(long) {}
+    void print(const char *s) { fputs(s, stdout); }
+    void print(char c) { fputc(c, stdout); }
+    void print(int v) { printf("%d", v); }
+    void print(unsigned int v) { printf("%u", v); }
+    void print(long v) { printf("%ld", v); }
+    void print(unsigned long v) { printf("%lu", v); }
+    void print(double v, int digits = 2) { printf("%.*f", digits, v); }
+    void println() { fputc('\n', stdout); }
+    template <class T>
+    void println(T v)
+    {
+        print(v);
+        println();
+    }
+    void println(double v, int digits)
+    {
+        print(v, digits);
+        println();
+    }
+};
+
+inline HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
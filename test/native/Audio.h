@@ -0,0 +1,164 @@
+#ifndef HOST_AUDIO_H
+#define HOST_AUDIO_H
+
+// Host stand-in for the Teensy Audio Library core (env:native only):
+// enough of AudioStream to run the custom audio objects block by block.
+// Tests queue input with hostInput(), run one block period with
+// hostUpdate() and read what the object transmitted with hostOutput().
+
+#include <Arduino.h>
+
+#ifndef AUDIO_BLOCK_SAMPLES
+#define AUDIO_BLOCK_SAMPLES 128
+#endif
+#define AUDIO_SAMPLE_RATE_EXACT 44100.0f
+
+#define WAVEFORM_SINE 0
+#define WAVEFORM_SAWTOOTH 1
+#define WAVEFORM_SQUARE 2
+#define WAVEFORM_TRIANGLE 3
+#define WAVEFORM_ARBITRARY 4
+#define WAVEFORM_PULSE 5
+#define WAVEFORM_SAWTOOTH_REVERSE 6
+#define WAVEFORM_SAMPLE_HOLD 7
+#define WAVEFORM_TRIANGLE_VARIABLE 8
+#define WAVEFORM_BANDLIMIT_SAWTOOTH 9
+#define WAVEFORM_BANDLIMIT_SAWTOOTH_REVERSE 10
+#define WAVEFORM_BANDLIMIT_SQUARE 11
+#define WAVEFORM_BANDLIMIT_PULSE 12
+
+#define AudioNoInterrupts() \
+    do                      \
+    {                       \
+    } while (0)
+#define AudioInterrupts() \
+    do                    \
+    {                     \
+    } while (0)
+
+typedef struct audio_block_struct
+{
+    uint8_t ref_count;
+    uint8_t reserved1;
+    uint16_t memory_pool_index;
+    int16_t data[AUDIO_BLOCK_SAMPLES];
+} audio_block_t;
+
+// Same 257-entry table as the library (round(32767 * sin))
+inline const int16_t AudioWaveformSine[257] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739,
+    9512, 10278, 11039, 11793, 12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279, 24811,
+    25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521,
+    32609, 32678, 32728, 32757, 32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+    32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571, 30273, 29956, 29621, 29268,
+    28898, 28510, 28105, 27683, 27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+    23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868, 18204, 17530, 16846, 16151,
+    15446, 14732, 14010, 13279, 12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179,
+    6393, 5602, 4808, 4011, 3212, 2410, 1608, 804, 0, -804, -1608, -2410,
+    -3212, -4011, -4808, -5602, -6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159,
+    -20787, -21403, -22005, -22594, -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+    -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580,
+    -31356, -31113, -30852, -30571, -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731, -23170, -22594, -22005, -21403,
+    -20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278, -9512, -8739, -7962, -7179, -6393, -5602, -4808, -4011,
+    -3212, -2410, -1608, -804, 0};
+
+#define HOST_AUDIO_POOL 32
+#define HOST_AUDIO_OUTPUTS 4
+
+class AudioStream
+{
+public:
+    AudioStream(unsigned char ninput, audio_block_t **iqueue) : numInputs(ninput), inputQueue(iqueue)
+    {
+        for (int i = 0; i < ninput; i++)
+            inputQueue[i] = nullptr;
+    }
+    virtual ~AudioStream() {}
+    virtual void update(void) = 0;
+
+    // Queue a copy of one block of samples on an input, as a connected
+    // source's transmit() would
+    void hostInput(const int16_t *samples, unsigned index = 0)
+    {
+        audio_block_t *b = allocate();
+        if (!b || index >= numInputs)
+            return;
+        memcpy(b->data, samples, sizeof(b->data));
+        if (inputQueue[index])
+            release(inputQueue[index]);
+        inputQueue[index] = b;
+    }
+    // Run one block period
+    void hostUpdate()
+    {
+        for (int i = 0; i < HOST_AUDIO_OUTPUTS; i++)
+            sent[i] = false;
+        update();
+        for (int i = 0; i < numInputs; i++)
+        {
+            if (inputQueue[i])
+                release(inputQueue[i]); // not received by update()
+            inputQueue[i] = nullptr;
+        }
+    }
+    // Block transmitted on an output during the last hostUpdate(), or null
+    const int16_t *hostOutput(unsigned index = 0) const
+    {
+        return (index < HOST_AUDIO_OUTPUTS && sent[index]) ? out[index] : nullptr;
+    }
+
+protected:
+    audio_block_t *receiveReadOnly(unsigned int index = 0)
+    {
+        if (index >= numInputs)
+            return nullptr;
+        audio_block_t *b = inputQueue[index];
+        inputQueue[index] = nullptr;
+        return b;
+    }
+    audio_block_t *receiveWritable(unsigned int index = 0) { return receiveReadOnly(index); }
+    static audio_block_t *allocate()
+    {
+        for (int i = 0; i < HOST_AUDIO_POOL; i++)
+        {
+            if (pool()[i].ref_count == 0)
+            {
+                pool()[i].ref_count = 1;
+                return &pool()[i];
+            }
+        }
+        return nullptr;
+    }
+    static void release(audio_block_t *block)
+    {
+        if (block && block->ref_count)
+            block->ref_count--;
+    }
+    void transmit(audio_block_t *block, unsigned char index = 0)
+    {
+        if (index >= HOST_AUDIO_OUTPUTS)
+            return;
+        memcpy(out[index], block->data, sizeof(out[index]));
+        sent[index] = true;
+    }
+
+private:
+    static audio_block_t *pool()
+    {
+        static audio_block_t blocks[HOST_AUDIO_POOL];
+        return blocks;
+    }
+    unsigned char numInputs;
+    audio_block_t **inputQueue;
+    int16_t out[HOST_AUDIO_OUTPUTS][AUDIO_BLOCK_SAMPLES];
+    bool sent[HOST_AUDIO_OUTPUTS] = {};
+};
+
+#endif // HOST_AUDIO_H
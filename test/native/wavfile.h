@@ -0,0 +1,61 @@
+#ifndef HOST_WAVFILE_H
+#define HOST_WAVFILE_H
+
+// Host helper for the tests that replay recordings (env:native only):
+// reads a 16-bit PCM WAV at 44.1 kHz, keeping the first channel.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static inline bool readWav(const std::string &path, std::vector<int16_t> &samples)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    char riff[12];
+    bool ok = (fread(riff, 1, 12, f) == 12 && !memcmp(riff, "RIFF", 4) && !memcmp(riff + 8, "WAVE", 4));
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t rate = 0;
+    while (ok)
+    {
+        char id[4];
+        uint32_t size;
+        if (fread(id, 1, 4, f) != 4 || fread(&size, 4, 1, f) != 1)
+        {
+            ok = false;
+            break;
+        }
+        if (!memcmp(id, "fmt ", 4))
+        {
+            uint8_t fmt[16];
+            ok = (size >= 16 && fread(fmt, 1, 16, f) == 16);
+            memcpy(&format, fmt, 2);
+            memcpy(&channels, fmt + 2, 2);
+            memcpy(&rate, fmt + 4, 4);
+            memcpy(&bits, fmt + 14, 2);
+            fseek(f, size - 16 + (size & 1), SEEK_CUR);
+        }
+        else if (!memcmp(id, "data", 4))
+        {
+            ok = (format == 1 && bits == 16 && channels > 0 && rate == 44100);
+            if (!ok)
+                break;
+            std::vector<int16_t> raw(size / 2);
+            raw.resize(fread(raw.data(), 2, raw.size(), f));
+            for (size_t i = 0; i + channels <= raw.size(); i += channels)
+                samples.push_back(raw[i]);
+            break;
+        }
+        else
+        {
+            fseek(f, size + (size & 1), SEEK_CUR);
+        }
+    }
+    fclose(f);
+    return ok && !samples.empty();
+}
+
+#endif // HOST_WAVFILE_H
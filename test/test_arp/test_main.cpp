@@ -0,0 +1,303 @@
+// ArpSequencer host tests (pio test -e native -f test_arp)
+//
+// Drives the arpeggiator's step sequencer directly, in chunks of any
+// size, and checks to the sample where steps start and gates close: the
+// straight and swung step grid, gate-offs, Chord Stab closing every voice
+// with its stab gate, settings taking effect at the next step, and that
+// the output does not depend on the audio block size.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "config.h"
+#include "arp.h"
+
+// env:native does not build src/, so the module under test is compiled here
+#include "arp.cpp"
+
+#define RAMP_STEP (65536 / ARP_GATE_RAMP_SAMPLES)
+
+struct ArpRun
+{
+    std::vector<int32_t> gate[ARP_VOICES];
+    std::vector<int8_t> voice; // voice() after each chunk, per sample of it
+};
+
+// Render n samples in chunks of 'chunk' samples, as the chord engine does
+// with one chunk per audio block
+static void render(ArpSequencer &arp, ArpRun &run, uint32_t n, uint32_t chunk)
+{
+    std::vector<int32_t> buf[ARP_VOICES];
+    for (int v = 0; v < ARP_VOICES; v++)
+        buf[v].resize(chunk);
+    int32_t *const out[ARP_VOICES] = {buf[0].data(), buf[1].data(), buf[2].data()};
+    uint8_t state[ARP_VOICES];
+    while (n)
+    {
+        uint32_t len = (n < chunk) ? n : chunk;
+        arp.render(out, len, state);
+        for (int v = 0; v < ARP_VOICES; v++)
+        {
+            run.gate[v].insert(run.gate[v].end(), out[v], out[v] + len);
+
+            // the state must describe the chunk it was returned for
+            bool allOpen = true, allClosed = true;
+            for (uint32_t i = 0; i < len; i++)
+            {
+                allOpen = allOpen && out[v][i] == 65536;
+                allClosed = allClosed && out[v][i] == 0;
+            }
+            TEST_ASSERT_EQUAL_INT(allOpen ? ARP_GATE_OPEN : (allClosed ? ARP_GATE_CLOSED : ARP_GATE_RAMPING), state[v]);
+        }
+        run.voice.insert(run.voice.end(), len, (int8_t)arp.voice());
+        n -= len;
+    }
+}
+
+// First sample at which voice v's gate starts to open from closed, at or
+// after 'from'; -1 if it does not
+static long openAt(const ArpRun &run, int v, size_t from)
+{
+    const std::vector<int32_t> &g = run.gate[v];
+    for (size_t i = (from ? from : 1); i < g.size(); i++)
+        if (g[i - 1] == 0 && g[i] > 0)
+            return (long)i;
+    return -1;
+}
+
+// First sample at which voice v's gate starts to close from open
+static long closeAt(const ArpRun &run, int v, size_t from)
+{
+    const std::vector<int32_t> &g = run.gate[v];
+    for (size_t i = (from ? from : 1); i < g.size(); i++)
+        if (g[i - 1] == 65536 && g[i] < 65536)
+            return (long)i;
+    return -1;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// Stopped: every voice open, nothing sequenced
+static void test_stopped_is_open()
+{
+    ArpSequencer arp;
+    ArpRun run;
+    render(arp, run, 1000, 128);
+    for (int v = 0; v < ARP_VOICES; v++)
+        for (int32_t g : run.gate[v])
+            TEST_ASSERT_EQUAL_INT(65536, g);
+    TEST_ASSERT_EQUAL_INT(-1, arp.voice());
+}
+
+// Up: step k starts at exactly k * step length, with the gate of its voice
+// opening on that sample and the previous voice's closing on it
+static void test_up_step_grid()
+{
+    const uint32_t len = 1000;
+    ArpSequencer arp;
+    arp.stepSamples(len);
+    arp.enable(true);
+    ArpRun run;
+    render(arp, run, 12 * len, 128);
+
+    for (uint32_t k = 1; k < 12; k++)
+    {
+        const size_t s = k * len;
+        const int v = (int)(k % 3);
+        const int prev = (int)((k + 2) % 3);
+        if (k >= 3)
+        {
+            TEST_ASSERT_EQUAL_INT((long)s, openAt(run, v, s - 10));
+            TEST_ASSERT_EQUAL_INT(RAMP_STEP, run.gate[v][s]);
+        }
+        TEST_ASSERT_EQUAL_INT((long)s, closeAt(run, prev, s - 10));
+        TEST_ASSERT_EQUAL_INT(65536 - RAMP_STEP, run.gate[prev][s]);
+        // the ramp takes ARP_GATE_RAMP_SAMPLES, then the gate holds
+        TEST_ASSERT_EQUAL_INT(65536, run.gate[v][s + ARP_GATE_RAMP_SAMPLES - 1]);
+        TEST_ASSERT_EQUAL_INT(0, run.gate[prev][s + ARP_GATE_RAMP_SAMPLES - 1]);
+        TEST_ASSERT_EQUAL_INT(v, run.voice[s + 200]);
+    }
+}
+
+// Down and up-down visit the voices in their order
+static void test_pattern_order()
+{
+    static const int8_t down[6] = {2, 1, 0, 2, 1, 0};
+    static const int8_t upDown[8] = {0, 1, 2, 1, 0, 1, 2, 1};
+    const uint32_t len = 300;
+    ArpSequencer arp;
+    arp.stepSamples(len);
+    arp.pattern(ARP_DOWN);
+    arp.enable(true);
+    ArpRun run;
+    render(arp, run, 6 * len, 1); // one sample at a time: voice() per sample
+    // down starts at the top
+    for (int k = 0; k < 6; k++)
+        TEST_ASSERT_EQUAL_INT(down[k], run.voice[k * len]);
+
+    ArpSequencer arp2;
+    arp2.stepSamples(len);
+    arp2.pattern(ARP_UP_DOWN);
+    arp2.enable(true);
+    ArpRun run2;
+    render(arp2, run2, 8 * len, 1);
+    for (int k = 0; k < 8; k++)
+    {
+        TEST_ASSERT_EQUAL_INT(upDown[k], run2.voice[k * len]);
+        TEST_ASSERT_EQUAL_INT(upDown[k], run2.voice[k * len + len - 1]);
+    }
+}
+
+// Swing: even steps lengthen and odd ones shorten by the same amount, so
+// every pair still spans two step lengths
+static void test_swing_lengths()
+{
+    const uint32_t len = 1000;
+    ArpSequencer arp;
+    arp.stepSamples(len);
+    arp.swing(0.25f);
+    arp.enable(true);
+    ArpRun run;
+    render(arp, run, 8 * len, 100);
+
+    const size_t starts[8] = {0, 1250, 2000, 3250, 4000, 5250, 6000, 7250};
+    for (int k = 1; k < 8; k++)
+    {
+        const int prev = (k + 2) % 3;
+        TEST_ASSERT_EQUAL_INT((long)starts[k], closeAt(run, prev, starts[k] - 10));
+        TEST_ASSERT_EQUAL_INT(k % 3, run.voice[starts[k] + 100]);
+    }
+}
+
+// Gate: the voice closes at gate x step length into each step, and the
+// step's voice then stays closed until its next step
+static void test_gate_off_position()
+{
+    const uint32_t len = 1000;
+    ArpSequencer arp;
+    arp.stepSamples(len);
+    arp.gate(0.3f);
+    arp.enable(true);
+    ArpRun run;
+    render(arp, run, 6 * len, 128);
+
+    const uint32_t off = (uint32_t)(((uint64_t)len * (int32_t)(0.3f * 65536.0f)) >> 16);
+    for (uint32_t k = 0; k < 6; k++)
+    {
+        const size_t s = k * len;
+        const int v = (int)(k % 3);
+        TEST_ASSERT_EQUAL_INT((long)(s + off), closeAt(run, v, s + 1));
+        for (size_t i = s + off + ARP_GATE_RAMP_SAMPLES - 1; i < s + len; i++)
+            for (int w = 0; w < ARP_VOICES; w++)
+                TEST_ASSERT_EQUAL_INT(0, run.gate[w][i]);
+    }
+}
+
+// Chord Stab with the stab gate: all three voices open together at each
+// step and close together at the gate-off, leaving a silent gap
+static void test_stab_closes_every_step()
+{
+    TEST_ASSERT_LESS_THAN_FLOAT(1.0f, ARP_STAB_GATE);
+    const uint32_t len = 1000;
+    ArpSequencer arp;
+    arp.stepSamples(len);
+    arp.pattern(ARP_CHORD_STAB);
+    arp.gate(ARP_STAB_GATE);
+    arp.enable(true);
+    ArpRun run;
+    render(arp, run, 8 * len, 128);
+
+    const uint32_t off = (uint32_t)(((uint64_t)len * (int32_t)(ARP_STAB_GATE * 65536.0f)) >> 16);
+    for (uint32_t k = 0; k < 8; k++)
+    {
+        const size_t s = k * len;
+        for (int v = 0; v < ARP_VOICES; v++)
+        {
+            if (k > 0)
+                TEST_ASSERT_EQUAL_INT((long)s, openAt(run, v, s - 10));
+            TEST_ASSERT_EQUAL_INT((long)(s + off), closeAt(run, v, s + 1));
+            TEST_ASSERT_EQUAL_INT(0, run.gate[v][s + off + ARP_GATE_RAMP_SAMPLES - 1]);
+            TEST_ASSERT_EQUAL_INT(0, run.gate[v][s + len - 1]);
+        }
+        TEST_ASSERT_EQUAL_INT(-1, run.voice[s + 10]);
+    }
+}
+
+// A new step length or gate applies from the next step; the running step
+// keeps the length it started with
+static void test_settings_take_effect_next_step()
+{
+    ArpSequencer arp;
+    arp.stepSamples(1000);
+    arp.enable(true);
+    ArpRun run;
+    render(arp, run, 1500, 128);
+    arp.stepSamples(600);
+    render(arp, run, 2500, 128);
+
+    TEST_ASSERT_EQUAL_INT(1000, closeAt(run, 0, 1));
+    TEST_ASSERT_EQUAL_INT(2000, closeAt(run, 1, 1001));
+    TEST_ASSERT_EQUAL_INT(2600, closeAt(run, 2, 2001));
+    TEST_ASSERT_EQUAL_INT(3200, closeAt(run, 0, 2601));
+}
+
+// Reset restarts the pattern at its first step on the next render
+static void test_reset_restarts_pattern()
+{
+    ArpSequencer arp;
+    arp.stepSamples(1000);
+    arp.enable(true);
+    ArpRun run;
+    render(arp, run, 1500, 1);
+    TEST_ASSERT_EQUAL_INT(1, arp.voice());
+    arp.reset();
+    render(arp, run, 1, 1);
+    TEST_ASSERT_EQUAL_INT(0, arp.voice());
+    // and the new first step is a full step long
+    render(arp, run, 999, 1);
+    TEST_ASSERT_EQUAL_INT(0, arp.voice());
+    render(arp, run, 1, 1);
+    TEST_ASSERT_EQUAL_INT(1, arp.voice());
+}
+
+// The gates are the same whatever the chunk size, so steps do not snap to
+// audio block boundaries
+static void test_chunk_size_independent()
+{
+    const uint32_t chunks[4] = {1, 37, 64, 128};
+    ArpRun ref;
+    for (int c = 0; c < 4; c++)
+    {
+        ArpSequencer arp;
+        arp.stepSamples(997);
+        arp.gate(0.6f);
+        arp.swing(0.2f);
+        arp.pattern(ARP_RANDOM);
+        arp.enable(true);
+        ArpRun run;
+        render(arp, run, 20000, chunks[c]);
+        if (c == 0)
+        {
+            ref = run;
+            continue;
+        }
+        for (int v = 0; v < ARP_VOICES; v++)
+            TEST_ASSERT_TRUE(run.gate[v] == ref.gate[v]);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_stopped_is_open);
+    RUN_TEST(test_up_step_grid);
+    RUN_TEST(test_pattern_order);
+    RUN_TEST(test_swing_lengths);
+    RUN_TEST(test_gate_off_position);
+    RUN_TEST(test_stab_closes_every_step);
+    RUN_TEST(test_settings_take_effect_next_step);
+    RUN_TEST(test_reset_restarts_pattern);
+    RUN_TEST(test_chunk_size_independent);
+    return UNITY_END();
+}
@@ -0,0 +1,138 @@
+// DSP kernel host tests (pio test -e native -f test_dsp)
+//
+// Checks the portable C path of dsp.cpp against straightforward reference
+// loops: the checks benchmarkDspKernels() (test.cpp) makes on the device,
+// over every length up to a block plus a few, at every alignment of the
+// input pointers (odd offsets are the unaligned case the pitch detector's
+// odd lags hit), and at full scale where the outputs saturate.
+
+#include <Arduino.h>
+#include <Audio.h>
+#include <unity.h>
+#include "dsp.h"
+
+// env:native does not build src/, so the module under test is compiled here
+#include "dsp.cpp"
+
+#define MAX_N (AUDIO_BLOCK_SAMPLES + 5)
+#define PAD 4
+
+// Deterministic samples in [-range, range)
+static uint32_t seed = 1;
+static int16_t randomSample(int32_t range)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (int16_t)((int32_t)((seed >> 8) % (uint32_t)(2 * range)) - range);
+}
+
+static void fill(int16_t *x, int n, int range)
+{
+    for (int i = 0; i < n; i++)
+        x[i] = randomSample(range);
+}
+
+static int16_t sat(int64_t v)
+{
+    return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+void setUp() { seed = 1; }
+void tearDown() {}
+
+static void test_sum_squared_diff()
+{
+    static int16_t a[MAX_N + PAD], b[MAX_N + PAD];
+    static const int ranges[] = {16384, 2};
+    for (int range : ranges)
+    {
+        fill(a, MAX_N + PAD, range);
+        fill(b, MAX_N + PAD, range);
+        for (int oa = 0; oa < PAD; oa++)
+            for (int ob = 0; ob < PAD; ob++)
+                for (int n = 0; n <= MAX_N; n++)
+                {
+                    int64_t ref = 0;
+                    for (int i = 0; i < n; i++)
+                        ref += (int64_t)(a[oa + i] - b[ob + i]) * (a[oa + i] - b[ob + i]);
+                    TEST_ASSERT_EQUAL_INT64(ref, dspSumSquaredDiff(a + oa, b + ob, n));
+                }
+    }
+
+    // Largest differences the contract allows (pre-halved full scale)
+    for (int i = 0; i < MAX_N; i++)
+    {
+        a[i] = (i & 1) ? 16383 : -16384;
+        b[i] = -a[i];
+    }
+    int64_t ref = 0;
+    for (int i = 0; i < MAX_N; i++)
+        ref += (int64_t)(a[i] - b[i]) * (a[i] - b[i]);
+    TEST_ASSERT_EQUAL_INT64(ref, dspSumSquaredDiff(a, b, MAX_N));
+}
+
+static void test_dot_product()
+{
+    static int16_t a[MAX_N + PAD], b[MAX_N + PAD];
+    // Range keeps the 32-bit sum from overflowing, as callers must
+    fill(a, MAX_N + PAD, 4096);
+    fill(b, MAX_N + PAD, 4096);
+    for (int oa = 0; oa < PAD; oa++)
+        for (int ob = 0; ob < PAD; ob++)
+            for (int n = 0; n <= MAX_N; n++)
+            {
+                int32_t ref = 0;
+                for (int i = 0; i < n; i++)
+                    ref += (int32_t)a[oa + i] * b[ob + i];
+                TEST_ASSERT_EQUAL_INT32(ref, dspDotProduct(a + oa, b + ob, n));
+            }
+}
+
+static void checkGainRamp(const int16_t *src, int n, int32_t g0, int32_t g1, int offset)
+{
+    static int16_t buf[MAX_N + PAD];
+    memcpy(buf + offset, src, n * sizeof(int16_t));
+    dspGainRamp(buf + offset, n, g0, g1);
+    int32_t g = g0;
+    int32_t step = n ? (g1 - g0) / n : 0;
+    for (int i = 0; i < n; i++, g += step)
+    {
+        int16_t ref = sat(((int64_t)g * src[i]) >> 16);
+        if (buf[offset + i] != ref)
+        {
+            char msg[96];
+            snprintf(msg, sizeof(msg), "n=%d offset=%d i=%d gain %ld->%ld", n, offset, i, (long)g0, (long)g1);
+            TEST_ASSERT_EQUAL_INT_MESSAGE(ref, buf[offset + i], msg);
+        }
+    }
+}
+
+static void test_gain_ramp()
+{
+    static int16_t x[MAX_N];
+    static const int32_t gains[][2] = {
+        {0, DSP_UNITY_GAIN * 2}, // same ramp as benchmarkDspKernels
+        {DSP_UNITY_GAIN, DSP_UNITY_GAIN},
+        {DSP_UNITY_GAIN, 0},
+        {DSP_UNITY_GAIN / 3, DSP_UNITY_GAIN * 3}, // saturates
+        {-DSP_UNITY_GAIN, DSP_UNITY_GAIN / 7},
+    };
+    fill(x, MAX_N, 32768);
+    for (const auto &g : gains)
+        for (int offset = 0; offset < PAD; offset++)
+            for (int n = 0; n <= MAX_N; n++)
+                checkGainRamp(x, n, g[0], g[1], offset);
+
+    // Full scale in both directions
+    for (int i = 0; i < MAX_N; i++)
+        x[i] = (i & 1) ? 32767 : -32768;
+    checkGainRamp(x, MAX_N, DSP_UNITY_GAIN * 4, DSP_UNITY_GAIN * 4, 1);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sum_squared_diff);
+    RUN_TEST(test_dot_product);
+    RUN_TEST(test_gain_ramp);
+    return UNITY_END();
+}
@@ -0,0 +1,168 @@
+// Audio graph audit host tests (pio test -e native -f test_graph)
+//
+// Audits the synth's real node and edge tables (audiograph.h) against
+// stand-in objects and fails on any defect, then feeds a deliberately
+// broken table and checks that every kind of defect is reported against
+// the right edge or node.
+
+#include <Arduino.h>
+#include <unity.h>
+#include "graphaudit.h"
+
+// env:native does not build src/, so the module under test is compiled here
+#include "graphaudit.cpp"
+
+// The audit only compares addresses, so the objects named by the tables
+// can be empty stand-ins
+class AudioStream
+{
+};
+class AudioConnection
+{
+};
+
+static AudioStream audioInput, noteDetect, onsetDetect, peak1, chordSynth, synthVolume, mixerLeft, mixerRight,
+    reverbSend, reverb, fdnReverb, wetDryLeft, wetDryRight, audioOutput, latencyProbe;
+static AudioConnection patchInL, patchInR, patchPitch, patchOnset, patchPeak, patchSynthGain, patchSynthToL,
+    patchSynthToR, patchReverbSend, patchReverbIn, patchFdnIn, patchDryL, patchWetL, patchFdnL, patchDryR, patchWetR,
+    patchFdnR, patchOutL, patchOutR, patchLatency;
+
+#include "audiograph.h"
+
+#define COUNT(a) ((int)(sizeof(a) / sizeof((a)[0])))
+#define MAX_DEFECTS 32
+
+static void printDefects(const GraphDefect *d, int count)
+{
+    char line[96];
+    for (int i = 0; i < count && i < MAX_DEFECTS; i++)
+    {
+        snprintf(line, sizeof(line), "%s [%d]", graphDefectName(d[i].kind), d[i].index);
+        TEST_MESSAGE(line);
+    }
+}
+
+// Is there a defect of this kind at this edge/node index?
+static bool hasDefect(const GraphDefect *d, int count, uint8_t kind, int index)
+{
+    for (int i = 0; i < count && i < MAX_DEFECTS; i++)
+        if (d[i].kind == kind && d[i].index == index)
+            return true;
+    return false;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// The shipped graph has no defects, before and after a clean connect
+static void test_real_graph_is_sound()
+{
+    GraphDefect d[MAX_DEFECTS];
+    int count = graphFindDefects(audioNodes, COUNT(audioNodes), audioEdges, COUNT(audioEdges), nullptr, d, MAX_DEFECTS);
+    printDefects(d, count);
+    TEST_ASSERT_EQUAL_INT(0, count);
+
+    int8_t status[COUNT(audioEdges)] = {0};
+    count = graphFindDefects(audioNodes, COUNT(audioNodes), audioEdges, COUNT(audioEdges), status, d, MAX_DEFECTS);
+    printDefects(d, count);
+    TEST_ASSERT_EQUAL_INT(0, count);
+}
+
+// Every object in the real node table is distinct and named
+static void test_real_nodes_unique()
+{
+    for (int i = 0; i < COUNT(audioNodes); i++)
+    {
+        TEST_ASSERT_NOT_NULL(audioNodes[i].name);
+        for (int j = 0; j < i; j++)
+        {
+            TEST_ASSERT_TRUE(audioNodes[i].object != audioNodes[j].object);
+            TEST_ASSERT_TRUE(strcmp(audioNodes[i].name, audioNodes[j].name) != 0);
+        }
+    }
+}
+
+// A broken table: one of each defect
+static AudioStream in, fx, mix, out, orphan, stray, unfed;
+static AudioConnection p[8];
+
+static const GraphNode brokenNodes[] = {
+    {"in", &in, 0, 1},
+    {"fx", &fx, 1, 1},
+    {"mix", &mix, 2, 1},
+    {"out", &out, 1, 0},
+    {"orphan", &orphan, 0, 1}, // output goes nowhere
+    {"unfed", &unfed, 1, 0},   // nothing feeds it
+};
+
+static const GraphEdge brokenEdges[] = {
+    {&p[0], &in, 0, &fx, 0},
+    {&p[1], &fx, 0, &mix, 0},
+    {&p[2], &mix, 0, &out, 0},
+    {&p[3], &fx, 0, &mix, 0},    // duplicate of edge 1
+    {&p[4], &in, 0, &mix, 0},    // mix.0 already fed by fx
+    {&p[5], &stray, 0, &mix, 1}, // stray is not in the node table
+    {&p[6], &in, 1, &fx, 1},     // in has one output, fx one input
+    {&p[7], &fx, 0, &out, 0},    // out.0 already fed by mix (and fails to connect)
+};
+
+static void test_broken_graph_defects()
+{
+    GraphDefect d[MAX_DEFECTS];
+    int count = graphFindDefects(brokenNodes, COUNT(brokenNodes), brokenEdges, COUNT(brokenEdges), nullptr, d,
+                                 MAX_DEFECTS);
+    printDefects(d, count);
+
+    TEST_ASSERT_TRUE(hasDefect(d, count, GRAPH_DUPLICATE_EDGE, 3));
+    TEST_ASSERT_TRUE(hasDefect(d, count, GRAPH_INPUT_FED_TWICE, 4));
+    TEST_ASSERT_TRUE(hasDefect(d, count, GRAPH_UNKNOWN_OBJECT, 5));
+    TEST_ASSERT_TRUE(hasDefect(d, count, GRAPH_NO_SUCH_PORT, 6));
+    TEST_ASSERT_TRUE(hasDefect(d, count, GRAPH_INPUT_FED_TWICE, 7));
+    TEST_ASSERT_TRUE(hasDefect(d, count, GRAPH_UNCONNECTED_SOURCE, 4));
+    TEST_ASSERT_TRUE(hasDefect(d, count, GRAPH_NO_INPUT, 5));
+    // nothing else: the sound edges and nodes are not flagged
+    TEST_ASSERT_EQUAL_INT(7, count);
+}
+
+// Connect results: errors are reported against their edge; 0 and -1 (not
+// attempted) are not defects
+static void test_connect_failures()
+{
+    GraphDefect d[MAX_DEFECTS];
+    int8_t status[COUNT(brokenEdges)] = {0, -1, 0, 0, 0, 0, 0, 4};
+    int count = graphFindDefects(brokenNodes, COUNT(brokenNodes), brokenEdges, COUNT(brokenEdges), status, d,
+                                 MAX_DEFECTS);
+    TEST_ASSERT_EQUAL_INT(8, count);
+    TEST_ASSERT_TRUE(hasDefect(d, count, GRAPH_CONNECT_FAILED, 7));
+    for (int i = 0; i < count; i++)
+        if (d[i].kind == GRAPH_CONNECT_FAILED)
+            TEST_ASSERT_EQUAL_INT(4, d[i].status);
+
+    // a failed connect on a real edge fails the real graph too
+    int8_t realStatus[COUNT(audioEdges)] = {0};
+    realStatus[COUNT(audioEdges) - 1] = 2;
+    count = graphFindDefects(audioNodes, COUNT(audioNodes), audioEdges, COUNT(audioEdges), realStatus, d, MAX_DEFECTS);
+    TEST_ASSERT_EQUAL_INT(1, count);
+    TEST_ASSERT_TRUE(hasDefect(d, count, GRAPH_CONNECT_FAILED, COUNT(audioEdges) - 1));
+}
+
+// Only maxDefects are stored, but all are counted
+static void test_defect_list_truncates()
+{
+    GraphDefect d[3];
+    d[2].kind = 0xFF;
+    int count = graphFindDefects(brokenNodes, COUNT(brokenNodes), brokenEdges, COUNT(brokenEdges), nullptr, d, 2);
+    TEST_ASSERT_EQUAL_INT(7, count);
+    TEST_ASSERT_EQUAL_INT(0xFF, d[2].kind);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_real_graph_is_sound);
+    RUN_TEST(test_real_nodes_unique);
+    RUN_TEST(test_broken_graph_defects);
+    RUN_TEST(test_connect_failures);
+    RUN_TEST(test_defect_list_truncates);
+    return UNITY_END();
+}
@@ -0,0 +1,216 @@
+// harmony.h host tests (pio test -e native -f test_harmony)
+//
+// Exhaustive equivalence of the chord interval tables and fast
+// frequency -> MIDI conversion with the getDiatonicThird/getDiatonicFifth
+// they replaced, over every key and mode and the whole audio range in
+// 0.1 cent steps, plus a timing loop comparing the two.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include "harmony.h"
+
+void setUp() {}
+void tearDown() {}
+
+// ----------------------
+// Original implementation (src/audio.cpp before the interval tables),
+// verbatim except for the Serial diagnostics in the fifth
+// ----------------------
+static float originalDiatonicThird(float noteFreq, int keyNote, int mode)
+{
+    // Convert frequency to MIDI note number
+    float midiNote = 12.0f * log2f(noteFreq / 440.0f) + 69.0f;
+    int noteClass = ((int)round(midiNote)) % 12; // 0-11 chromatic position
+
+    // Calculate position in scale relative to key
+    int relativePosition = (noteClass - keyNote + 12) % 12;
+
+    // Determine the third interval based on selected mode
+    int thirdSemitones = 3; // default to minor third
+
+    if (mode == 0)
+    {
+        // Major mode: diatonic selection based on scale degree
+        if (relativePosition == 0 || relativePosition == 5 || relativePosition == 7)
+        {
+            thirdSemitones = 4; // major third
+        }
+        else if (relativePosition == 2 || relativePosition == 4 || relativePosition == 9 || relativePosition == 11)
+        {
+            thirdSemitones = 3; // minor third
+        }
+    }
+    else if (mode == 1)
+    {
+        // Natural minor: diatonic selection
+        if (relativePosition == 3 || relativePosition == 8 || relativePosition == 10)
+        {
+            thirdSemitones = 4; // major third
+        }
+        else if (relativePosition == 0 || relativePosition == 2 || relativePosition == 5 || relativePosition == 7)
+        {
+            thirdSemitones = 3; // minor third
+        }
+    }
+    else if (mode == 2)
+    {
+        // Fixed Major: always major third
+        thirdSemitones = 4;
+    }
+    else if (mode == 3)
+    {
+        // Fixed Minor: always minor third
+        thirdSemitones = 3;
+    }
+
+    return powf(2.0f, thirdSemitones / 12.0f);
+}
+
+static float originalDiatonicFifth(float noteFreq, int keyNote, int mode)
+{
+    int fifthSemitones = 7; // perfect fifth by default
+
+    // Major or Natural Minor: use diminished fifth for 7th scale degree
+    if (mode == 0 || mode == 1)
+    {
+        // Determine the scale degree of the detected note
+        float midiNote = 12.0f * log2f(noteFreq / 440.0f) + 69.0f;
+        int noteClass = ((int)round(midiNote)) % 12; // 0-11 chromatic position
+        int relativePosition = (noteClass - keyNote + 12) % 12;
+
+        if (mode == 0) // Major mode
+        {
+            if (relativePosition == 11)
+                fifthSemitones = 6; // flat-5
+        }
+        else if (mode == 1) // Natural minor mode
+        {
+            if (relativePosition == 2)
+                fifthSemitones = 6; // flat-5
+        }
+    }
+    return powf(2.0f, fifthSemitones / 12.0f);
+}
+
+// ----------------------
+// Current implementation (as getDiatonicThird/Fifth in audio.cpp)
+// ----------------------
+static float tableDiatonicThird(float noteFreq, int keyNote, int mode)
+{
+    return semitoneRatio[chordThirdSemitones(keyNote, mode, freqToPitchClass(noteFreq))];
+}
+
+static float tableDiatonicFifth(float noteFreq, int keyNote, int mode)
+{
+    return semitoneRatio[chordFifthSemitones(keyNote, mode, freqToPitchClass(noteFreq))];
+}
+
+#define LOW_HZ 20.0f
+#define HIGH_HZ 5000.0f
+#define STEP_CENTS 0.1f
+// Pitch classes may only disagree this close to a half-semitone boundary
+#define BOUNDARY_CENTS 0.01f
+
+// freqToMidi stays within BOUNDARY_CENTS of the exact value
+static void test_freq_to_midi_accuracy()
+{
+    double worst = 0.0;
+    for (float c = 0.0f; c <= 1200.0f * log2f(HIGH_HZ / LOW_HZ); c += STEP_CENTS)
+    {
+        float hz = LOW_HZ * exp2f(c / 1200.0f);
+        double exact = 12.0 * log2((double)hz / 440.0) + 69.0;
+        double err = fabs((double)freqToMidi(hz) - exact) * 100.0;
+        if (err > worst)
+            worst = err;
+    }
+    printf("freqToMidi worst error %.5f cents\n", worst);
+    TEST_ASSERT_LESS_THAN(BOUNDARY_CENTS, worst);
+}
+
+// Modes -1 and 4 check the out-of-range fallbacks (minor third, perfect fifth)
+static void test_intervals_match_original()
+{
+    long compared = 0, boundary = 0;
+    for (int key = 0; key < 12; key++)
+        for (int mode = -1; mode <= HARMONY_MODES; mode++)
+            for (float c = 0.0f; c <= 1200.0f * log2f(HIGH_HZ / LOW_HZ); c += STEP_CENTS)
+            {
+                float hz = LOW_HZ * exp2f(c / 1200.0f);
+                float third = tableDiatonicThird(hz, key, mode);
+                float fifth = tableDiatonicFifth(hz, key, mode);
+                float thirdRef = originalDiatonicThird(hz, key, mode);
+                float fifthRef = originalDiatonicFifth(hz, key, mode);
+                compared++;
+                if (fabsf(third - thirdRef) <= 1e-6f * thirdRef && fabsf(fifth - fifthRef) <= 1e-6f * fifthRef)
+                    continue;
+
+                // Allowed only where rounding to the nearest note is ambiguous
+                double midi = 12.0 * log2((double)hz / 440.0) + 69.0;
+                double fromBoundary = fabs(midi - floor(midi) - 0.5) * 100.0;
+                char msg[96];
+                snprintf(msg, sizeof(msg), "key %d mode %d %.4f Hz: third %.6f/%.6f fifth %.6f/%.6f",
+                         key, mode, hz, third, thirdRef, fifth, fifthRef);
+                TEST_ASSERT_TRUE_MESSAGE(fromBoundary < BOUNDARY_CENTS, msg);
+                boundary++;
+            }
+    printf("%ld cases, %ld differ within %.2f cents of a note boundary\n", compared, boundary, BOUNDARY_CENTS);
+}
+
+// Every table entry against the original at the exact note frequency
+static void test_tables_at_note_centers()
+{
+    for (int key = 0; key < 12; key++)
+        for (int mode = 0; mode < HARMONY_MODES; mode++)
+            for (int midi = 24; midi < 108; midi++)
+            {
+                float hz = 440.0f * exp2f((midi - 69) / 12.0f);
+                TEST_ASSERT_EQUAL_INT(midi % 12, freqToPitchClass(hz));
+                TEST_ASSERT_FLOAT_WITHIN(1e-6f, originalDiatonicThird(hz, key, mode), tableDiatonicThird(hz, key, mode));
+                TEST_ASSERT_FLOAT_WITHIN(1e-6f, originalDiatonicFifth(hz, key, mode), tableDiatonicFifth(hz, key, mode));
+            }
+}
+
+static void test_octave_ratio()
+{
+    for (int shift = -1; shift <= 2; shift++)
+        TEST_ASSERT_FLOAT_WITHIN(0.0f, powf(2.0f, (float)shift), octaveRatio(shift));
+}
+
+// Timing loop: one chord's third and fifth per iteration, as startChord()
+// and updateChordTonic() compute them
+static void test_timing()
+{
+    const int N = 200000;
+    volatile float sink = 0.0f;
+    using clock = std::chrono::steady_clock;
+
+    auto t0 = clock::now();
+    for (int i = 0; i < N; i++)
+    {
+        float hz = 80.0f + (float)(i & 1023);
+        sink = sink + originalDiatonicThird(hz, i % 12, i & 1) + originalDiatonicFifth(hz, i % 12, i & 1);
+    }
+    auto t1 = clock::now();
+    for (int i = 0; i < N; i++)
+    {
+        float hz = 80.0f + (float)(i & 1023);
+        sink = sink + tableDiatonicThird(hz, i % 12, i & 1) + tableDiatonicFifth(hz, i % 12, i & 1);
+    }
+    auto t2 = clock::now();
+
+    double original = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    double table = std::chrono::duration<double, std::nano>(t2 - t1).count() / N;
+    printf("third + fifth per chord: original %.1f ns, tables %.1f ns (host)\n", original, table);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_freq_to_midi_accuracy);
+    RUN_TEST(test_intervals_match_original);
+    RUN_TEST(test_tables_at_note_centers);
+    RUN_TEST(test_octave_ratio);
+    RUN_TEST(test_timing);
+    return UNITY_END();
+}
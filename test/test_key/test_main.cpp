@@ -0,0 +1,249 @@
+// Key estimation host test (pio test -e native -f test_key)
+//
+// Replays the note streams of traditional melodies through key.cpp the
+// way pitch.cpp feeds it (one tracked pitch per detector hop while a note
+// sounds) and runs applyAutoKey() at the control rate, starting from the
+// key a tritone away. Reports, per song, whether it ends on the right key,
+// the share of control ticks spent on the right key, the time until the
+// key first became right and the time it last moved onto the right key
+// (after which it stayed).
+
+#include <Arduino.h>
+#include <unity.h>
+#include "config.h"
+#include "key.h"
+
+// env:native does not build src/, so the module under test is compiled here
+#include "key.cpp"
+
+// Settings normally owned by NVRAM.cpp
+int currentKey = 0;
+int currentMode = 0;
+
+#define HOP_MS (128.0f * 1000.0f / 44100.0f) // one estimate per detector hop
+#define CONTROL_MS 10.0f                      // applyAutoKey() period
+#define LOCK_MS 30.0f                         // no estimates while the attack settles
+#define SUSTAIN 0.9f                          // estimates stop before the note ends
+#define BEAT_MS 600.0f                        // 100 BPM
+
+struct Note
+{
+    int midi;
+    float beats;
+};
+
+struct Song
+{
+    const char *name;
+    int key;
+    int mode; // 0 = Major, 1 = Minor
+    const Note *notes;
+    int count;
+};
+
+// Ode to Joy (D major)
+static const Note odeToJoy[] = {
+    {66, 1}, {66, 1}, {67, 1}, {69, 1}, {69, 1}, {67, 1}, {66, 1}, {64, 1},
+    {62, 1}, {62, 1}, {64, 1}, {66, 1}, {66, 1.5f}, {64, 0.5f}, {64, 2},
+    {66, 1}, {66, 1}, {67, 1}, {69, 1}, {69, 1}, {67, 1}, {66, 1}, {64, 1},
+    {62, 1}, {62, 1}, {64, 1}, {66, 1}, {64, 1.5f}, {62, 0.5f}, {62, 2},
+    {64, 1}, {64, 1}, {66, 1}, {62, 1}, {64, 1}, {66, 0.5f}, {67, 0.5f}, {66, 1}, {62, 1},
+    {64, 1}, {66, 0.5f}, {67, 0.5f}, {66, 1}, {64, 1}, {62, 1}, {64, 1}, {57, 2},
+    {66, 1}, {66, 1}, {67, 1}, {69, 1}, {69, 1}, {67, 1}, {66, 1}, {64, 1},
+    {62, 1}, {62, 1}, {64, 1}, {66, 1}, {64, 1.5f}, {62, 0.5f}, {62, 2}};
+
+// Twinkle, Twinkle, Little Star (C major)
+static const Note twinkle[] = {
+    {60, 1}, {60, 1}, {67, 1}, {67, 1}, {69, 1}, {69, 1}, {67, 2},
+    {65, 1}, {65, 1}, {64, 1}, {64, 1}, {62, 1}, {62, 1}, {60, 2},
+    {67, 1}, {67, 1}, {65, 1}, {65, 1}, {64, 1}, {64, 1}, {62, 2},
+    {67, 1}, {67, 1}, {65, 1}, {65, 1}, {64, 1}, {64, 1}, {62, 2},
+    {60, 1}, {60, 1}, {67, 1}, {67, 1}, {69, 1}, {69, 1}, {67, 2},
+    {65, 1}, {65, 1}, {64, 1}, {64, 1}, {62, 1}, {62, 1}, {60, 2}};
+
+// Amazing Grace (G major, 3/4)
+static const Note amazingGrace[] = {
+    {62, 1}, {67, 2}, {71, 0.5f}, {67, 0.5f}, {71, 2}, {69, 1}, {67, 2}, {64, 1}, {62, 2},
+    {62, 1}, {67, 2}, {71, 0.5f}, {67, 0.5f}, {71, 2}, {69, 1}, {74, 3},
+    {71, 1}, {74, 1.5f}, {71, 0.5f}, {74, 0.5f}, {71, 0.5f}, {67, 2}, {62, 1}, {64, 1.5f}, {67, 0.5f}, {67, 0.5f}, {64, 0.5f}, {62, 2},
+    {62, 1}, {67, 2}, {71, 0.5f}, {67, 0.5f}, {71, 2}, {69, 1}, {67, 3}};
+
+// Frere Jacques (F major)
+static const Note frereJacques[] = {
+    {65, 1}, {67, 1}, {69, 1}, {65, 1}, {65, 1}, {67, 1}, {69, 1}, {65, 1},
+    {69, 1}, {70, 1}, {72, 2}, {69, 1}, {70, 1}, {72, 2},
+    {72, 0.5f}, {74, 0.5f}, {72, 0.5f}, {70, 0.5f}, {69, 1}, {65, 1},
+    {72, 0.5f}, {74, 0.5f}, {72, 0.5f}, {70, 0.5f}, {69, 1}, {65, 1},
+    {65, 1}, {60, 1}, {65, 2}, {65, 1}, {60, 1}, {65, 2}};
+
+// Greensleeves (A minor)
+static const Note greensleeves[] = {
+    {69, 1}, {72, 2}, {74, 1}, {76, 1.5f}, {77, 0.5f}, {76, 1}, {74, 2}, {71, 1},
+    {67, 1.5f}, {69, 0.5f}, {71, 1}, {72, 2}, {69, 1}, {69, 1.5f}, {68, 0.5f}, {69, 1},
+    {71, 2}, {68, 1}, {64, 2}, {69, 1}, {72, 2}, {74, 1}, {76, 1.5f}, {77, 0.5f}, {76, 1},
+    {74, 2}, {71, 1}, {67, 1.5f}, {69, 0.5f}, {71, 1}, {72, 1.5f}, {71, 0.5f}, {69, 1},
+    {68, 1.5f}, {66, 0.5f}, {68, 1}, {69, 3}, {69, 2}};
+
+// God Rest Ye Merry Gentlemen (E minor)
+static const Note godRestYe[] = {
+    {64, 1}, {64, 1}, {71, 1}, {71, 1}, {69, 1}, {67, 1}, {66, 1}, {64, 1},
+    {62, 1}, {64, 1}, {66, 1}, {67, 1}, {69, 1}, {71, 3},
+    {64, 1}, {64, 1}, {71, 1}, {71, 1}, {69, 1}, {67, 1}, {66, 1}, {64, 1},
+    {62, 1}, {64, 1}, {66, 1}, {67, 1}, {69, 1}, {71, 3},
+    {71, 1}, {72, 1}, {69, 1}, {71, 1}, {72, 1}, {74, 1}, {76, 1}, {71, 1},
+    {69, 1}, {67, 1}, {64, 1}, {66, 1}, {67, 1}, {69, 2},
+    {67, 1}, {69, 1}, {71, 2}, {72, 1}, {71, 1}, {69, 1}, {67, 1}, {66, 1},
+    {64, 1}, {67, 1}, {66, 1}, {64, 1}, {62, 1}, {64, 3}};
+
+#define SONG(n, k, m) {#n, k, m, n, (int)(sizeof(n) / sizeof(n[0]))}
+static const Song songs[] = {
+    SONG(odeToJoy, 2, 0),
+    SONG(twinkle, 0, 0),
+    SONG(amazingGrace, 7, 0),
+    SONG(frereJacques, 5, 0),
+    SONG(greensleeves, 9, 1),
+    SONG(godRestYe, 4, 1),
+};
+
+struct Replay
+{
+    bool correctAtEnd;
+    float accuracy;      // share of control ticks on the right key
+    float firstMs;       // time the key first became right (-1 = never)
+    float convergenceMs; // time of the last move onto the right key (-1 = never)
+};
+
+static uint32_t noiseSeed = 1;
+static float noise()
+{
+    noiseSeed = noiseSeed * 1664525u + 1013904223u;
+    return (float)(noiseSeed >> 8) / 8388608.0f - 1.0f;
+}
+
+// Play a song from t0 (ms); the key state carries over between calls
+static Replay replay(const Song &s, float t0)
+{
+    int ticks = 0, right = 0;
+    float first = -1.0f;
+    float convergence = -1.0f;
+    float t = t0;
+    float nextControl = t0;
+    for (int i = 0; i < s.count; i++)
+    {
+        float dur = s.notes[i].beats * BEAT_MS;
+        float end = t + dur;
+        for (float e = t + LOCK_MS; e < t + dur * SUSTAIN; e += HOP_MS)
+        {
+            // tracked pitch: the note plus a little vibrato/intonation
+            keyAddPitch(s.notes[i].midi * 100.0f + 8.0f * noise(), 0.9f, (unsigned long)e);
+            while (nextControl <= e)
+            {
+                applyAutoKey();
+                bool ok = (currentKey == s.key && currentMode == s.mode);
+                if (ok && first < 0.0f)
+                    first = nextControl - t0;
+                if (ok && convergence < 0.0f)
+                    convergence = nextControl - t0;
+                else if (!ok)
+                    convergence = -1.0f;
+                right += ok;
+                ticks++;
+                nextControl += CONTROL_MS;
+            }
+        }
+        t = end;
+    }
+    Replay r;
+    r.correctAtEnd = (currentKey == s.key && currentMode == s.mode);
+    r.accuracy = ticks ? (float)right / ticks : 0.0f;
+    r.firstMs = first;
+    r.convergenceMs = convergence;
+    return r;
+}
+
+static float songMs(const Song &s)
+{
+    float beats = 0.0f;
+    for (int i = 0; i < s.count; i++)
+        beats += s.notes[i].beats;
+    return beats * BEAT_MS;
+}
+
+void setUp()
+{
+    resetKeyEstimate();
+    noiseSeed = 1;
+}
+void tearDown() {}
+
+static void test_songs()
+{
+    printf("%-14s %-6s %6s %9s %9s %10s\n", "song", "key", "end ok", "accuracy", "first ms", "settled ms");
+    const char *keyNames[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+    float t0 = 0.0f;
+    float accuracySum = 0.0f;
+    for (const Song &s : songs)
+    {
+        resetKeyEstimate();
+        currentKey = (s.key + 6) % 12; // start from the furthest key
+        currentMode = s.mode;
+        Replay r = replay(s, t0);
+        t0 += songMs(s) + 60000.0f;
+        char key[8];
+        snprintf(key, sizeof(key), "%s%s", keyNames[s.key], s.mode ? "m" : "");
+        printf("%-14s %-6s %6s %8.0f%% %9.0f %10.0f\n", s.name, key, r.correctAtEnd ? "yes" : "NO",
+               r.accuracy * 100.0f, r.firstMs, r.convergenceMs);
+        TEST_ASSERT_TRUE_MESSAGE(r.correctAtEnd, s.name);
+        TEST_ASSERT_TRUE_MESSAGE(r.firstMs >= 0.0f && r.firstMs < 8000.0f, s.name);
+        TEST_ASSERT_TRUE_MESSAGE(r.accuracy >= 0.65f, s.name);
+        accuracySum += r.accuracy;
+    }
+    float mean = accuracySum / (sizeof(songs) / sizeof(songs[0]));
+    printf("mean accuracy %.0f%%\n", mean * 100.0f);
+    TEST_ASSERT_GREATER_OR_EQUAL(0.8f, mean);
+}
+
+// Without a reset, a new song in another key takes over as the old
+// histogram decays
+static void test_key_change()
+{
+    currentKey = 0;
+    currentMode = 0;
+    Replay a = replay(songs[1], 0.0f); // twinkle, C major
+    TEST_ASSERT_TRUE(a.correctAtEnd);
+    Replay b = replay(songs[0], songMs(songs[1])); // ode to joy, D major
+    printf("C major -> D major: converged after %.0f ms\n", b.convergenceMs);
+    TEST_ASSERT_TRUE(b.correctAtEnd);
+    TEST_ASSERT_LESS_THAN(2.0f * KEY_DECAY_MS, b.convergenceMs);
+}
+
+// Fixed-interval modes are left alone
+static void test_fixed_interval_mode_untouched()
+{
+    currentKey = 3;
+    currentMode = 2;
+    replay(songs[1], 0.0f);
+    TEST_ASSERT_EQUAL_INT(3, currentKey);
+    TEST_ASSERT_EQUAL_INT(2, currentMode);
+}
+
+// Nothing is reported before KEY_MIN_WEIGHT of evidence
+static void test_min_weight()
+{
+    int key, mode;
+    float confidence;
+    keyAddPitch(6000.0f, KEY_MIN_WEIGHT * 0.5f, 0);
+    TEST_ASSERT_FALSE(getKeyEstimate(key, mode, confidence));
+    keyAddPitch(6700.0f, KEY_MIN_WEIGHT * 0.6f, 0);
+    TEST_ASSERT_TRUE(getKeyEstimate(key, mode, confidence));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_songs);
+    RUN_TEST(test_key_change);
+    RUN_TEST(test_fixed_interval_mode_untouched);
+    RUN_TEST(test_min_weight);
+    return UNITY_END();
+}
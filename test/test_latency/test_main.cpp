@@ -0,0 +1,209 @@
+// Latency trace host tests (pio test -e native -f test_latency)
+//
+// Replays FS1 traces (switch edge, pitch, chord and first output stamps) through latencyMarkAt() and checks the per-stage statistics,
+// the stage ordering rules, trace timeouts and the output watch hook that
+// arms the audio probe.
+
+#include <Arduino.h>
+#include <unity.h>
+#include "latency.h"
+
+// env:native does not build src/, so the module under test is compiled here
+#include "latency.cpp"
+
+// Output watch hook calls
+static int watchOn = 0, watchOff = 0;
+static void watch(bool active)
+{
+    if (active)
+        watchOn++;
+    else
+        watchOff++;
+}
+
+static uint32_t simUs = 0;
+static uint32_t simClock() { return simUs; }
+
+void setUp()
+{
+    latencyReset();
+    latencySetOutputWatch(watch);
+    latencySetClock(simClock);
+    watchOn = watchOff = 0;
+}
+
+void tearDown() {}
+
+// Stamps of one FS1 press; 0 = stage not reached
+struct Trace
+{
+    uint32_t edge, pitch, chord, output;
+};
+
+// A playing session: presses a second or more apart with 27-43 ms to the
+// first pitch, one press that never produced a pitch (microseconds)
+static const Trace session[] = {
+    {1000000, 1031500, 1032100, 1035400},
+    {2500000, 2528900, 2529300, 2532800},
+    {4100000, 4142700, 4143200, 4146100},
+    {5300000, 5327400, 5328000, 5331300},
+    {6900000, 6935100, 6935600, 6938700},
+    {8000000, 0, 0, 0}, // no pitch (muted strings)
+    {9200000, 9230800, 9231300, 9234900},
+    {10400000, 10433300, 10433700, 10437200},
+};
+
+static void replay(const Trace &t)
+{
+    latencyMarkAt(LATENCY_SWITCH_EDGE, t.edge);
+    if (t.pitch)
+        latencyMarkAt(LATENCY_PITCH_AVAILABLE, t.pitch);
+    if (t.chord)
+        latencyMarkAt(LATENCY_CHORD_SET, t.chord);
+    if (t.output)
+        latencyMarkAt(LATENCY_FIRST_OUTPUT, t.output);
+}
+
+static void test_session_traces()
+{
+    for (const Trace &t : session)
+        replay(t);
+
+    // Expected statistics straight from the stamps
+    const int stageCount = LATENCY_STAGE_COUNT;
+    for (int stage = LATENCY_PITCH_AVAILABLE; stage < stageCount; stage++)
+    {
+        uint32_t n = 0, lo = 0xFFFFFFFF, hi = 0;
+        uint64_t sum = 0;
+        for (const Trace &t : session)
+        {
+            uint32_t at = (stage == LATENCY_PITCH_AVAILABLE) ? t.pitch : (stage == LATENCY_CHORD_SET) ? t.chord : t.output;
+            if (!at)
+                continue;
+            uint32_t d = at - t.edge;
+            n++;
+            sum += d;
+            lo = (d < lo) ? d : lo;
+            hi = (d > hi) ? d : hi;
+        }
+        LatencySummary s;
+        TEST_ASSERT_TRUE(latencySummary((LatencyStage)stage, s));
+        TEST_ASSERT_EQUAL_UINT32(n, s.count);
+        TEST_ASSERT_EQUAL_UINT32(lo, s.minUs);
+        TEST_ASSERT_EQUAL_UINT32(hi, s.maxUs);
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)(sum / n), s.avgUs);
+        // fewer than 100 samples: p99 is the max, capped at it
+        TEST_ASSERT_EQUAL_UINT32(hi, s.p99Us);
+        printf("%-7s n=%lu min=%lu avg=%lu max=%lu\n", latencyStageName((LatencyStage)stage),
+               (unsigned long)s.count, (unsigned long)s.minUs, (unsigned long)s.avgUs, (unsigned long)s.maxUs);
+    }
+
+    // One arm per chord, one disarm per press
+    TEST_ASSERT_EQUAL_INT(7, watchOn);
+    TEST_ASSERT_EQUAL_INT(8, watchOff);
+}
+
+// p99 is the upper edge of the bin holding the 99th percentile
+static void test_p99()
+{
+    for (int i = 0; i < 200; i++)
+    {
+        uint32_t edge = 1000000u * (i + 1);
+        latencyMarkAt(LATENCY_SWITCH_EDGE, edge);
+        // 198 fast presses around 10 ms, two slow ones at 40 ms
+        uint32_t d = (i == 50 || i == 150) ? 40000 : 10000 + (i % 7) * 100;
+        latencyMarkAt(LATENCY_PITCH_AVAILABLE, edge + d);
+    }
+    LatencySummary s;
+    latencySummary(LATENCY_PITCH_AVAILABLE, s);
+    TEST_ASSERT_EQUAL_UINT32(200, s.count);
+    TEST_ASSERT_EQUAL_UINT32(40000, s.maxUs);
+    // 99% target = 198 samples, all at or below 10600 us -> bin 42 (10500..10750)
+    TEST_ASSERT_EQUAL_UINT32(10750, s.p99Us);
+}
+
+static void test_stage_rules()
+{
+    // Output before the chord is set is not this trace's output
+    latencyMarkAt(LATENCY_SWITCH_EDGE, 1000);
+    latencyMarkAt(LATENCY_FIRST_OUTPUT, 2000);
+    // Only the first stamp of a stage counts
+    latencyMarkAt(LATENCY_PITCH_AVAILABLE, 5000);
+    latencyMarkAt(LATENCY_PITCH_AVAILABLE, 9000);
+    latencyMarkAt(LATENCY_CHORD_SET, 6000);
+    latencyMarkAt(LATENCY_FIRST_OUTPUT, 8000);
+    // The trace ended with its output: later stamps are ignored
+    latencyMarkAt(LATENCY_CHORD_SET, 12000);
+
+    LatencySummary s;
+    latencySummary(LATENCY_PITCH_AVAILABLE, s);
+    TEST_ASSERT_EQUAL_UINT32(1, s.count);
+    TEST_ASSERT_EQUAL_UINT32(4000, s.maxUs);
+    latencySummary(LATENCY_CHORD_SET, s);
+    TEST_ASSERT_EQUAL_UINT32(1, s.count);
+    TEST_ASSERT_EQUAL_UINT32(5000, s.maxUs);
+    latencySummary(LATENCY_FIRST_OUTPUT, s);
+    TEST_ASSERT_EQUAL_UINT32(1, s.count);
+    TEST_ASSERT_EQUAL_UINT32(7000, s.maxUs);
+
+    // Stamps without a trace are ignored
+    latencyReset();
+    latencyMarkAt(LATENCY_PITCH_AVAILABLE, 20000);
+    TEST_ASSERT_FALSE(latencySummary(LATENCY_PITCH_AVAILABLE, s));
+}
+
+static void test_timeout()
+{
+    latencyMarkAt(LATENCY_SWITCH_EDGE, 0);
+    latencyMarkAt(LATENCY_PITCH_AVAILABLE, LATENCY_TRACE_TIMEOUT_US + 1);
+    latencyMarkAt(LATENCY_CHORD_SET, LATENCY_TRACE_TIMEOUT_US + 2);
+    LatencySummary s;
+    TEST_ASSERT_FALSE(latencySummary(LATENCY_PITCH_AVAILABLE, s));
+    TEST_ASSERT_FALSE(latencySummary(LATENCY_CHORD_SET, s));
+    TEST_ASSERT_EQUAL_INT(0, watchOn);
+}
+
+// Late samples land in the last histogram bin, which has no upper edge:
+// p99 there is the real maximum
+static void test_histogram_overflow()
+{
+    latencyMarkAt(LATENCY_SWITCH_EDGE, 0);
+    latencyMarkAt(LATENCY_PITCH_AVAILABLE, 500000);
+    LatencySummary s;
+    latencySummary(LATENCY_PITCH_AVAILABLE, s);
+    TEST_ASSERT_EQUAL_UINT32(500000, s.maxUs);
+    TEST_ASSERT_EQUAL_UINT32(500000, s.p99Us);
+}
+
+static void test_clock_wrap()
+{
+    latencyMarkAt(LATENCY_SWITCH_EDGE, 0xFFFFF000u);
+    latencyMarkAt(LATENCY_PITCH_AVAILABLE, 0x00000800u);
+    LatencySummary s;
+    latencySummary(LATENCY_PITCH_AVAILABLE, s);
+    TEST_ASSERT_EQUAL_UINT32(0x1800, s.maxUs);
+}
+
+static void test_mark_uses_clock()
+{
+    simUs = 100000;
+    latencyMark(LATENCY_SWITCH_EDGE);
+    simUs = 130250;
+    latencyMark(LATENCY_PITCH_AVAILABLE);
+    LatencySummary s;
+    latencySummary(LATENCY_PITCH_AVAILABLE, s);
+    TEST_ASSERT_EQUAL_UINT32(30250, s.maxUs);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_session_traces);
+    RUN_TEST(test_p99);
+    RUN_TEST(test_stage_rules);
+    RUN_TEST(test_timeout);
+    RUN_TEST(test_histogram_overflow);
+    RUN_TEST(test_clock_wrap);
+    RUN_TEST(test_mark_uses_clock);
+    return UNITY_END();
+}
@@ -0,0 +1,194 @@
+// Scheduler host tests (pio test -e native -f test_scheduler)
+//
+// Runs the scheduler core against a simulated clock: loop passes and task
+// run times advance the clock by exact amounts, so periods, jitter and
+// overrun skipping can be checked to the microsecond.
+
+#include <Arduino.h>
+#include <unity.h>
+#include "scheduler.h"
+
+// env:native does not build src/, so the module under test is compiled here
+#include "scheduler.cpp"
+
+static uint32_t simUs = 0;
+static uint32_t simClock() { return simUs; }
+
+// Task bodies record when they ran and take runCostUs of simulated time
+static uint32_t runTimes[1024];
+static int runCount = 0;
+static uint32_t runCostUs = 0;
+static void task()
+{
+    if (runCount < 1024)
+        runTimes[runCount] = simUs;
+    runCount++;
+    simUs += runCostUs;
+}
+
+static bool triggerValue = false;
+static bool trigger() { return triggerValue; }
+
+// Loop passes every passUs until the clock reaches endUs
+static void runUntil(uint32_t endUs, uint32_t passUs)
+{
+    while ((int32_t)(endUs - simUs) > 0)
+    {
+        schedulerRun();
+        simUs += passUs;
+    }
+}
+
+void setUp()
+{
+    schedulerClear();
+    schedulerSetClock(simClock);
+    simUs = 0;
+    runCount = 0;
+    runCostUs = 0;
+    triggerValue = false;
+}
+
+void tearDown() {}
+
+static void test_periodic_runs_on_its_grid()
+{
+    int id = schedulerAddPeriodic("p", task, 1000);
+    runUntil(100000, 50);
+    TaskStats s;
+    TEST_ASSERT_TRUE(schedulerGetStats(id, s));
+    TEST_ASSERT_EQUAL_UINT32(99, s.runs); // first run one period after registration
+    TEST_ASSERT_EQUAL_UINT32(0, s.overruns);
+    TEST_ASSERT_EQUAL_UINT32(0, s.maxJitterUs);
+    for (int i = 0; i < runCount; i++)
+        TEST_ASSERT_EQUAL_UINT32(1000u * (i + 1), runTimes[i]);
+}
+
+// Passes every 300 us against a 1000 us period: due at 1000, first pass
+// at 1200 (200 late), then 2100 (100 late), 3000 (on time), ...
+static void test_jitter_is_worst_lateness()
+{
+    int id = schedulerAddPeriodic("p", task, 1000);
+    runUntil(30000, 300);
+    TaskStats s;
+    schedulerGetStats(id, s);
+    TEST_ASSERT_EQUAL_UINT32(200, s.maxJitterUs);
+    TEST_ASSERT_EQUAL_UINT32(0, s.overruns);
+    // Lateness does not accumulate: the schedule stays on the 1000 us grid
+    TEST_ASSERT_EQUAL_UINT32(29, s.runs);
+    TEST_ASSERT_EQUAL_UINT32(29100, runTimes[28]);
+}
+
+// A stall of several periods is one overrun and one run, not a burst, and
+// the task stays in phase
+static void test_overrun_skips_missed_slots()
+{
+    int id = schedulerAddPeriodic("p", task, 1000);
+    runUntil(5000, 100);
+    TEST_ASSERT_EQUAL_INT(4, runCount); // 1000..4000
+    simUs = 9500;                       // main loop blocked for 4.5 periods
+    schedulerRun();
+    schedulerRun();
+    TEST_ASSERT_EQUAL_INT(5, runCount);
+    TaskStats s;
+    schedulerGetStats(id, s);
+    TEST_ASSERT_EQUAL_UINT32(1, s.overruns);
+    TEST_ASSERT_EQUAL_UINT32(4500, s.maxJitterUs);
+    runUntil(12000, 100);
+    TEST_ASSERT_EQUAL_INT(7, runCount);
+    TEST_ASSERT_EQUAL_UINT32(10000, runTimes[5]);
+    TEST_ASSERT_EQUAL_UINT32(11000, runTimes[6]);
+}
+
+// A task that takes longer than its period runs back to back, and every
+// other start is a full period late
+static void test_slow_task()
+{
+    int id = schedulerAddPeriodic("p", task, 1000);
+    runCostUs = 1500;
+    runUntil(20000, 10);
+    TaskStats s;
+    schedulerGetStats(id, s);
+    TEST_ASSERT_EQUAL_UINT32(1500, s.maxRunUs);
+    for (int i = 1; i < runCount; i++)
+        TEST_ASSERT_EQUAL_UINT32(1510, runTimes[i] - runTimes[i - 1]); // run + one 10 us pass
+    TEST_ASSERT_EQUAL_UINT32(13, s.runs);
+    TEST_ASSERT_EQUAL_UINT32(6, s.overruns);
+}
+
+static void test_triggered_deadline()
+{
+    int id = schedulerAddTriggered("t", task, trigger, 3000);
+    runUntil(10000, 1000);
+    TEST_ASSERT_EQUAL_INT(0, runCount);
+    triggerValue = true;
+    schedulerRun();
+    TEST_ASSERT_EQUAL_INT(1, runCount);
+    simUs += 5000; // one slow pass
+    schedulerRun();
+    simUs += 1000;
+    schedulerRun();
+    TaskStats s;
+    schedulerGetStats(id, s);
+    TEST_ASSERT_EQUAL_UINT32(3, s.runs);
+    TEST_ASSERT_EQUAL_UINT32(5000, s.maxJitterUs);
+    TEST_ASSERT_EQUAL_UINT32(1, s.overruns);
+}
+
+// Tasks run in the order they were added; stats reset keeps the schedule
+static void test_order_and_reset()
+{
+    int a = schedulerAddPeriodic("a", task, 1000);
+    int b = schedulerAddPeriodic("b", task, 500);
+    TEST_ASSERT_EQUAL_INT(0, a);
+    TEST_ASSERT_EQUAL_INT(1, b);
+    runUntil(2000, 100);
+    TaskStats s;
+    schedulerGetStats(b, s);
+    TEST_ASSERT_EQUAL_UINT32(3, s.runs);
+    schedulerResetStats();
+    schedulerGetStats(b, s);
+    TEST_ASSERT_EQUAL_UINT32(0, s.runs);
+    TEST_ASSERT_EQUAL_STRING("b", s.name);
+    runUntil(3000, 100);
+    schedulerGetStats(b, s);
+    TEST_ASSERT_EQUAL_UINT32(2, s.runs);
+    TEST_ASSERT_FALSE(schedulerGetStats(2, s));
+    TEST_ASSERT_FALSE(schedulerGetStats(-1, s));
+}
+
+static void test_clock_wrap()
+{
+    simUs = 0xFFFFFFFFu - 4500;
+    int id = schedulerAddPeriodic("p", task, 1000);
+    runUntil(simUs + 10000, 100);
+    TaskStats s;
+    schedulerGetStats(id, s);
+    TEST_ASSERT_EQUAL_UINT32(9, s.runs);
+    TEST_ASSERT_EQUAL_UINT32(0, s.overruns);
+    TEST_ASSERT_EQUAL_UINT32(0, s.maxJitterUs);
+}
+
+static void test_registration_limits()
+{
+    TEST_ASSERT_EQUAL_INT(-1, schedulerAddPeriodic("x", nullptr, 1000));
+    TEST_ASSERT_EQUAL_INT(-1, schedulerAddPeriodic("x", task, 0));
+    TEST_ASSERT_EQUAL_INT(-1, schedulerAddTriggered("x", task, nullptr, 1000));
+    for (int i = 0; i < SCHEDULER_MAX_TASKS; i++)
+        TEST_ASSERT_EQUAL_INT(i, schedulerAddPeriodic("x", task, 1000));
+    TEST_ASSERT_EQUAL_INT(-1, schedulerAddPeriodic("x", task, 1000));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_periodic_runs_on_its_grid);
+    RUN_TEST(test_jitter_is_worst_lateness);
+    RUN_TEST(test_overrun_skips_missed_slots);
+    RUN_TEST(test_slow_task);
+    RUN_TEST(test_triggered_deadline);
+    RUN_TEST(test_order_and_reset);
+    RUN_TEST(test_clock_wrap);
+    RUN_TEST(test_registration_limits);
+    return UNITY_END();
+}
@@ -0,0 +1,201 @@
+// SynthEnvelope host tests (pio test -e native -f test_synth_envelope)
+//
+// Renders envelopes block by block as the chord engine does and checks
+// the attack, decay, sustain and release levels against their timing to
+// the sample, for both curves, and that retriggering or releasing
+// mid-segment continues from the current level without a jump.
+
+#include <Arduino.h>
+#include <Audio.h>
+#include <unity.h>
+#include <vector>
+#include "synth.h"
+
+// env:native does not build src/, so the module under test is compiled here
+#include "synth.cpp"
+#include "arp.cpp"
+
+#define UNITY_Q16 65536
+#define MS(ms) ((uint32_t)((ms) * (AUDIO_SAMPLE_RATE_EXACT / 1000.0f)))
+
+// Render whole blocks until at least n samples are out; an idle block
+// renders as silence
+static std::vector<int32_t> render(SynthEnvelope &env, size_t n)
+{
+    std::vector<int32_t> out;
+    int32_t block[AUDIO_BLOCK_SAMPLES];
+    while (out.size() < n)
+    {
+        if (!env.render(block))
+            for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+                block[i] = 0;
+        out.insert(out.end(), block, block + AUDIO_BLOCK_SAMPLES);
+    }
+    return out;
+}
+
+// Largest change between neighbouring samples, including from 'before'
+static int32_t maxStep(const std::vector<int32_t> &x, int32_t before)
+{
+    int32_t worst = 0, prev = before;
+    for (int32_t v : x)
+    {
+        worst = std::max(worst, abs(v - prev));
+        prev = v;
+    }
+    return worst;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_idle_is_silent()
+{
+    SynthEnvelope env;
+    int32_t block[AUDIO_BLOCK_SAMPLES];
+    TEST_ASSERT_FALSE(env.render(block));
+    TEST_ASSERT_FALSE(env.active());
+}
+
+// Linear ADSR: each segment lands exactly on its target at its length
+static void test_linear_adsr_levels()
+{
+    SynthEnvelope env;
+    env.set({10.0f, 20.0f, 0.5f, ENV_LINEAR});
+    env.noteOn();
+    uint32_t a = MS(10.0f), d = MS(20.0f);
+    std::vector<int32_t> x = render(env, a + d + 1000);
+
+    TEST_ASSERT_EQUAL_INT32(0, x[0]);
+    for (uint32_t i = 0; i < a; i++)
+        TEST_ASSERT_INT32_WITHIN(UNITY_Q16 / 200 + 2, (int64_t)UNITY_Q16 * i / a, x[i]);
+    TEST_ASSERT_EQUAL_INT32(UNITY_Q16, x[a]); // peak at the end of the attack
+    for (uint32_t i = 0; i < d; i++)
+        TEST_ASSERT_INT32_WITHIN(UNITY_Q16 / 200 + 2, UNITY_Q16 - (int64_t)(UNITY_Q16 / 2) * i / d, x[a + i]);
+    for (size_t i = a + d; i < x.size(); i++)
+        TEST_ASSERT_EQUAL_INT32(UNITY_Q16 / 2, x[i]); // sustain holds exactly
+    TEST_ASSERT_TRUE(env.gated());
+
+    // Release to silence in the release time, then idle
+    env.noteOff(30.0f);
+    uint32_t r = MS(30.0f);
+    std::vector<int32_t> y = render(env, r + 2 * AUDIO_BLOCK_SAMPLES);
+    TEST_ASSERT_FALSE(env.gated());
+    TEST_ASSERT_EQUAL_INT32(UNITY_Q16 / 2, y[0]);
+    for (uint32_t i = 0; i < r; i++)
+        TEST_ASSERT_INT32_WITHIN(UNITY_Q16 / 200 + 2, (int64_t)(UNITY_Q16 / 2) * (r - i) / r, y[i]);
+    for (size_t i = r; i < y.size(); i++)
+        TEST_ASSERT_EQUAL_INT32(0, y[i]);
+    TEST_ASSERT_FALSE(env.active());
+}
+
+// Exponential segments move fast first, settle slowly and still land on
+// the target at the segment's end
+static void test_exponential_shape()
+{
+    SynthEnvelope env;
+    env.set({20.0f, 50.0f, 0.25f, ENV_EXPONENTIAL});
+    env.noteOn();
+    uint32_t a = MS(20.0f), d = MS(50.0f);
+    std::vector<int32_t> x = render(env, a + d + 256);
+
+    // (1 - e^(-5x)) / (1 - e^-5) at a fifth of the attack: 63.6%
+    TEST_ASSERT_INT32_WITHIN(UNITY_Q16 / 100, (int32_t)(0.6364f * UNITY_Q16), x[a / 5]);
+    for (uint32_t i = 1; i < a; i++)
+        TEST_ASSERT_TRUE(x[i] >= x[i - 1]);
+    TEST_ASSERT_EQUAL_INT32(UNITY_Q16, x[a]);
+    for (uint32_t i = a + 1; i < a + d; i++)
+        TEST_ASSERT_TRUE(x[i] <= x[i - 1]);
+    TEST_ASSERT_EQUAL_INT32(UNITY_Q16 / 4, x[a + d]);
+    TEST_ASSERT_EQUAL_INT32(UNITY_Q16 / 4, x.back());
+}
+
+// Zero-length segments jump straight to their target
+static void test_instant_segments()
+{
+    SynthEnvelope env;
+    env.set({0.0f, 0.0f, 0.8f, ENV_LINEAR});
+    env.noteOn();
+    std::vector<int32_t> x = render(env, AUDIO_BLOCK_SAMPLES);
+    TEST_ASSERT_EQUAL_INT32((int32_t)(0.8f * UNITY_Q16), x[0]);
+    env.noteOff(0.0f);
+    int32_t block[AUDIO_BLOCK_SAMPLES];
+    env.render(block);
+    TEST_ASSERT_FALSE(env.render(block));
+}
+
+// Retrigger during the release: the new attack starts from the level the
+// release had reached, and rises to the peak in the full attack time
+static void test_retrigger_from_release_is_continuous()
+{
+    for (int c = ENV_LINEAR; c <= ENV_EXPONENTIAL; c++)
+    {
+        SynthEnvelope env;
+        env.set({5.0f, 10.0f, 0.7f, (uint8_t)c});
+        env.noteOn();
+        std::vector<int32_t> x = render(env, MS(40.0f));
+        env.noteOff(100.0f);
+        std::vector<int32_t> y = render(env, MS(30.0f)); // partway down
+        int32_t reached = y.back();
+        TEST_ASSERT_TRUE(reached > 0 && reached < (int32_t)(0.7f * UNITY_Q16));
+
+        env.noteOn();
+        std::vector<int32_t> z = render(env, MS(5.0f) + AUDIO_BLOCK_SAMPLES);
+        TEST_ASSERT_EQUAL_INT32(reached, z[0]);
+        // no step bigger than the fastest segment's slope
+        TEST_ASSERT_LESS_OR_EQUAL((int32_t)(UNITY_Q16 / MS(5.0f)) * 6, maxStep(z, reached));
+        TEST_ASSERT_EQUAL_INT32(UNITY_Q16, z[MS(5.0f)]);
+    }
+}
+
+// Retrigger during the attack and release during the attack both continue
+// from the current level
+static void test_mid_attack_changes_are_continuous()
+{
+    SynthEnvelope env;
+    env.set({50.0f, 10.0f, 1.0f, ENV_LINEAR});
+    env.noteOn();
+    std::vector<int32_t> x = render(env, MS(20.0f));
+    int32_t reached = x.back();
+    TEST_ASSERT_INT32_WITHIN(UNITY_Q16 / 50, (int64_t)UNITY_Q16 * x.size() / MS(50.0f), reached);
+
+    env.noteOn();
+    std::vector<int32_t> y = render(env, AUDIO_BLOCK_SAMPLES);
+    TEST_ASSERT_EQUAL_INT32(reached, y[0]);
+    TEST_ASSERT_LESS_OR_EQUAL((int32_t)(UNITY_Q16 / MS(50.0f)) + 2, maxStep(y, reached));
+
+    reached = y.back();
+    env.noteOff(20.0f);
+    std::vector<int32_t> z = render(env, MS(20.0f) + AUDIO_BLOCK_SAMPLES);
+    TEST_ASSERT_EQUAL_INT32(reached, z[0]);
+    TEST_ASSERT_LESS_OR_EQUAL(reached / (int32_t)MS(20.0f) + 2, maxStep(z, reached));
+    TEST_ASSERT_EQUAL_INT32(0, z.back());
+}
+
+// Settings changed while a note holds apply to the next segment started
+static void test_settings_apply_on_next_segment()
+{
+    SynthEnvelope env;
+    env.set({1.0f, 1.0f, 1.0f, ENV_LINEAR});
+    env.noteOn();
+    render(env, MS(10.0f));
+    env.set({1.0f, 1.0f, 0.3f, ENV_LINEAR});
+    std::vector<int32_t> x = render(env, AUDIO_BLOCK_SAMPLES);
+    TEST_ASSERT_EQUAL_INT32(UNITY_Q16, x.back()); // sustain keeps its level
+    env.noteOn();
+    x = render(env, MS(5.0f));
+    TEST_ASSERT_EQUAL_INT32((int32_t)(0.3f * UNITY_Q16), x.back());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_idle_is_silent);
+    RUN_TEST(test_linear_adsr_levels);
+    RUN_TEST(test_exponential_shape);
+    RUN_TEST(test_instant_segments);
+    RUN_TEST(test_retrigger_from_release_is_continuous);
+    RUN_TEST(test_mid_attack_changes_are_continuous);
+    RUN_TEST(test_settings_apply_on_next_segment);
+    return UNITY_END();
+}
@@ -0,0 +1,225 @@
+// Chord engine vibrato host tests (pio test -e native -f test_synth_vibrato)
+//
+// Renders one voice of AudioSynthChord with its audio-rate pitch LFO and
+// checks the result as FM: the sidebands sit at multiples of the LFO rate
+// around the carrier with the Bessel J_k(beta) shape, nothing else comes
+// up, and the instantaneous frequency swings over carrier +/- depth,
+// moving smoothly across block boundaries.
+
+#include <Arduino.h>
+#include <Audio.h>
+#include <unity.h>
+#include <vector>
+#include "synth.h"
+
+// env:native does not build src/, so the module under test is compiled here
+#include "synth.cpp"
+#include "arp.cpp"
+
+#define FS AUDIO_SAMPLE_RATE_EXACT
+#define CARRIER_HZ 1000.0f
+#define LFO_HZ 6.0f
+#define DEPTH 0.015f // +/-1.5%, organ vibrato: beta = 15 Hz / 6 Hz = 2.5
+
+// One voice playing a sine at CARRIER_HZ; the others are silent
+static void startVoice(AudioSynthChord &synth)
+{
+    synth.envelopeSettings({0.0f, 0.0f, 1.0f, ENV_LINEAR});
+    synth.osc[0].begin(WAVEFORM_SINE);
+    synth.osc[0].frequency(CARRIER_HZ);
+    synth.osc[0].amplitude(0.5f);
+    synth.noteOn();
+}
+
+// Render n samples (whole blocks)
+static std::vector<float> render(AudioSynthChord &synth, size_t n)
+{
+    std::vector<float> out;
+    while (out.size() < n)
+    {
+        synth.hostUpdate();
+        const int16_t *b = synth.hostOutput();
+        for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+            out.push_back(b ? b[i] / 32768.0f : 0.0f);
+    }
+    out.resize(n);
+    return out;
+}
+
+// Peak amplitude of the component at one frequency (Hann-windowed DFT)
+static float magnitudeAt(const std::vector<float> &x, float hz)
+{
+    double re = 0.0, im = 0.0, wsum = 0.0;
+    const double w = 2.0 * M_PI * hz / FS;
+    const size_t n = x.size();
+    for (size_t i = 0; i < n; i++)
+    {
+        double win = 0.5 - 0.5 * cos(2.0 * M_PI * i / n);
+        re += x[i] * win * cos(w * i);
+        im -= x[i] * win * sin(w * i);
+        wsum += win;
+    }
+    return (float)(2.0 * sqrt(re * re + im * im) / wsum);
+}
+
+// Bessel function of the first kind, from its power series
+static double besselJ(int k, double x)
+{
+    double sum = 0.0, term = 1.0;
+    for (int i = 1; i <= k; i++)
+        term *= (x / 2.0) / i;
+    for (int m = 0; m < 40; m++)
+    {
+        sum += term;
+        term *= -(x / 2.0) * (x / 2.0) / ((m + 1.0) * (m + 1.0 + k));
+    }
+    return sum;
+}
+
+// Instantaneous frequency per cycle, from interpolated upward zero
+// crossings
+static std::vector<float> cycleFrequencies(const std::vector<float> &x)
+{
+    std::vector<float> f;
+    double last = -1.0;
+    for (size_t i = 1; i < x.size(); i++)
+    {
+        if (x[i - 1] < 0.0f && x[i] >= 0.0f)
+        {
+            double t = (i - 1) + x[i - 1] / (x[i - 1] - x[i]);
+            if (last >= 0.0)
+                f.push_back((float)(FS / (t - last)));
+            last = t;
+        }
+    }
+    return f;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// No depth: a clean carrier with no sidebands
+static void test_no_vibrato_is_pure()
+{
+    AudioSynthChord synth;
+    startVoice(synth);
+    synth.vibrato(LFO_HZ, 0.0f);
+    render(synth, 4410);
+    std::vector<float> x = render(synth, 44100);
+
+    float carrier = magnitudeAt(x, CARRIER_HZ);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.5f, carrier);
+    for (int k = 1; k <= 4; k++)
+    {
+        TEST_ASSERT_LESS_THAN_FLOAT(carrier * 1e-4f, magnitudeAt(x, CARRIER_HZ + k * LFO_HZ));
+        TEST_ASSERT_LESS_THAN_FLOAT(carrier * 1e-4f, magnitudeAt(x, CARRIER_HZ - k * LFO_HZ));
+    }
+}
+
+// Sidebands at carrier +/- k x rate follow |J_k(beta)|, relative to the
+// total, on both sides
+static void test_sideband_shape()
+{
+    const double beta = CARRIER_HZ * DEPTH / LFO_HZ;
+    AudioSynthChord synth;
+    startVoice(synth);
+    synth.vibrato(LFO_HZ, DEPTH);
+    render(synth, (size_t)FS); // let rate and depth settle
+    std::vector<float> x = render(synth, (size_t)FS);
+
+    // the sidebands carry all the power: sum |J_k|^2 = 1
+    double power = 0.0;
+    float mag[2][9];
+    for (int k = 0; k <= 8; k++)
+    {
+        mag[0][k] = magnitudeAt(x, CARRIER_HZ + k * LFO_HZ);
+        mag[1][k] = magnitudeAt(x, CARRIER_HZ - k * LFO_HZ);
+        power += mag[0][k] * mag[0][k] + (k ? mag[1][k] * mag[1][k] : 0.0);
+    }
+    const double amplitude = sqrt(power);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.5f, (float)amplitude);
+
+    char msg[96];
+    for (int k = 0; k <= 8; k++)
+    {
+        double expect = fabs(besselJ(k, beta));
+        snprintf(msg, sizeof(msg), "k=%d: %.4f %.4f vs J %.4f", k, mag[0][k] / amplitude, mag[1][k] / amplitude,
+                 expect);
+        TEST_MESSAGE(msg);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.005f, (float)expect, (float)(mag[0][k] / amplitude), msg);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.005f, (float)expect, (float)(mag[1][k] / amplitude), msg);
+    }
+
+    // nothing between the sidebands (block-rate steps would put images
+    // here)
+    for (int k = -6; k < 6; k++)
+    {
+        float between = magnitudeAt(x, CARRIER_HZ + (k + 0.5f) * LFO_HZ);
+        TEST_ASSERT_LESS_THAN_FLOAT((float)(amplitude * 1e-3), between);
+    }
+}
+
+// The instantaneous frequency swings over carrier +/- depth and changes
+// only a little from one cycle to the next
+static void test_instantaneous_frequency_range()
+{
+    AudioSynthChord synth;
+    startVoice(synth);
+    synth.vibrato(LFO_HZ, DEPTH);
+    render(synth, (size_t)FS);
+    std::vector<float> f = cycleFrequencies(render(synth, (size_t)FS));
+
+    float lo = f[0], hi = f[0], worstStep = 0.0f;
+    for (size_t i = 1; i < f.size(); i++)
+    {
+        lo = std::min(lo, f[i]);
+        hi = std::max(hi, f[i]);
+        worstStep = std::max(worstStep, fabsf(f[i] - f[i - 1]));
+    }
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%.2f-%.2f Hz, largest cycle-to-cycle change %.3f Hz", lo, hi, worstStep);
+    TEST_MESSAGE(msg);
+
+    // a cycle averages the frequency over 1 ms, which trims the peaks by a
+    // few hundredths of a Hz
+    const float dev = CARRIER_HZ * DEPTH;
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, CARRIER_HZ - dev, lo);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, CARRIER_HZ + dev, hi);
+    // fastest change is 2 pi x rate x deviation = 565 Hz/s, 0.57 Hz per
+    // cycle; a control-rate update would jump several Hz at once
+    TEST_ASSERT_LESS_THAN_FLOAT(0.8f, worstStep);
+}
+
+// New rate and depth settings glide in over SYNTH_LFO_SMOOTH_MS instead
+// of jumping
+static void test_depth_glides_in()
+{
+    AudioSynthChord synth;
+    startVoice(synth);
+    render(synth, 4410);
+    synth.vibrato(LFO_HZ, DEPTH);
+    std::vector<float> f = cycleFrequencies(render(synth, (size_t)(FS * 0.5f)));
+
+    // first 10 ms: well under a quarter of the full deviation
+    float early = 0.0f, late = 0.0f;
+    for (size_t i = 0; i < f.size(); i++)
+    {
+        float d = fabsf(f[i] - CARRIER_HZ);
+        if (i < 10)
+            early = std::max(early, d);
+        else if (i > 300)
+            late = std::max(late, d);
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT(CARRIER_HZ * DEPTH * 0.25f, early);
+    TEST_ASSERT_GREATER_THAN_FLOAT(CARRIER_HZ * DEPTH * 0.9f, late);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_no_vibrato_is_pure);
+    RUN_TEST(test_sideband_shape);
+    RUN_TEST(test_instantaneous_frequency_range);
+    RUN_TEST(test_depth_glides_in);
+    return UNITY_END();
+}
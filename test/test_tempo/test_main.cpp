@@ -0,0 +1,148 @@
+// Tap tempo host tests (pio test -e native -f test_tempo)
+//
+// Feeds tap sequences (micros() stamps with human timing jitter of a few
+// milliseconds) through tempo.cpp and checks the BPM estimate after each
+// tap: steady tapping, single outliers (a late tap and a missed tap), a
+// tempo change, and a pause longer than TAP_TEMPO_MAX_INTERVAL_US.
+
+#include <Arduino.h>
+#include <unity.h>
+#include "config.h"
+#include "tempo.h"
+
+// env:native does not build src/, so the module under test is compiled here
+#include "tempo.cpp"
+
+// 120 BPM
+static const uint32_t steady120[] = {988438, 1501863, 1997775, 2496160, 3007735, 3500529,
+                                     3997804, 4514422, 4996043, 5489896, 5989006, 6495791};
+
+// 90 BPM; tap 5 is 220 ms late and the tap between 7 and 8 was missed
+static const uint32_t outliers90[] = {1005268, 1673484, 2342444, 3014819, 3680455, 4558675,
+                                      5010877, 5672175, 7006960, 7667517, 8332037};
+
+// 100 BPM, then 140 BPM from tap 8
+static const uint32_t change100to140[] = {1016485, 1606621, 2196511, 2799804, 3419310, 3998436,
+                                          4606381, 5205452, 5638601, 6067792, 6487711, 6916433,
+                                          7347457, 7774426, 8212441, 8646970};
+
+// 120 BPM, a 3 s pause, then 80 BPM from tap 6
+static const uint32_t gap120to80[] = {993241, 1504877, 1992500, 2494836, 2998510, 3501321,
+                                      6498218, 7230613, 8012999, 8749569, 9496613, 10257286,
+                                      10996921, 11740185};
+
+#define COUNT(a) (int)(sizeof(a) / sizeof(a[0]))
+
+// Estimate after each tap, 0 = none
+static float estimates[32];
+
+static void play(const uint32_t *taps, int n)
+{
+    tapTempoReset();
+    for (int i = 0; i < n; i++)
+    {
+        float bpm = 0.0f;
+        estimates[i] = tapTempoTap(taps[i], bpm) ? bpm : 0.0f;
+    }
+}
+
+static void report(const char *name, int n, int from, float target)
+{
+    float sum = 0.0f;
+    int count = 0;
+    printf("%-15s", name);
+    for (int i = 0; i < n; i++)
+    {
+        printf(estimates[i] > 0.0f ? " %6.1f" : "      -", estimates[i]);
+        if (i >= from && estimates[i] > 0.0f)
+        {
+            sum += fabsf(estimates[i] - target);
+            count++;
+        }
+    }
+    printf("  | mean error %.2f BPM\n", count ? sum / count : 0.0f);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_steady()
+{
+    play(steady120, COUNT(steady120));
+    report("steady 120", COUNT(steady120), 0, 120.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, estimates[0]); // one tap is no tempo
+    for (int i = 1; i < COUNT(steady120); i++)
+    {
+        TEST_ASSERT_GREATER_THAN(0.0f, estimates[i]);
+        // a single interval is only as good as the player; the average settles
+        TEST_ASSERT_FLOAT_WITHIN(i < TAP_TEMPO_AVERAGE ? 6.0f : 1.5f, 120.0f, estimates[i]);
+    }
+}
+
+static void test_outliers()
+{
+    play(outliers90, COUNT(outliers90));
+    report("outliers 90", COUNT(outliers90), 0, 90.0f);
+    // The late tap's long and short intervals and the missed tap's double
+    // interval are held back, not averaged in
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, estimates[5]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, estimates[6]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, estimates[8]);
+    for (int i = 1; i < COUNT(outliers90); i++)
+    {
+        if (estimates[i] > 0.0f)
+            TEST_ASSERT_FLOAT_WITHIN(2.0f, 90.0f, estimates[i]);
+    }
+    TEST_ASSERT_GREATER_THAN(0.0f, estimates[7]);
+    TEST_ASSERT_GREATER_THAN(0.0f, estimates[9]);
+}
+
+static void test_tempo_change()
+{
+    play(change100to140, COUNT(change100to140));
+    report("change 100>140", COUNT(change100to140), 9, 140.0f);
+    for (int i = 1; i < 8; i++)
+        TEST_ASSERT_FLOAT_WITHIN(3.0f, 100.0f, estimates[i]);
+    // The first fast interval is held back; the second confirms the change
+    // and the average restarts from the two, never blending the tempos
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, estimates[8]);
+    for (int i = 9; i < COUNT(change100to140); i++)
+        TEST_ASSERT_FLOAT_WITHIN(3.0f, 140.0f, estimates[i]);
+}
+
+static void test_pause()
+{
+    play(gap120to80, COUNT(gap120to80));
+    report("gap 120>80", COUNT(gap120to80), 7, 80.0f);
+    for (int i = 1; i < 6; i++)
+        TEST_ASSERT_FLOAT_WITHIN(3.0f, 120.0f, estimates[i]);
+    // The tap after the pause starts a new sequence
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, estimates[6]);
+    for (int i = 7; i < COUNT(gap120to80); i++)
+        TEST_ASSERT_FLOAT_WITHIN(2.0f, 80.0f, estimates[i]);
+    // Without the pause rule the first new interval would have been an
+    // outlier against 120 BPM
+    TEST_ASSERT_GREATER_THAN(0.0f, estimates[7]);
+}
+
+// Switch bounce: taps closer than TAP_TEMPO_MIN_INTERVAL_US are ignored
+static void test_bounce()
+{
+    tapTempoReset();
+    float bpm = 0.0f;
+    tapTempoTap(1000000, bpm);
+    TEST_ASSERT_FALSE(tapTempoTap(1000000 + TAP_TEMPO_MIN_INTERVAL_US - 1, bpm));
+    TEST_ASSERT_TRUE(tapTempoTap(1500000, bpm));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 120.0f, bpm);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_steady);
+    RUN_TEST(test_outliers);
+    RUN_TEST(test_tempo_change);
+    RUN_TEST(test_pause);
+    RUN_TEST(test_bounce);
+    return UNITY_END();
+}
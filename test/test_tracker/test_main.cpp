@@ -0,0 +1,351 @@
+// PitchTracker host tests (pio test -e native -f test_tracker)
+//
+// Feeds synthetic detector estimates (a steady note with measurement
+// noise, with 2x and 3x harmonic errors and sub-octave errors injected)
+// through each smoothing strategy with the guitar tuning, and checks the
+// octave correction, new-note and octave-change confirmation, smoothing
+// and register folding.
+//
+// Then replays a real detector trace: AudioAnalyzeYin, configured for
+// guitar, over a run of the test/data plucks played back to back. For each
+// strategy it prints how many estimates each note change takes to settle
+// within SETTLE_CENTS, and the share of tracker outputs more than
+// GROSS_CENTS off the note being played. The tracker runs without the
+// onset resets pitch.cpp adds, so its own new-note handling is measured.
+
+#include <Arduino.h>
+#include <Audio.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "tracker.h"
+#include "wavfile.h"
+#include "yin.h"
+
+// env:native does not build src/, so the detector for the replay is compiled here
+#include "dsp.cpp"
+#include "yin.cpp"
+
+#define A2_HZ 110.0f
+#define A2_CENTS 4500.0f
+#define SETTLE_CENTS 10.0f
+#define GROSS_CENTS 600.0f
+#define SETTLE_MAX 12 // estimates; about 70 ms at the guitar hop
+
+void setUp() {}
+void tearDown() {}
+
+// Deterministic noise in [-1, 1)
+static uint32_t noiseSeed = 1;
+static float noise()
+{
+    noiseSeed = noiseSeed * 1664525u + 1013904223u;
+    return (float)(noiseSeed >> 8) / 8388608.0f - 1.0f;
+}
+
+static float hzAtCents(float hz, float cents)
+{
+    return hz * exp2f(cents / 1200.0f);
+}
+
+// Steady A2 with +/-10 cents of noise and every other estimate wrong: the
+// 2nd harmonic, then the 3rd harmonic or the sub-octave. Errors never come
+// octaveConfirm times in a row, so the track must never leave the note.
+template <class Filter>
+static void checkHarmonicErrors()
+{
+    PitchTracker<Filter> t;
+    t.configure(guitarTuning);
+    noiseSeed = 1;
+    for (int i = 0; i < 400; i++)
+    {
+        float hz = hzAtCents(A2_HZ, 10.0f * noise());
+        if (i % 4 == 1)
+            hz *= 2.0f;
+        else if (i % 8 == 3)
+            hz *= 3.0f;
+        else if (i % 8 == 7)
+            hz *= 0.5f;
+        TEST_ASSERT_TRUE(t.update(hz, 0.95f));
+        TEST_ASSERT_FLOAT_WITHIN(15.0f, A2_CENTS, t.cents());
+    }
+}
+
+// An octave change that persists for octaveConfirm estimates is accepted
+template <class Filter>
+static void checkOctaveChange()
+{
+    PitchTracker<Filter> t;
+    t.configure(guitarTuning);
+    for (int i = 0; i < 20; i++)
+        t.update(A2_HZ, 0.95f);
+    for (int i = 1; i < guitarTuning.octaveConfirm; i++)
+    {
+        t.update(2.0f * A2_HZ, 0.95f);
+        TEST_ASSERT_FLOAT_WITHIN(1.0f, A2_CENTS, t.cents());
+    }
+    t.update(2.0f * A2_HZ, 0.95f);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, A2_CENTS + 1200.0f, t.cents());
+}
+
+// A move past jumpCents (not a harmonic) is a new note after jumpConfirm
+// estimates; smaller moves are smoothed
+template <class Filter>
+static void checkNewNote()
+{
+    PitchTracker<Filter> t;
+    t.configure(guitarTuning);
+    for (int i = 0; i < 20; i++)
+        t.update(A2_HZ, 0.95f);
+    float d3 = hzAtCents(A2_HZ, 500.0f);
+    for (int i = 1; i < guitarTuning.jumpConfirm; i++)
+    {
+        TEST_ASSERT_FALSE(t.update(d3, 0.95f));
+        TEST_ASSERT_FLOAT_WITHIN(1.0f, A2_CENTS, t.cents());
+    }
+    TEST_ASSERT_TRUE(t.update(d3, 0.95f));
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, A2_CENTS + 500.0f, t.cents());
+
+    // A 40 cent bend is followed within a few estimates
+    float bent = hzAtCents(d3, 40.0f);
+    int n = 0;
+    while (fabsf(t.cents() - (A2_CENTS + 540.0f)) > 5.0f && n < 50)
+    {
+        t.update(bent, 0.95f);
+        n++;
+    }
+    TEST_ASSERT_LESS_THAN(20, n);
+}
+
+// The smoothed track is steadier than the raw estimates
+template <class Filter>
+static float smoothingRatio()
+{
+    PitchTracker<Filter> t;
+    t.configure(guitarTuning);
+    noiseSeed = 7;
+    double rawSq = 0.0, outSq = 0.0;
+    for (int i = 0; i < 500; i++)
+    {
+        float dev = 12.0f * noise();
+        t.update(hzAtCents(A2_HZ, dev), 0.9f);
+        if (i >= 20)
+        {
+            rawSq += dev * dev;
+            outSq += (t.cents() - A2_CENTS) * (t.cents() - A2_CENTS);
+        }
+    }
+    return (float)sqrt(outSq / rawSq);
+}
+
+// One detector estimate of the replayed trace, with the note sounding
+// when it was made
+struct TraceEstimate
+{
+    int note;
+    float noteCents;
+    float hz;
+    float probability;
+};
+
+// The plucks in a melodic order, with a leap back down at the end
+static const char *const traceFiles[] = {"guitar_E2_82.41Hz.wav", "guitar_A2_110.00Hz.wav",
+                                         "guitar_D3_146.83Hz.wav", "guitar_G3_196.00Hz.wav",
+                                         "guitar_E4_329.63Hz.wav", "guitar_A2_110.00Hz.wav"};
+#define TRACE_NOTES ((int)(sizeof(traceFiles) / sizeof(traceFiles[0])))
+
+static std::vector<TraceEstimate> detectorTrace()
+{
+    std::vector<int16_t> x;
+    std::vector<size_t> starts;
+    std::vector<float> cents;
+    for (int n = 0; n < TRACE_NOTES; n++)
+    {
+        std::string name = traceFiles[n];
+        starts.push_back(x.size());
+        cents.push_back(hzToCents(strtof(name.c_str() + name.rfind('_') + 1, nullptr)));
+        TEST_ASSERT_TRUE_MESSAGE(readWav("test/data/" + name, x), name.c_str());
+    }
+
+    AudioAnalyzeYin *yin = new AudioAnalyzeYin();
+    yin->begin(NOTE_DETECT_THRESHOLD);
+    yin->configure(PITCH_MIN_FREQ_GUITAR, PITCH_MAX_FREQ, PITCH_WINDOW_GUITAR);
+    std::vector<TraceEstimate> trace;
+    int note = 0;
+    for (size_t pos = 0; pos + AUDIO_BLOCK_SAMPLES <= x.size(); pos += AUDIO_BLOCK_SAMPLES)
+    {
+        yin->hostInput(&x[pos]);
+        yin->hostUpdate();
+        while (note + 1 < TRACE_NOTES && pos + AUDIO_BLOCK_SAMPLES > starts[note + 1])
+            note++;
+        PitchResult r;
+        while (yin->readResult(r))
+            trace.push_back({note, cents[note], r.frequency, r.probability});
+    }
+    delete yin;
+    return trace;
+}
+
+struct ReplayScore
+{
+    int settle[TRACE_NOTES]; // estimates from the note's start to settling, -1 = never
+    float grossShare;        // of the tracker's outputs
+};
+
+template <class Filter>
+static ReplayScore replay(const std::vector<TraceEstimate> &trace)
+{
+    PitchTracker<Filter> t;
+    t.configure(guitarTuning);
+    ReplayScore s;
+    int outputs = 0, gross = 0;
+    int note = -1, since = 0;
+    for (const TraceEstimate &e : trace)
+    {
+        if (e.note != note)
+        {
+            note = e.note;
+            since = 0;
+            s.settle[note] = -1;
+        }
+        since++;
+        if (!t.update(e.hz, e.probability))
+            continue;
+        float err = fabsf(t.cents() - e.noteCents);
+        outputs++;
+        if (err > GROSS_CENTS)
+            gross++;
+        if (s.settle[note] < 0 && err <= SETTLE_CENTS)
+            s.settle[note] = since;
+    }
+    s.grossShare = outputs ? (float)gross / outputs : 0.0f;
+    return s;
+}
+
+static void printReplay(const char *name, const ReplayScore &s)
+{
+    printf("%-9s", name);
+    for (int n = 0; n < TRACE_NOTES; n++)
+        printf(" %5d", s.settle[n]);
+    printf(" | %5.1f%%\n", s.grossShare * 100.0f);
+}
+
+static void checkReplay(const ReplayScore &s)
+{
+    for (int n = 0; n < TRACE_NOTES; n++)
+    {
+        TEST_ASSERT_TRUE_MESSAGE(s.settle[n] >= 0, traceFiles[n]);
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(SETTLE_MAX, s.settle[n], traceFiles[n]);
+    }
+    TEST_ASSERT_LESS_THAN(0.05f, s.grossShare);
+}
+
+static void test_harmonic_errors_median() { checkHarmonicErrors<MedianFilter<PITCH_MEDIAN_LENGTH>>(); }
+static void test_harmonic_errors_onepole() { checkHarmonicErrors<LogOnePoleFilter>(); }
+static void test_harmonic_errors_kalman() { checkHarmonicErrors<KalmanCentsFilter>(); }
+
+static void test_octave_change_median() { checkOctaveChange<MedianFilter<PITCH_MEDIAN_LENGTH>>(); }
+static void test_octave_change_onepole() { checkOctaveChange<LogOnePoleFilter>(); }
+static void test_octave_change_kalman() { checkOctaveChange<KalmanCentsFilter>(); }
+
+static void test_new_note_median() { checkNewNote<MedianFilter<PITCH_MEDIAN_LENGTH>>(); }
+static void test_new_note_onepole() { checkNewNote<LogOnePoleFilter>(); }
+static void test_new_note_kalman() { checkNewNote<KalmanCentsFilter>(); }
+
+static void test_smoothing()
+{
+    float median = smoothingRatio<MedianFilter<PITCH_MEDIAN_LENGTH>>();
+    float onePole = smoothingRatio<LogOnePoleFilter>();
+    float kalman = smoothingRatio<KalmanCentsFilter>();
+    printf("residual noise (output/raw rms): median %.2f, one-pole %.2f, kalman %.2f\n", median, onePole, kalman);
+    TEST_ASSERT_LESS_THAN(0.9f, median);
+    TEST_ASSERT_LESS_THAN(0.9f, onePole);
+    TEST_ASSERT_LESS_THAN(0.6f, kalman);
+}
+
+static void test_out_of_range_ignored()
+{
+    PitchTracker<KalmanCentsFilter> t;
+    t.configure(guitarTuning);
+    TEST_ASSERT_FALSE(t.update(guitarTuning.minHz * 0.9f, 1.0f));
+    TEST_ASSERT_FALSE(t.update(guitarTuning.maxHz * 1.1f, 1.0f));
+    TEST_ASSERT_FALSE(t.valid());
+}
+
+// Tonics below foldLowHz are raised an octave; the fold then holds until
+// the pitch is foldHystCents past the boundary
+static void test_register_folding()
+{
+    PitchTracker<KalmanCentsFilter> t;
+    t.configure(guitarTuning);
+    t.update(A2_HZ, 1.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.0f * A2_HZ, t.frequency());
+
+    // New note just above the boundary: not folded
+    t.reset();
+    float above = hzAtCents(guitarTuning.foldLowHz, 20.0f);
+    t.update(above, 1.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, above, t.frequency());
+
+    // Track from below the boundary, then bend up past it but inside the
+    // hysteresis: stays folded
+    t.reset();
+    float below = hzAtCents(guitarTuning.foldLowHz, -30.0f);
+    t.update(below, 1.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 2.0f * below, t.frequency());
+    float bend = hzAtCents(guitarTuning.foldLowHz, 40.0f);
+    for (int i = 0; i < 40; i++)
+        t.update(bend, 1.0f);
+    TEST_ASSERT_GREATER_THAN(guitarTuning.foldLowHz * 1.5f, t.frequency());
+}
+
+// Real detector output: every strategy settles on every note quickly and
+// rarely strays an octave or more
+static void test_detector_replay()
+{
+    std::vector<TraceEstimate> trace = detectorTrace();
+    int rawGross = 0;
+    for (const TraceEstimate &e : trace)
+        if (fabsf(hzToCents(e.hz) - e.noteCents) > GROSS_CENTS)
+            rawGross++;
+
+    printf("estimates to settle within %.0f cents after each note change, share > %.0f cents off\n", SETTLE_CENTS,
+           GROSS_CENTS);
+    printf("%-9s", "filter");
+    for (int n = 0; n < TRACE_NOTES; n++)
+    {
+        std::string name = traceFiles[n];
+        printf(" %5s", name.substr(7, name.find('_', 7) - 7).c_str());
+    }
+    printf(" | gross\n");
+    printf("%-9s %*s | %5.1f%%\n", "raw", TRACE_NOTES * 6 - 1, "", trace.empty() ? 0.0f : 100.0f * rawGross / trace.size());
+
+    ReplayScore median = replay<MedianFilter<PITCH_MEDIAN_LENGTH>>(trace);
+    ReplayScore onePole = replay<LogOnePoleFilter>(trace);
+    ReplayScore kalman = replay<KalmanCentsFilter>(trace);
+    printReplay("median", median);
+    printReplay("one-pole", onePole);
+    printReplay("kalman", kalman);
+    checkReplay(median);
+    checkReplay(onePole);
+    checkReplay(kalman);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_harmonic_errors_median);
+    RUN_TEST(test_harmonic_errors_onepole);
+    RUN_TEST(test_harmonic_errors_kalman);
+    RUN_TEST(test_octave_change_median);
+    RUN_TEST(test_octave_change_onepole);
+    RUN_TEST(test_octave_change_kalman);
+    RUN_TEST(test_new_note_median);
+    RUN_TEST(test_new_note_onepole);
+    RUN_TEST(test_new_note_kalman);
+    RUN_TEST(test_smoothing);
+    RUN_TEST(test_out_of_range_ignored);
+    RUN_TEST(test_register_folding);
+    RUN_TEST(test_detector_replay);
+    return UNITY_END();
+}
@@ -0,0 +1,360 @@
+// Pitch detector benchmark on WAV files (pio test -e native -f test_yin_wav)
+//
+// Runs AudioAnalyzeYin, configured as pitch.cpp configures it, over every
+// <name>_<Hz>Hz.wav in test/data (or in $PITCH_WAV_DIR) and compares it
+// with a host port of the detector it replaced, the Teensy Audio Library's
+// AudioAnalyzeNoteFrequency. Per file it reports the latency from the
+// attack to the first estimate within LOCK_CENTS of the expected pitch,
+// the mean error of the estimates after that, and the share of estimates
+// more than GROSS_CENTS off (octave errors and the like).
+//
+// Files whose name starts with bass_ use the bass settings. Those are also
+// run with the decimated front end off and on, timing hostUpdate() for
+// each. WAVs must be 16-bit PCM at 44.1 kHz; only the first channel is used.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <dirent.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "wavfile.h"
+#include "yin.h"
+
+// env:native does not build src/, so the modules under test are compiled here
+#include "dsp.cpp"
+#include "yin.cpp"
+
+#define LOCK_CENTS 50.0f
+#define GROSS_CENTS 100.0f
+#define ONSET_FRACTION 0.1f // attack = first sample above this fraction of the peak
+#define DECIMATION_LOCK_FILE "bass_E1_41.20Hz.wav"
+
+void setUp() {}
+void tearDown() {}
+
+// Host port of AudioAnalyzeNoteFrequency (analyze_notefreq.cpp, 128-sample
+// blocks): 24 blocks are collected, then the difference function over the
+// first half of them is evaluated 64 lags per audio update, stopping at the
+// first dip of the normalized difference below the threshold. The estimate
+// becomes available in the update that finds the dip.
+class NoteFrequencyReference
+{
+public:
+    explicit NoteFrequencyReference(float threshold) : threshold(threshold) {}
+
+    // Feed one 128-sample block; true when an estimate was made
+    bool update(const int16_t *block, float &frequency)
+    {
+        bool found = false;
+        if (processing)
+            found = process(frequency);
+        memcpy(&collect[collected * 128], block, 128 * sizeof(int16_t));
+        if (++collected == BLOCKS)
+        {
+            memcpy(buffer, collect, sizeof(buffer));
+            collected = 0;
+            processing = true;
+            tau = 1;
+            idx = 1;
+            runningSum = 0;
+        }
+        return found;
+    }
+
+private:
+    static const int BLOCKS = 24;
+    static const int HALF = BLOCKS * 64;
+
+    bool process(float &frequency)
+    {
+        for (int cycles = 0; cycles < 64; cycles++)
+        {
+            uint64_t sum = 0;
+            for (int x = 0; x < HALF; x++)
+            {
+                int32_t delta = buffer[x] - buffer[x + tau];
+                sum += (uint64_t)(delta * delta);
+            }
+            runningSum += sum;
+            yin[idx] = sum * tau;
+            rs[idx] = runningSum;
+            idx = (idx + 1 >= 5) ? 0 : idx + 1;
+            if (tau > 4)
+            {
+                // idx is now the oldest of the last five lags (tau - 4)
+                float s0 = (float)yin[idx] / rs[idx];
+                float s1 = (float)yin[(idx + 1) % 5] / rs[(idx + 1) % 5];
+                float s2 = (float)yin[(idx + 2) % 5] / rs[(idx + 2) % 5];
+                if (s1 < threshold && s1 < s2)
+                {
+                    float period = (float)(tau - 3) + 0.5f * (s0 - s2) / (s0 - 2.0f * s1 + s2);
+                    frequency = AUDIO_SAMPLE_RATE_EXACT / period;
+                    processing = false;
+                    return true;
+                }
+            }
+            if (++tau >= HALF)
+            {
+                processing = false; // no pitch in this buffer
+                return false;
+            }
+        }
+        return false;
+    }
+
+    float threshold;
+    int16_t collect[BLOCKS * 128];
+    int16_t buffer[BLOCKS * 128];
+    int collected = 0;
+    bool processing = false;
+    int tau = 1;
+    int idx = 1;
+    uint64_t yin[5] = {};
+    uint64_t rs[5] = {};
+    uint64_t runningSum = 0;
+};
+
+struct Estimate
+{
+    uint32_t sample; // input samples consumed when the estimate was available
+    float frequency;
+};
+
+struct Score
+{
+    float latencyMs = -1.0f; // -1 = never within LOCK_CENTS
+    float meanCents = 0.0f;
+    float grossShare = 0.0f;
+    int count = 0;
+};
+
+static Score score(const std::vector<Estimate> &estimates, uint32_t onset, float expected)
+{
+    Score s;
+    float sum = 0.0f;
+    int inRange = 0, gross = 0;
+    for (const Estimate &e : estimates)
+    {
+        if (e.sample < onset)
+            continue;
+        float cents = 1200.0f * log2f(e.frequency / expected);
+        s.count++;
+        if (fabsf(cents) > GROSS_CENTS)
+        {
+            gross++;
+            continue;
+        }
+        if (s.latencyMs < 0.0f && fabsf(cents) <= LOCK_CENTS)
+            s.latencyMs = (e.sample - onset) * 1000.0f / AUDIO_SAMPLE_RATE_EXACT;
+        if (s.latencyMs >= 0.0f)
+        {
+            sum += fabsf(cents);
+            inRange++;
+        }
+    }
+    if (inRange > 0)
+        s.meanCents = sum / inRange;
+    if (s.count > 0)
+        s.grossShare = (float)gross / s.count;
+    return s;
+}
+
+static std::vector<std::string> wavFiles(const std::string &dir)
+{
+    std::vector<std::string> names;
+    DIR *d = opendir(dir.c_str());
+    if (!d)
+        return names;
+    while (struct dirent *e = readdir(d))
+    {
+        std::string n = e->d_name;
+        if (n.size() > 6 && n.compare(n.size() - 6, 6, "Hz.wav") == 0)
+            names.push_back(n);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+static std::string wavDir()
+{
+    const char *env = getenv("PITCH_WAV_DIR");
+    return env ? env : "test/data";
+}
+
+// First sample above ONSET_FRACTION of the peak
+static uint32_t findOnset(const std::vector<int16_t> &x)
+{
+    int peak = 0;
+    for (int16_t v : x)
+        peak = std::max(peak, abs((int)v));
+    uint32_t onset = 0;
+    while (onset < x.size() && abs((int)x[onset]) < peak * ONSET_FRACTION)
+        onset++;
+    return onset;
+}
+
+// Expected pitch from the <name>_<Hz>Hz.wav file name
+static float expectedHz(const std::string &name)
+{
+    return strtof(name.c_str() + name.rfind('_') + 1, nullptr);
+}
+
+// Run the bass configuration at one decimation over x; returns the
+// estimates and the mean time per hostUpdate() in microseconds
+static std::vector<Estimate> runBass(const std::vector<int16_t> &x, int decimation, float &usPerUpdate)
+{
+    AudioAnalyzeYin *yin = new AudioAnalyzeYin();
+    yin->begin(NOTE_DETECT_THRESHOLD);
+    yin->configure(PITCH_MIN_FREQ_BASS, PITCH_MAX_FREQ_BASS, PITCH_WINDOW_BASS, decimation);
+
+    using clock = std::chrono::steady_clock;
+    clock::duration busy = clock::duration::zero();
+    int updates = 0;
+    std::vector<Estimate> est;
+    int16_t block[AUDIO_BLOCK_SAMPLES];
+    for (size_t pos = 0; pos + AUDIO_BLOCK_SAMPLES <= x.size(); pos += AUDIO_BLOCK_SAMPLES)
+    {
+        memcpy(block, &x[pos], sizeof(block));
+        yin->hostInput(block);
+        clock::time_point t0 = clock::now();
+        yin->hostUpdate();
+        busy += clock::now() - t0;
+        updates++;
+        PitchResult r;
+        while (yin->readResult(r))
+            est.push_back({(uint32_t)(pos + AUDIO_BLOCK_SAMPLES), r.frequency});
+    }
+    delete yin;
+    usPerUpdate = updates ? (float)(std::chrono::duration<double, std::micro>(busy).count() / updates) : 0.0f;
+    return est;
+}
+
+static void test_wav_files()
+{
+    std::string dir = wavDir();
+    std::vector<std::string> names = wavFiles(dir);
+    TEST_ASSERT_TRUE_MESSAGE(!names.empty(), "no <name>_<Hz>Hz.wav files found");
+
+    printf("%-28s %8s | %9s %7s %6s | %9s %7s %6s\n", "file", "Hz",
+           "yin ms", "cents", "gross", "old ms", "cents", "gross");
+    float yinLatencySum = 0.0f, oldLatencySum = 0.0f;
+    int bothLocked = 0;
+    for (const std::string &name : names)
+    {
+        std::vector<int16_t> x;
+        TEST_ASSERT_TRUE_MESSAGE(readWav(dir + "/" + name, x), name.c_str());
+        float expected = expectedHz(name);
+        bool bass = name.compare(0, 5, "bass_") == 0;
+        uint32_t onset = findOnset(x);
+
+        // Same configuration as configurePitchForInstrument() in pitch.cpp
+        AudioAnalyzeYin *yin = new AudioAnalyzeYin();
+        yin->begin(NOTE_DETECT_THRESHOLD);
+        if (bass)
+            yin->configure(PITCH_MIN_FREQ_BASS, PITCH_MAX_FREQ_BASS, PITCH_WINDOW_BASS, PITCH_BASS_DECIMATION);
+        else
+            yin->configure(PITCH_MIN_FREQ_GUITAR, PITCH_MAX_FREQ, PITCH_WINDOW_GUITAR);
+        NoteFrequencyReference *old = new NoteFrequencyReference(NOTE_DETECT_THRESHOLD);
+
+        std::vector<Estimate> yinEst, oldEst;
+        int16_t block[AUDIO_BLOCK_SAMPLES];
+        int16_t oldBlock[128];
+        int oldFill = 0;
+        for (size_t pos = 0; pos + AUDIO_BLOCK_SAMPLES <= x.size(); pos += AUDIO_BLOCK_SAMPLES)
+        {
+            memcpy(block, &x[pos], sizeof(block));
+            uint32_t done = pos + AUDIO_BLOCK_SAMPLES;
+            yin->hostInput(block);
+            yin->hostUpdate();
+            PitchResult r;
+            while (yin->readResult(r))
+                yinEst.push_back({done, r.frequency});
+
+            // The old detector always ran on 128-sample blocks
+            for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+            {
+                oldBlock[oldFill++] = block[i];
+                if (oldFill == 128)
+                {
+                    float f;
+                    if (old->update(oldBlock, f))
+                        oldEst.push_back({(uint32_t)(pos + i + 1), f});
+                    oldFill = 0;
+                }
+            }
+        }
+        delete yin;
+        delete old;
+
+        Score ys = score(yinEst, onset, expected);
+        Score os = score(oldEst, onset, expected);
+        printf("%-28s %8.2f | %9.1f %7.2f %5.0f%% | %9.1f %7.2f %5.0f%%\n", name.c_str(), expected,
+               ys.latencyMs, ys.meanCents, ys.grossShare * 100.0f,
+               os.latencyMs, os.meanCents, os.grossShare * 100.0f);
+
+        std::string msg = name + ": YIN never locked";
+        TEST_ASSERT_TRUE_MESSAGE(ys.latencyMs >= 0.0f, msg.c_str());
+        msg = name + ": YIN slower than the old detector";
+        TEST_ASSERT_TRUE_MESSAGE(os.latencyMs < 0.0f || ys.latencyMs < os.latencyMs, msg.c_str());
+        msg = name + ": YIN mean error too large";
+        TEST_ASSERT_LESS_THAN_MESSAGE(10, (int)ys.meanCents, msg.c_str());
+        if (os.latencyMs >= 0.0f)
+        {
+            yinLatencySum += ys.latencyMs;
+            oldLatencySum += os.latencyMs;
+            bothLocked++;
+        }
+    }
+    if (bothLocked > 0)
+        printf("mean latency where both locked: yin %.1f ms, old %.1f ms (%d files)\n",
+               yinLatencySum / bothLocked, oldLatencySum / bothLocked, bothLocked);
+}
+
+// Bass files at full rate and through the decimated front end: cost per
+// update, latency and error. Decimating must not delay the lock on low E.
+static void test_bass_decimation()
+{
+    std::string dir = wavDir();
+    std::vector<std::string> names = wavFiles(dir);
+
+    printf("%-28s | %9s %9s %7s | %9s %9s %7s\n", "file", "full us", "ms", "cents", "decim us", "ms", "cents");
+    bool lowE = false;
+    for (const std::string &name : names)
+    {
+        if (name.compare(0, 5, "bass_") != 0)
+            continue;
+        std::vector<int16_t> x;
+        TEST_ASSERT_TRUE_MESSAGE(readWav(dir + "/" + name, x), name.c_str());
+        float expected = expectedHz(name);
+        uint32_t onset = findOnset(x);
+
+        float fullUs, decimUs;
+        Score full = score(runBass(x, 1, fullUs), onset, expected);
+        Score decim = score(runBass(x, PITCH_BASS_DECIMATION, decimUs), onset, expected);
+        printf("%-28s | %9.1f %9.1f %7.2f | %9.1f %9.1f %7.2f\n", name.c_str(), fullUs, full.latencyMs,
+               full.meanCents, decimUs, decim.latencyMs, decim.meanCents);
+
+        std::string msg = name + ": decimated path never locked";
+        TEST_ASSERT_TRUE_MESSAGE(decim.latencyMs >= 0.0f, msg.c_str());
+        if (name == DECIMATION_LOCK_FILE)
+        {
+            lowE = true;
+            msg = name + ": decimated path locks later than full rate";
+            TEST_ASSERT_TRUE_MESSAGE(full.latencyMs < 0.0f || decim.latencyMs <= full.latencyMs, msg.c_str());
+        }
+    }
+    if (wavDir() == "test/data")
+        TEST_ASSERT_TRUE_MESSAGE(lowE, DECIMATION_LOCK_FILE " not found");
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_wav_files);
+    RUN_TEST(test_bass_decimation);
+    return UNITY_END();
+}